@@ -0,0 +1,231 @@
+#include "AssetLoader.h"
+
+AssetLoader::AssetLoader(unsigned int threadsCount) : pool(threadsCount)
+{
+	requestedCount = 0;
+	loadedCount = 0;
+}
+
+void AssetLoader::QueueUpload(std::function<void()> upload)
+{
+	{
+		std::lock_guard<std::mutex> lock(uploadsMutex);
+		uploads.push_back(std::move(upload));
+	}
+	uploadsReady.notify_one();
+}
+
+Model* AssetLoader::LoadModel(const std::string& directory, const std::string& modelPath, Camera* camera,
+	glm::vec3 origOrientation, VertexFormat vertexFormat)
+{
+	//	The model is returned empty, its meshes appear once Update has run its upload
+	Model* model = new Model(directory, modelPath, camera, origOrientation, vertexFormat, false);
+	std::shared_ptr<ModelJob> job = std::make_shared<ModelJob>();
+	job->model = model;
+	job->pendingImages = 0;
+	requestedCount++;
+	pool.Submit([this, job]()
+	{
+		job->model->LoadMeshesData(job->meshesData);
+		DecodeModelImages(job);
+	});
+	return model;
+}
+
+void AssetLoader::QueueModelUpload(std::shared_ptr<ModelJob> job)
+{
+	QueueUpload([this, job]()
+	{
+		//	The first model to upload a shared image puts it into the texture cache, the others find it there
+		std::map<std::string, ImageData> images;
+		for (auto it = job->images.begin(); it != job->images.end(); it++)
+		{
+			SharedImage& shared = *it->second;
+			if (shared.uploaded) continue;
+			std::swap(images[it->first], shared.image);
+			shared.uploaded = true;
+		}
+		job->model->BuildMeshes(job->meshesData, &images);
+		for (auto it = images.begin(); it != images.end(); it++)
+		{
+			it->second.Free();
+		}
+		loadedCount++;
+	});
+}
+
+void AssetLoader::DecodeModelImages(std::shared_ptr<ModelJob> job)
+{
+	//	Every texture path is decoded once per loader, models sharing it wait for the same decode
+	//	instead of decoding their own copy. Paths stay registered after the upload, their textures are in the cache
+	std::vector<std::pair<std::string, std::shared_ptr<SharedImage>>> decodes;
+	int pendingImages = 0;
+	{
+		std::lock_guard<std::mutex> lock(imagesMutex);
+		for (int i = 0; i < job->meshesData.size(); i++)
+		{
+			const std::vector<MeshTextureInfo>& textures = job->meshesData[i].textures;
+			for (int j = 0; j < textures.size(); j++)
+			{
+				std::string path = job->model->GetTexturePath(textures[j].path);
+				if (job->images.count(path) > 0) continue;
+				std::shared_ptr<SharedImage>& shared = sharedImages[path];
+				if (shared == NULL)
+				{
+					shared = std::make_shared<SharedImage>();
+					shared->decoded = false;
+					shared->uploaded = false;
+					decodes.push_back(std::make_pair(path, shared));
+				}
+				job->images[path] = shared;
+				if (!shared->decoded)
+				{
+					shared->waitingJobs.push_back(job);
+					pendingImages++;
+				}
+			}
+		}
+		job->pendingImages = pendingImages;
+	}
+	if (pendingImages == 0)
+	{
+		QueueModelUpload(job);
+		return;
+	}
+	for (int i = 0; i < decodes.size(); i++)
+	{
+		std::string path = decodes[i].first;
+		std::shared_ptr<SharedImage> shared = decodes[i].second;
+		pool.Submit([this, path, shared]()
+		{
+			Texture::DecodeImage(path, shared->image);
+			std::vector<std::shared_ptr<ModelJob>> jobs;
+			{
+				std::lock_guard<std::mutex> lock(imagesMutex);
+				shared->decoded = true;
+				jobs.swap(shared->waitingJobs);
+			}
+			//	The last decoded image of a model hands it over to the render thread
+			for (int j = 0; j < jobs.size(); j++)
+			{
+				if (--jobs[j]->pendingImages == 0)
+					QueueModelUpload(jobs[j]);
+			}
+		});
+	}
+}
+
+void AssetLoader::LoadTexture(const std::string& path, bool useSRGB, std::function<void(const Texture&)> onLoaded)
+{
+	//	The texture is put into the cache, the callback gets a reference of its own to release
+	std::shared_ptr<TextureJob> job = std::make_shared<TextureJob>();
+	job->path = path;
+	job->useSRGB = useSRGB;
+	job->onLoaded = onLoaded;
+	requestedCount++;
+	pool.Submit([this, job]()
+	{
+		Texture::DecodeImage(job->path, job->image);
+		QueueUpload([this, job]()
+		{
+			Texture texture = TextureCache::Acquire(job->path, job->useSRGB, &job->image);
+			job->image.Free();
+			if (job->onLoaded) job->onLoaded(texture);
+			loadedCount++;
+		});
+	});
+}
+
+void AssetLoader::LoadCubeMap(const std::vector<std::string>& pathes, std::function<void(unsigned int)> onLoaded)
+{
+	//	Faces are decoded in parallel, the cube map is built once all of them are ready
+	std::shared_ptr<CubeMapJob> job = std::make_shared<CubeMapJob>();
+	job->pathes = pathes;
+	job->images.resize(pathes.size());
+	job->pendingImages = pathes.size();
+	job->onLoaded = onLoaded;
+	requestedCount++;
+	auto upload = [this, job]()
+	{
+		unsigned int id = Texture::UploadCubeMap(job->pathes, job->images);
+		for (int i = 0; i < job->images.size(); i++)
+		{
+			job->images[i].Free();
+		}
+		if (job->onLoaded) job->onLoaded(id);
+		loadedCount++;
+	};
+	if (pathes.empty())
+	{
+		QueueUpload(upload);
+		return;
+	}
+	for (int i = 0; i < pathes.size(); i++)
+	{
+		pool.Submit([this, job, i, upload]()
+		{
+			Texture::DecodeImage(job->pathes[i], job->images[i]);
+			if (--job->pendingImages == 0)
+				QueueUpload(upload);
+		});
+	}
+}
+
+void AssetLoader::Update()
+{
+	//	Must be called from the thread that owns the GL context
+	std::deque<std::function<void()>> ready;
+	{
+		std::lock_guard<std::mutex> lock(uploadsMutex);
+		ready.swap(uploads);
+	}
+	for (int i = 0; i < ready.size(); i++)
+	{
+		ready[i]();
+	}
+}
+
+void AssetLoader::Wait(std::function<void(float)> onProgress)
+{
+	//	Sleeps until a worker queues an upload, every request finishes with one on this thread
+	unsigned int lastLoaded = loadedCount;
+	while (!IsFinished())
+	{
+		{
+			std::unique_lock<std::mutex> lock(uploadsMutex);
+			uploadsReady.wait(lock, [this]()
+			{
+				return !uploads.empty();
+			});
+		}
+		Update();
+		if (onProgress && loadedCount != lastLoaded)
+		{
+			lastLoaded = loadedCount;
+			onProgress(GetProgress());
+		}
+	}
+	Update();
+}
+
+unsigned int AssetLoader::GetRequestedCount() const
+{
+	return requestedCount;
+}
+
+unsigned int AssetLoader::GetLoadedCount() const
+{
+	return loadedCount;
+}
+
+float AssetLoader::GetProgress() const
+{
+	unsigned int requested = requestedCount;
+	if (requested == 0) return 1.0f;
+	return (float)loadedCount / requested;
+}
+
+bool AssetLoader::IsFinished() const
+{
+	return loadedCount >= requestedCount;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include "ThreadPool.h"
+#include "Texture.h"
+#include "Model.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+
+class AssetLoader
+{
+private:
+	struct ModelJob;
+	struct SharedImage
+	{
+		ImageData image;
+		bool decoded;
+		bool uploaded;
+		std::vector<std::shared_ptr<ModelJob>> waitingJobs;
+	};
+	struct ModelJob
+	{
+		Model* model;
+		std::vector<MeshData> meshesData;
+		std::map<std::string, std::shared_ptr<SharedImage>> images;
+		std::atomic<int> pendingImages;
+	};
+	struct TextureJob
+	{
+		std::string path;
+		bool useSRGB;
+		ImageData image;
+		std::function<void(const Texture&)> onLoaded;
+	};
+	struct CubeMapJob
+	{
+		std::vector<std::string> pathes;
+		std::vector<ImageData> images;
+		std::atomic<int> pendingImages;
+		std::function<void(unsigned int)> onLoaded;
+	};
+	ThreadPool pool;
+	std::mutex uploadsMutex;
+	std::condition_variable uploadsReady;
+	std::deque<std::function<void()>> uploads;
+	std::atomic<unsigned int> requestedCount;
+	std::atomic<unsigned int> loadedCount;
+	std::mutex imagesMutex;
+	std::map<std::string, std::shared_ptr<SharedImage>> sharedImages;
+	void QueueUpload(std::function<void()> upload);
+	void QueueModelUpload(std::shared_ptr<ModelJob> job);
+	void DecodeModelImages(std::shared_ptr<ModelJob> job);
+public:
+	AssetLoader(unsigned int threadsCount = 0);
+	Model* LoadModel(const std::string& directory, const std::string& modelPath, Camera* camera,
+		glm::vec3 origOrientation = glm::vec3(1.0f, 0.0f, 0.0f), VertexFormat vertexFormat = VertexFormat::FULL);
+	void LoadTexture(const std::string& path, bool useSRGB, std::function<void(const Texture&)> onLoaded);
+	void LoadCubeMap(const std::vector<std::string>& pathes, std::function<void(unsigned int)> onLoaded);
+	void Update();
+	void Wait(std::function<void(float)> onProgress = nullptr);
+	unsigned int GetRequestedCount() const;
+	unsigned int GetLoadedCount() const;
+	float GetProgress() const;
+	bool IsFinished() const;
+};
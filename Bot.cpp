@@ -1,21 +1,20 @@
 #include "Bot.h"
 
-CarBot::CarBot(const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
-	const glm::vec3& force, float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle) :
-	Car(dir, speed, position, maxTorque, mass, wheelsAxisDist, maxTurnAngle)
+CarBot::CarBot(VehicleSimulation& simulation, TrafficSystem& traffic, SimulationLod& lod, const glm::vec3& dir,
+	const glm::dvec3& speed, const glm::vec3& position, float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle) :
+	Car(simulation, dir, speed, position, maxTorque, mass, wheelsAxisDist, maxTurnAngle)
 {
-
-}
-CarBot::CarBot(const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
-	float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle) :
-	Car(dir, speed, position, maxTorque, mass, wheelsAxisDist, maxTurnAngle)
-{
-
+	this->traffic = &traffic;
+	this->lod = &lod;
 }
 
 void CarBot::Act(double deltaTime)
 {
-	ClearForces();
-	if (glm::length(GetSpeedProjToDirection()) < 12.0f)
-		AddForce(direction * GetDriveForce());
+	//	The lane model decides when to speed up, brake and change lanes.
+	//	Distant bots only follow their lane, mid-range ones decide less often with a longer step
+	unsigned int vehicle = GetVehicleIndex();
+	if (lod->GetTier(vehicle) == SimulationTier::KINEMATIC)
+		traffic->Coast(vehicle, (float)deltaTime);
+	else if (lod->IsDue(vehicle))
+		traffic->Drive(vehicle, lod->GetStepTime(vehicle, (float)deltaTime));
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include "Car.h"
+#include "TrafficSystem.h"
+#include "SimulationLod.h"
 
 class Bot
 {
@@ -16,11 +18,11 @@ public:
 class CarBot : public Bot, public Car
 {
 private:
+	TrafficSystem* traffic;
+	SimulationLod* lod;
 
 public:
-	CarBot(const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
-		const glm::vec3& force, float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle);
-	CarBot(const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
-		float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle) ;
+	CarBot(VehicleSimulation& simulation, TrafficSystem& traffic, SimulationLod& lod, const glm::vec3& dir,
+		const glm::dvec3& speed, const glm::vec3& position, float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle);
 	virtual void Act(double deltaTime) override;
 };
\ No newline at end of file
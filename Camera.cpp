@@ -46,6 +46,26 @@ glm::vec3 Camera::GetFront() const
 	return front;
 }
 
+float Camera::GetFov() const
+{
+	return fov;
+}
+
+float Camera::GetNearPlane() const
+{
+	return zNear;
+}
+
+float Camera::GetFarPlane() const
+{
+	return zFar;
+}
+
+float Camera::GetAspectRatio() const
+{
+	return aspectRatio;
+}
+
 glm::mat4 Camera::GetViewMatrix() const
 {
 	return glm::lookAt(position, position + front, up);
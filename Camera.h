@@ -52,6 +52,10 @@ public:
 		float worldUpX, float worldUpY, float worldUpZ, float yaw, float pitch);
 	glm::vec3 GetPosition() const;
 	glm::vec3 GetFront() const;
+	float GetFov() const;
+	float GetNearPlane() const;
+	float GetFarPlane() const;
+	float GetAspectRatio() const;
 	glm::mat4 GetViewMatrix() const;
 	glm::mat4 GetProjectionMatrix() const;
 	glm::mat4 GetSpaceMatrix() const;
@@ -6,47 +6,34 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include "Object.h"
-#include "Force.h"
-
-#define GEAR_RATIO_1 2.66f
-#define GEAR_RATIO_2 1.78f
-#define GEAR_RATIO_3 1.30f
-#define GEAR_RATIO_4 1.0f
-#define GEAR_RATIO_5 0.74f
-#define GEAR_RATIO_6 0.50f
-#define GEAR_RATIO_R 2.90f
+#include "VehicleSimulation.h"
+#include "CollisionSystem.h"
 
 class Car : public Object
 {
 private:
-	void AddResistanceForces();
-	float mass;
-	float wheelsAxisDist;
-	float wheelsRadius;
-	float gearRatio;
-	float diffRatio;
-	float transEfficiency;
-	float gasPercentage;
-	float maxTorque;
-	float angularVel;
-	double maxTurnAngle;
-	double currentTurnAngle;
+	VehicleSimulation* simulation;
+	unsigned int vehicleIndex;
+	CollisionSystem* collisions = NULL;
 public:
-	Car();
-	Car(const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
-		const glm::vec3& force, float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle);
-	Car(const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
+	Car(VehicleSimulation& simulation, const glm::vec3& dir, const glm::dvec3& speed, const glm::vec3& position,
 		float maxTorque, float mass, float wheelsAxisDist, double maxTurnAngle);
 	~Car();
 
 	virtual void Move(double deltaTime) override final;
-	void Turn(double angle, double deltaTime);
+	virtual void SetPosition(const glm::vec3& position) override;
+	virtual void SetDirection(const glm::vec3& direction) override;
+	virtual void Teleport(const glm::vec3& position) override;
 	void SetGearRatio(float ratio);
 	float GetEngineForce();
 	float GetWheelsAxisDist();
 	double GetCurrentTurnAngle();
 	double GetMaxTurnAngle();
 	float GetDriveForce();
+	unsigned int GetVehicleIndex() const;
+	void GetBodyShape(glm::vec3& halfExtents, glm::vec3& center);
+	void BindToCollisions(CollisionSystem* collisions);
+	CarControls GetControls() const;
+	void SetControls(const CarControls& controls);
 	virtual void ProcessInput(const std::vector<Key>& keys, Mouse& mouse, double dTime) override;
 };
-
@@ -0,0 +1,236 @@
+#include "CollisionSystem.h"
+#include <algorithm>
+
+CollisionStats::CollisionStats()
+{
+	bodiesCount = 0;
+	pairsTested = 0;
+	contactsCount = 0;
+}
+
+CollisionSystem::CollisionSystem()
+{
+	restitution = 0.2f;
+	penetrationSlop = 0.01f;
+}
+
+void CollisionSystem::Reserve(unsigned int bodiesCount)
+{
+	active.reserve(bodiesCount);
+	halfExtents.reserve(bodiesCount);
+	centers.reserve(bodiesCount);
+	worldCenters.reserve(bodiesCount);
+	forwards.reserve(bodiesCount);
+	minX.reserve(bodiesCount);
+	maxX.reserve(bodiesCount);
+	minZ.reserve(bodiesCount);
+	maxZ.reserve(bodiesCount);
+	sortedBodies.reserve(bodiesCount);
+	//	In dense traffic a car touches at most a few neighbours
+	contacts.reserve(bodiesCount * 2);
+}
+
+void CollisionSystem::AddBody(unsigned int vehicle, const glm::vec3& halfExtents, const glm::vec3& center)
+{
+	//	Bodies are indexed like the vehicle slots, the box is given in the car frame: forward, up, right
+	if (vehicle >= active.size())
+	{
+		unsigned int size = vehicle + 1;
+		active.resize(size, 0);
+		this->halfExtents.resize(size);
+		centers.resize(size);
+		worldCenters.resize(size);
+		forwards.resize(size);
+		minX.resize(size);
+		maxX.resize(size);
+		minZ.resize(size);
+		maxZ.resize(size);
+	}
+	if (!active[vehicle])
+	{
+		active[vehicle] = 1;
+		sortedBodies.push_back(vehicle);
+		stats.bodiesCount++;
+	}
+	this->halfExtents[vehicle] = glm::abs(halfExtents);
+	centers[vehicle] = center;
+	if (contacts.capacity() < sortedBodies.size() * 2)
+		contacts.reserve(sortedBodies.size() * 2);
+}
+
+void CollisionSystem::RemoveBody(unsigned int vehicle)
+{
+	if (vehicle >= active.size() || !active[vehicle]) return;
+	active[vehicle] = 0;
+	sortedBodies.erase(std::find(sortedBodies.begin(), sortedBodies.end(), vehicle));
+	stats.bodiesCount--;
+}
+
+void CollisionSystem::Clear()
+{
+	active.clear();
+	halfExtents.clear();
+	centers.clear();
+	worldCenters.clear();
+	forwards.clear();
+	minX.clear();
+	maxX.clear();
+	minZ.clear();
+	maxZ.clear();
+	sortedBodies.clear();
+	contacts.clear();
+	stats = CollisionStats();
+}
+
+void CollisionSystem::Update(VehicleSimulation& simulation)
+{
+	stats.pairsTested = 0;
+	UpdateBounds(simulation);
+	SortBodies();
+	FindContacts();
+	ResolveContacts(simulation);
+	stats.contactsCount = contacts.size();
+}
+
+void CollisionSystem::UpdateBounds(const VehicleSimulation& simulation)
+{
+	//	Cars only yaw, so the box is handled in the X/Z plane and its height stays vertical
+	for (int i = 0; i < sortedBodies.size(); i++)
+	{
+		unsigned int body = sortedBodies[i];
+		glm::vec3 direction = simulation.GetDirection(body);
+		glm::vec2 forward = glm::vec2(direction.x, direction.z);
+		float length = glm::length(forward);
+		forward = length > 0.0f ? forward / length : glm::vec2(1.0f, 0.0f);
+		glm::vec2 right = glm::vec2(-forward.y, forward.x);
+		const glm::vec3& extents = halfExtents[body];
+		const glm::vec3& center = centers[body];
+		glm::vec3 position = simulation.GetPosition(body);
+		glm::vec3 worldCenter = glm::vec3(position.x + forward.x * center.x + right.x * center.z, position.y + center.y,
+			position.z + forward.y * center.x + right.y * center.z);
+		float extentX = glm::abs(forward.x) * extents.x + glm::abs(right.x) * extents.z;
+		float extentZ = glm::abs(forward.y) * extents.x + glm::abs(right.y) * extents.z;
+		forwards[body] = forward;
+		worldCenters[body] = worldCenter;
+		minX[body] = worldCenter.x - extentX;
+		maxX[body] = worldCenter.x + extentX;
+		minZ[body] = worldCenter.z - extentZ;
+		maxZ[body] = worldCenter.z + extentZ;
+	}
+}
+
+void CollisionSystem::SortBodies()
+{
+	//	Cars move little between steps, so the order of the previous step is almost sorted
+	//	and insertion sort finishes in about one pass without allocating
+	for (int i = 1; i < sortedBodies.size(); i++)
+	{
+		unsigned int body = sortedBodies[i];
+		float key = minX[body];
+		int j = i - 1;
+		while (j >= 0 && minX[sortedBodies[j]] > key)
+		{
+			sortedBodies[j + 1] = sortedBodies[j];
+			j--;
+		}
+		sortedBodies[j + 1] = body;
+	}
+}
+
+void CollisionSystem::FindContacts()
+{
+	//	Sweep along the road: a body is only paired with the following ones whose interval starts before it ends
+	contacts.clear();
+	int count = sortedBodies.size();
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int first = sortedBodies[i];
+		for (int j = i + 1; j < count; j++)
+		{
+			unsigned int second = sortedBodies[j];
+			if (minX[second] > maxX[first]) break;
+			if (minZ[second] > maxZ[first] || maxZ[second] < minZ[first]) continue;
+			stats.pairsTested++;
+			Contact contact;
+			if (TestPair(first, second, contact))
+				contacts.push_back(contact);
+		}
+	}
+}
+
+bool CollisionSystem::TestPair(unsigned int first, unsigned int second, Contact& contact) const
+{
+	//	Separating axis test of two boxes on the ground plane, the axis of least overlap becomes the normal
+	const glm::vec3& extentsA = halfExtents[first];
+	const glm::vec3& extentsB = halfExtents[second];
+	glm::vec3 delta = worldCenters[second] - worldCenters[first];
+	if (glm::abs(delta.y) > extentsA.y + extentsB.y) return false;
+	glm::vec2 distance = glm::vec2(delta.x, delta.z);
+	glm::vec2 forwardA = forwards[first];
+	glm::vec2 forwardB = forwards[second];
+	glm::vec2 rightA = glm::vec2(-forwardA.y, forwardA.x);
+	glm::vec2 rightB = glm::vec2(-forwardB.y, forwardB.x);
+	glm::vec2 axes[4] = { forwardA, rightA, forwardB, rightB };
+	float minOverlap = FLT_MAX;
+	glm::vec2 normal = forwardA;
+	for (int i = 0; i < 4; i++)
+	{
+		const glm::vec2& axis = axes[i];
+		float projectionA = extentsA.x * glm::abs(glm::dot(forwardA, axis)) + extentsA.z * glm::abs(glm::dot(rightA, axis));
+		float projectionB = extentsB.x * glm::abs(glm::dot(forwardB, axis)) + extentsB.z * glm::abs(glm::dot(rightB, axis));
+		float offset = glm::dot(distance, axis);
+		float overlap = projectionA + projectionB - glm::abs(offset);
+		if (overlap <= 0.0f) return false;
+		if (overlap < minOverlap)
+		{
+			minOverlap = overlap;
+			normal = offset < 0.0f ? -axis : axis;
+		}
+	}
+	contact.first = first;
+	contact.second = second;
+	contact.normal = normal;
+	contact.depth = minOverlap;
+	return true;
+}
+
+void CollisionSystem::ResolveContacts(VehicleSimulation& simulation)
+{
+	//	The impulse changes speeds directly, the drive and friction of the next step act on the result.
+	//	Penetration is split by inverse mass and pushed out, so cars do not sink into each other
+	for (int i = 0; i < contacts.size(); i++)
+	{
+		const Contact& contact = contacts[i];
+		glm::vec3 normal = glm::vec3(contact.normal.x, 0.0f, contact.normal.y);
+		float inverseMassA = 1.0f / simulation.GetMass(contact.first);
+		float inverseMassB = 1.0f / simulation.GetMass(contact.second);
+		float inverseMassSum = inverseMassA + inverseMassB;
+		glm::vec3 speedA = simulation.GetSpeed(contact.first);
+		glm::vec3 speedB = simulation.GetSpeed(contact.second);
+		float approach = glm::dot(speedB - speedA, normal);
+		if (approach < 0.0f)
+		{
+			float impulse = -(1.0f + restitution) * approach / inverseMassSum;
+			simulation.SetSpeed(contact.first, speedA - normal * (impulse * inverseMassA));
+			simulation.SetSpeed(contact.second, speedB + normal * (impulse * inverseMassB));
+		}
+		float correction = glm::max(contact.depth - penetrationSlop, 0.0f) * 0.8f / inverseMassSum;
+		simulation.SetPosition(contact.first, simulation.GetPosition(contact.first) - normal * (correction * inverseMassA));
+		simulation.SetPosition(contact.second, simulation.GetPosition(contact.second) + normal * (correction * inverseMassB));
+	}
+}
+
+const CollisionStats& CollisionSystem::GetStats() const
+{
+	return stats;
+}
+
+float CollisionSystem::GetRestitution() const
+{
+	return restitution;
+}
+
+void CollisionSystem::SetRestitution(float restitution)
+{
+	this->restitution = glm::clamp(restitution, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <cfloat>
+#include "VehicleSimulation.h"
+
+struct CollisionStats
+{
+	unsigned int bodiesCount;
+	unsigned int pairsTested;
+	unsigned int contactsCount;
+	CollisionStats();
+};
+
+class CollisionSystem
+{
+private:
+	struct Contact
+	{
+		unsigned int first;
+		unsigned int second;
+		glm::vec2 normal;
+		float depth;
+	};
+	std::vector<unsigned char> active;
+	std::vector<glm::vec3> halfExtents;
+	std::vector<glm::vec3> centers;
+	std::vector<glm::vec3> worldCenters;
+	std::vector<glm::vec2> forwards;
+	std::vector<float> minX;
+	std::vector<float> maxX;
+	std::vector<float> minZ;
+	std::vector<float> maxZ;
+	std::vector<unsigned int> sortedBodies;
+	std::vector<Contact> contacts;
+	float restitution;
+	float penetrationSlop;
+	CollisionStats stats;
+	void UpdateBounds(const VehicleSimulation& simulation);
+	void SortBodies();
+	void FindContacts();
+	bool TestPair(unsigned int first, unsigned int second, Contact& contact) const;
+	void ResolveContacts(VehicleSimulation& simulation);
+public:
+	CollisionSystem();
+	void Reserve(unsigned int bodiesCount);
+	void AddBody(unsigned int vehicle, const glm::vec3& halfExtents, const glm::vec3& center);
+	void RemoveBody(unsigned int vehicle);
+	void Clear();
+	void Update(VehicleSimulation& simulation);
+	const CollisionStats& GetStats() const;
+	float GetRestitution() const;
+	void SetRestitution(float restitution);
+};
\ No newline at end of file
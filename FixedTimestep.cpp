@@ -0,0 +1,96 @@
+#include "FixedTimestep.h"
+#include <iostream>
+
+FixedTimestepStats::FixedTimestepStats()
+{
+	framesCount = 0;
+	stepsCount = 0;
+	droppedStepsCount = 0;
+	simulationTime = 0.0;
+	renderTime = 0.0;
+}
+
+FixedTimestep::FixedTimestep(double frequency, unsigned int maxStepsPerFrame)
+{
+	SetFrequency(frequency);
+	SetMaxStepsPerFrame(maxStepsPerFrame);
+	accumulator = 0.0;
+}
+
+unsigned int FixedTimestep::Advance(double frameTime)
+{
+	if (frameTime > 0.0)
+		accumulator += frameTime;
+	unsigned long long steps = (unsigned long long)(accumulator / stepDuration);
+	accumulator -= steps * stepDuration;
+	//	After a long stall the simulation falls behind instead of catching up in one frame
+	if (steps > maxStepsPerFrame)
+	{
+		stats.droppedStepsCount += steps - maxStepsPerFrame;
+		steps = maxStepsPerFrame;
+	}
+	stats.framesCount++;
+	stats.stepsCount += steps;
+	return (unsigned int)steps;
+}
+
+double FixedTimestep::GetStepDuration() const
+{
+	return stepDuration;
+}
+
+double FixedTimestep::GetFrequency() const
+{
+	return 1.0 / stepDuration;
+}
+
+unsigned int FixedTimestep::GetMaxStepsPerFrame() const
+{
+	return maxStepsPerFrame;
+}
+
+float FixedTimestep::GetAlpha() const
+{
+	return glm::clamp((float)(accumulator / stepDuration), 0.0f, 1.0f);
+}
+
+const FixedTimestepStats& FixedTimestep::GetStats() const
+{
+	return stats;
+}
+
+void FixedTimestep::SetFrequency(double frequency)
+{
+	stepDuration = 1.0 / glm::clamp(frequency, 1.0, 1000.0);
+}
+
+void FixedTimestep::SetMaxStepsPerFrame(unsigned int count)
+{
+	maxStepsPerFrame = glm::max(1u, count);
+}
+
+void FixedTimestep::AddSimulationTime(double time)
+{
+	stats.simulationTime += time;
+}
+
+void FixedTimestep::AddRenderTime(double time)
+{
+	stats.renderTime += time;
+}
+
+void FixedTimestep::PrintReport() const
+{
+	if (stats.framesCount == 0) return;
+	double stepTime = stats.stepsCount > 0 ? stats.simulationTime / stats.stepsCount : 0.0;
+	std::cout << "Simulation at " << GetFrequency() << " Hz: " << stats.stepsCount << " steps, "
+		<< stepTime * 1000.0 << " ms per step, " << stats.droppedStepsCount << " steps dropped" << std::endl;
+	std::cout << "Rendering: " << stats.framesCount << " frames, "
+		<< stats.renderTime / stats.framesCount * 1000.0 << " ms per frame" << std::endl;
+}
+
+void FixedTimestep::Reset()
+{
+	accumulator = 0.0;
+	stats = FixedTimestepStats();
+}
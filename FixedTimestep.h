@@ -0,0 +1,36 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+struct FixedTimestepStats
+{
+	unsigned long long framesCount;
+	unsigned long long stepsCount;
+	unsigned long long droppedStepsCount;
+	double simulationTime;
+	double renderTime;
+	FixedTimestepStats();
+};
+
+class FixedTimestep
+{
+private:
+	double stepDuration;
+	unsigned int maxStepsPerFrame;
+	double accumulator;
+	FixedTimestepStats stats;
+public:
+	FixedTimestep(double frequency = 120.0, unsigned int maxStepsPerFrame = 8);
+	unsigned int Advance(double frameTime);
+	double GetStepDuration() const;
+	double GetFrequency() const;
+	unsigned int GetMaxStepsPerFrame() const;
+	float GetAlpha() const;
+	const FixedTimestepStats& GetStats() const;
+	void SetFrequency(double frequency);
+	void SetMaxStepsPerFrame(unsigned int count);
+	void AddSimulationTime(double time);
+	void AddRenderTime(double time);
+	void PrintReport() const;
+	void Reset();
+};
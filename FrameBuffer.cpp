@@ -176,6 +176,7 @@ void DepthFrameBuffer::BindTexture(const Texture& texture)
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, boundTexture->GetId(), 0);
 	}; break;
 	case TextureType::CUBEMAP:
+	case TextureType::TEXTURE2D_ARRAY:
 	{
 		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, boundTexture->GetId(), 0);
 	}; break;
@@ -183,6 +184,16 @@ void DepthFrameBuffer::BindTexture(const Texture& texture)
 	Unbind();
 }
 
+void DepthFrameBuffer::BindTextureLayer(const Texture& texture, int layer)
+{
+	Bind();
+	boundTexture = &texture;
+	if (texture.GetType() == TextureType::CUBEMAP)
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer, boundTexture->GetId(), 0);
+	else glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, boundTexture->GetId(), 0, layer);
+	Unbind();
+}
+
 void DepthFrameBuffer::UnbindTexture()
 {
 	if (boundTexture == NULL) return;
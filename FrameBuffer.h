@@ -51,6 +51,7 @@ public:
 	DepthFrameBuffer(int width, int height, const Shader* shader = NULL);
 	~DepthFrameBuffer();
 	virtual void BindTexture(const Texture& texture) override;
+	void BindTextureLayer(const Texture& texture, int layer);
 	virtual void UnbindTexture() override;
 	virtual void PrepareForRender() override;
 };
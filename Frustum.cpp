@@ -0,0 +1,126 @@
+#include "Frustum.h"
+
+AABB::AABB()
+{
+	min = glm::vec3(FLT_MAX);
+	max = glm::vec3(-FLT_MAX);
+}
+
+AABB::AABB(const glm::vec3& min, const glm::vec3& max)
+{
+	this->min = min;
+	this->max = max;
+}
+
+bool AABB::IsValid() const
+{
+	return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+void AABB::Expand(const glm::vec3& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void AABB::Expand(const AABB& box)
+{
+	if (!box.IsValid()) return;
+	min = glm::min(min, box.min);
+	max = glm::max(max, box.max);
+}
+
+AABB AABB::Transform(const glm::mat4& matrix) const
+{
+	if (!IsValid()) return AABB();
+	//	Center is moved as a point, extents are projected onto the new axes
+	glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+	glm::vec3 extents = GetExtents();
+	glm::vec3 newExtents;
+	for (int i = 0; i < 3; i++)
+	{
+		newExtents[i] = glm::abs(matrix[0][i]) * extents.x + glm::abs(matrix[1][i]) * extents.y +
+			glm::abs(matrix[2][i]) * extents.z;
+	}
+	return AABB(center - newExtents, center + newExtents);
+}
+
+glm::vec3 AABB::GetCenter() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::GetExtents() const
+{
+	return (max - min) * 0.5f;
+}
+
+bool AABB::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	if (!IsValid()) return true;
+	glm::vec3 closest = glm::clamp(center, min, max);
+	glm::vec3 delta = closest - center;
+	return glm::dot(delta, delta) <= radius * radius;
+}
+
+Frustum::Frustum()
+{
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+Frustum::Frustum(const glm::mat4& spaceMatrix)
+{
+	Update(spaceMatrix);
+}
+
+void Frustum::Update(const glm::mat4& spaceMatrix)
+{
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(spaceMatrix[0][i], spaceMatrix[1][i], spaceMatrix[2][i], spaceMatrix[3][i]);
+	}
+	//	Left, right, bottom, top, near, far
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] + rows[2];
+	planes[5] = rows[3] - rows[2];
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(planes[i]));
+		if (length > 0.0f)
+			planes[i] /= length;
+	}
+}
+
+bool Frustum::Intersects(const AABB& box) const
+{
+	//	Objects without bounds are never culled
+	if (!box.IsValid()) return true;
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extents = box.GetExtents();
+	for (int i = 0; i < 6; i++)
+	{
+		glm::vec3 normal = glm::vec3(planes[i]);
+		float distance = glm::dot(normal, center) + planes[i].w;
+		float radius = glm::dot(glm::abs(normal), extents);
+		if (distance + radius < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::Intersects(const glm::vec3& center, float radius) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+			return false;
+	}
+	return true;
+}
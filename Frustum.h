@@ -0,0 +1,31 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <cfloat>
+
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+	AABB();
+	AABB(const glm::vec3& min, const glm::vec3& max);
+	bool IsValid() const;
+	void Expand(const glm::vec3& point);
+	void Expand(const AABB& box);
+	AABB Transform(const glm::mat4& matrix) const;
+	glm::vec3 GetCenter() const;
+	glm::vec3 GetExtents() const;
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+class Frustum
+{
+private:
+	glm::vec4 planes[6];
+public:
+	Frustum();
+	Frustum(const glm::mat4& spaceMatrix);
+	void Update(const glm::mat4& spaceMatrix);
+	bool Intersects(const AABB& box) const;
+	bool Intersects(const glm::vec3& center, float radius) const;
+};
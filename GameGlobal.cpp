@@ -102,6 +102,12 @@ GameGlobal::~GameGlobal()
 		delete it->second;
 	}
 	shaders.clear();
+	delete instanceBuffer;
+	delete shadowAtlas;
+	delete shadowCache;
+	delete shadowCascades;
+	delete assetLoader;
+	delete jobSystem;
 }
 
 void GameGlobal::Initialize()
@@ -111,10 +117,21 @@ void GameGlobal::Initialize()
 	map = NULL;
 	MaterialShader* standartShader = new MaterialShader("shaders\\standart_shader.vert", "shaders\\standart_shader.frag");
 	shaders.insert(std::make_pair("standart", standartShader));
+	MaterialShader* standartShaderInstanced = new MaterialShader("shaders\\standart_shader_instanced.vert", "shaders\\standart_shader.frag");
+	shaders.insert(std::make_pair("standart_instanced", standartShaderInstanced));
+	standartShader->SetInstancedVariant(standartShaderInstanced);
 	MaterialShader* skyboxShader = new MaterialShader("shaders\\skybox_shader.vert", "shaders\\skybox_shader.frag");
 	shaders.insert(std::make_pair("skybox", skyboxShader));
 	MaterialShader* raindropShader = new MaterialShader("shaders\\raindrop_shader.vert", "shaders\\raindrop_shader.frag");
 	shaders.insert(std::make_pair("raindrop", raindropShader));
+	//	  GPU    (OpenGL 4.3)
+	if (GLEW_ARB_compute_shader)
+	{
+		ComputeShader* particlesUpdateShader = new ComputeShader("shaders\\particles_update.comp");
+		shaders.insert(std::make_pair("particles_update", particlesUpdateShader));
+		MaterialShader* raindropGpuShader = new MaterialShader("shaders\\raindrop_shader_gpu.vert", "shaders\\raindrop_shader.frag");
+		shaders.insert(std::make_pair("raindrop_gpu", raindropGpuShader));
+	}
 
 	ScreenShader* screenShader = new ScreenShader("shaders\\screen_shader.vert", "shaders\\screen_shader.frag");
 	shaders.insert(std::make_pair("screen", screenShader));
@@ -122,16 +139,59 @@ void GameGlobal::Initialize()
 
 	ShadowMapShader* depthShader = new ShadowMapShader("shaders\\depth_shader.vert", "shaders\\depth_shader.frag");
 	shaders.insert(std::make_pair("depth", depthShader));
+	ShadowMapShader* depthShaderInstanced = new ShadowMapShader("shaders\\depth_shader_instanced.vert", "shaders\\depth_shader.frag");
+	shaders.insert(std::make_pair("depth_instanced", depthShaderInstanced));
+	depthShader->SetInstancedVariant(depthShaderInstanced);
 
 	ShadowMapShader* depthShaderCubeMap = new ShadowMapShader("shaders\\depth_shader_cube_map.vert", "shaders\\depth_shader.frag", 
 		"shaders\\depth_shader_cube_map.geom");
 	shaders.insert(std::make_pair("depth_cube_map", depthShaderCubeMap));
+	ShadowMapShader* depthShaderCubeMapInstanced = new ShadowMapShader("shaders\\depth_shader_cube_map_instanced.vert",
+		"shaders\\depth_shader.frag", "shaders\\depth_shader_cube_map.geom");
+	shaders.insert(std::make_pair("depth_cube_map_instanced", depthShaderCubeMapInstanced));
+	depthShaderCubeMap->SetInstancedVariant(depthShaderCubeMapInstanced);
+	InitPointShadows();
 
 	depthBuffer = new DepthFrameBuffer(1024, 1024, NULL);
+	shadowAtlas = new ShadowAtlas(1024, 8, 1024, 2);
+	shadowCache = new ShadowCache(1024, 16);
+	shadowCascades = new ShadowCascades(2048, 4, 150.0f);
+	instanceBuffer = new InstanceBuffer(256);
+	//	      ,   GL -  
+	assetLoader = new AssetLoader();
+	//	     
+	jobSystem = new JobSystem();
 
 	InitKeys();
 	map = new Map(*this);
 	map->Initialize();
+	//	       Assimp
+	const ModelLoadStats& loadStats = Model::GetLoadStats();
+	std::cout << "Models loaded from cache: " << loadStats.cachedCount << " in " << loadStats.cachedTime * 1000.0 << " ms, "
+		<< "imported: " << loadStats.importedCount << " in " << loadStats.importedTime * 1000.0 << " ms" << std::endl;
+	const TextureCacheStats& textureStats = TextureCache::GetStats();
+	std::cout << "Textures resident: " << textureStats.residentCount << " (" << textureStats.residentBytes / (1024 * 1024) << " MB), "
+		<< "cache hits: " << textureStats.hits << ", misses: " << textureStats.misses << std::endl;
+}
+
+void GameGlobal::InitPointShadows()
+{
+	//	        ,
+	//	     
+	if (GLEW_ARB_shader_viewport_layer_array || GLEW_AMD_vertex_shader_layer)
+	{
+		pointShadowMode = PointShadowMode::LAYERED;
+		//	         
+		ShadowMapShader* layeredShader = new ShadowMapShader("shaders\\depth_shader_cube_map.vert", "shaders\\depth_shader.frag",
+			"shaders\\depth_shader_cube_map.geom");
+		shaders.insert(std::make_pair("depth_cube_map_layered", layeredShader));
+		ShadowMapShader* layeredShaderInstanced = new ShadowMapShader("shaders\\depth_shader_cube_map_layered_instanced.vert",
+			"shaders\\depth_shader.frag");
+		shaders.insert(std::make_pair("depth_cube_map_layered_instanced", layeredShaderInstanced));
+		layeredShader->SetInstancedVariant(layeredShaderInstanced);
+	}
+	else pointShadowMode = PointShadowMode::MULTIPASS;
+	std::cout << "Point shadows: " << PointShadowBenchmark::GetModeName(pointShadowMode) << std::endl;
 }
 
 bool GameGlobal::InitOpenGL()
@@ -256,3 +316,13 @@ Map* GameGlobal::GetMap()
 {
 	return map;
 }
+
+JobSystem* GameGlobal::GetJobSystem()
+{
+	return jobSystem;
+}
+
+PointShadowMode GameGlobal::GetPointShadowMode() const
+{
+	return pointShadowMode;
+}
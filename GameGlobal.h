@@ -9,6 +9,14 @@
 #include "GameGlobalStructs.h"
 #include "Map.h"
 #include "FrameBuffer.h"
+#include "ShadowAtlas.h"
+#include "ShadowCache.h"
+#include "ShadowCascades.h"
+#include "InstanceBuffer.h"
+#include "PointShadowBenchmark.h"
+#include "AssetLoader.h"
+#include "JobSystem.h"
+#include "TextureCache.h"
 #include "Shader.h"
 
 class Map;
@@ -25,6 +33,13 @@ private:
 	Map* map;
 	ScreenFrameBuffer* screenBuffer;
 	DepthFrameBuffer* depthBuffer;
+	ShadowAtlas* shadowAtlas;
+	ShadowCache* shadowCache;
+	ShadowCascades* shadowCascades;
+	InstanceBuffer* instanceBuffer;
+	AssetLoader* assetLoader;
+	JobSystem* jobSystem;
+	PointShadowMode pointShadowMode;
 	std::map<std::string, Shader*> shaders;
 	class GameProperties
 	{
@@ -49,6 +64,7 @@ private:
 	};
 	void Initialize();
 	bool InitOpenGL();
+	void InitPointShadows();
 public:
 	GameProperties gameProps;
 	Mouse mouse;
@@ -64,6 +80,8 @@ public:
 	void ChangeTimeCoef(double changingValue);
 	double GetDeltaTime() const;
 	Map* GetMap();
+	JobSystem* GetJobSystem();
+	PointShadowMode GetPointShadowMode() const;
 	GLFWwindow* GetWindow();
 	void ProcessInput();
 };
@@ -0,0 +1,118 @@
+#include "GpuParticles.h"
+#include <vector>
+
+//	Particle storage must match shaders\particles_update.comp: position and age, then velocity
+struct GpuParticle
+{
+	glm::vec4 positionAge;
+	glm::vec4 velocity;
+};
+
+//	Layout of the arguments of glDrawElementsIndirect
+struct DrawElementsCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLuint baseVertex;
+	GLuint baseInstance;
+};
+
+GpuParticleSpawn::GpuParticleSpawn()
+{
+	count = 0;
+	emitterPosition = glm::vec3(0.0f);
+	offset = glm::vec3(0.0f);
+	offsetRandom = 0.0f;
+}
+
+GpuParticles::GpuParticles(unsigned int capacity, float lifetime)
+{
+	this->capacity = glm::max(capacity, 1u);
+	this->lifetime = glm::max(lifetime, 0.0f);
+	spawnCursor = 0;
+	seed = 1;
+	glGenBuffers(1, &particlesBuffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &aliveBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, particlesBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->capacity * sizeof(GpuParticle), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, aliveBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->capacity * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawElementsCommand), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	Clear();
+}
+
+GpuParticles::~GpuParticles()
+{
+	glDeleteBuffers(1, &particlesBuffer);
+	glDeleteBuffers(1, &commandBuffer);
+	glDeleteBuffers(1, &aliveBuffer);
+}
+
+void GpuParticles::BindBuffers() const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particlesBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, aliveBuffer);
+}
+
+void GpuParticles::Update(const ComputeShader& shader, float dTime, glm::vec3 acceleration, const GpuParticleSpawn& spawn,
+	unsigned int indicesCount)
+{
+	//	The instance count is rebuilt by the compute pass from zero every frame
+	DrawElementsCommand command = { indicesCount, 0, 0, 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(command), &command);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	unsigned int spawnCount = glm::min(spawn.count, capacity);
+	shader.use();
+	shader.setInt("particlesCount", capacity);
+	shader.setInt("spawnStart", spawnCursor);
+	shader.setInt("spawnCount", spawnCount);
+	shader.setInt("seed", seed++);
+	shader.setFloat("dTime", dTime);
+	shader.setFloat("lifetime", lifetime);
+	shader.setVec("acceleration", acceleration);
+	shader.setVec("emitterPosition", spawn.emitterPosition);
+	shader.setVec("spawnOffset", spawn.offset);
+	shader.setFloat("offsetRandom", spawn.offsetRandom);
+	BindBuffers();
+	shader.dispatch((capacity + groupSize - 1) / groupSize);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+	spawnCursor = (spawnCursor + spawnCount) % capacity;
+}
+
+void GpuParticles::Draw(Mesh& mesh, const Shader& shader) const
+{
+	BindBuffers();
+	mesh.DrawIndirect(shader, commandBuffer);
+}
+
+void GpuParticles::Clear()
+{
+	//	Particles start dead: their age is already past the lifetime
+	std::vector<GpuParticle> particles(capacity);
+	for (int i = 0; i < particles.size(); i++)
+	{
+		particles[i].positionAge = glm::vec4(0.0f, 0.0f, 0.0f, lifetime + 1.0f);
+		particles[i].velocity = glm::vec4(0.0f);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, particlesBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, particles.size() * sizeof(GpuParticle), particles.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	spawnCursor = 0;
+}
+
+unsigned int GpuParticles::GetCapacity() const
+{
+	return capacity;
+}
+
+float GpuParticles::GetLifetime() const
+{
+	return lifetime;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "Mesh.h"
+
+struct GpuParticleSpawn
+{
+	unsigned int count;
+	glm::vec3 emitterPosition;
+	glm::vec3 offset;
+	float offsetRandom;
+	GpuParticleSpawn();
+};
+
+class GpuParticles
+{
+private:
+	static const unsigned int groupSize = 256;
+	unsigned int capacity;
+	float lifetime;
+	unsigned int spawnCursor;
+	unsigned int seed;
+	GLuint particlesBuffer;
+	GLuint commandBuffer;
+	GLuint aliveBuffer;
+	void BindBuffers() const;
+public:
+	GpuParticles(unsigned int capacity, float lifetime = 5.0f);
+	~GpuParticles();
+	void Update(const ComputeShader& shader, float dTime, glm::vec3 acceleration, const GpuParticleSpawn& spawn, unsigned int indicesCount);
+	void Draw(Mesh& mesh, const Shader& shader) const;
+	void Clear();
+	unsigned int GetCapacity() const;
+	float GetLifetime() const;
+};
@@ -0,0 +1,113 @@
+#include "InstanceBuffer.h"
+
+InstanceData::InstanceData()
+{
+	model = glm::mat4(1.0f);
+	normalMatrix = glm::mat4(1.0f);
+}
+
+InstanceData::InstanceData(const glm::mat4& model)
+{
+	this->model = model;
+	normalMatrix = glm::transpose(glm::inverse(model));
+}
+
+InstanceData::InstanceData(const glm::mat4& model, int layer)
+{
+	//	Depth passes have no use for the normal matrix, its first element carries the target layer
+	this->model = model;
+	normalMatrix = glm::mat4(0.0f);
+	normalMatrix[0][0] = (float)layer;
+}
+
+InstanceBuffer::InstanceBuffer(unsigned int capacity)
+{
+	glGenBuffers(1, &VBO);
+	Allocate(glm::max(1u, capacity));
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+	glDeleteBuffers(1, &VBO);
+}
+
+void InstanceBuffer::Allocate(unsigned int capacity)
+{
+	//	Storage is orphaned at the start of a frame, the draws of the previous one keep reading the old one
+	this->capacity = capacity;
+	count = 0;
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::Grow(unsigned int capacity)
+{
+	//	Batches appended earlier in the frame are drawn only when the render queue executes,
+	//	so their instances are carried over. The buffer keeps its name, the VAOs stay bound to it
+	if (count == 0)
+	{
+		Allocate(capacity);
+		return;
+	}
+	GLsizeiptr size = count * sizeof(InstanceData);
+	unsigned int copyVBO;
+	glGenBuffers(1, &copyVBO);
+	glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, copyVBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_COPY);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+	glBufferData(GL_COPY_READ_BUFFER, capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+	glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &copyVBO);
+	this->capacity = capacity;
+}
+
+unsigned int InstanceBuffer::ID() const
+{
+	return VBO;
+}
+
+unsigned int InstanceBuffer::GetCount() const
+{
+	return count;
+}
+
+void InstanceBuffer::Reset()
+{
+	Allocate(capacity);
+}
+
+unsigned int InstanceBuffer::Append(const std::vector<InstanceData>& instances)
+{
+	if (instances.size() == 0) return count;
+	if (count + instances.size() > capacity)
+		Grow(glm::max(capacity * 2, (unsigned int)(count + instances.size())));
+	unsigned int baseInstance = count;
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, baseInstance * sizeof(InstanceData),
+		instances.size() * sizeof(InstanceData), &instances[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	count += instances.size();
+	return baseInstance;
+}
+
+void InstanceBuffer::SetupAttributes(unsigned int VAO) const
+{
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	//	Model matrix on locations 5-8, normal matrix on 9-12
+	for (int i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(i * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(5 + i);
+		glVertexAttribDivisor(5 + i, 1);
+		glVertexAttribPointer(9 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(sizeof(glm::mat4) + i * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(9 + i);
+		glVertexAttribDivisor(9 + i, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+struct InstanceData
+{
+	glm::mat4 model;
+	glm::mat4 normalMatrix;
+	InstanceData();
+	InstanceData(const glm::mat4& model);
+	InstanceData(const glm::mat4& model, int layer);
+};
+
+class InstanceBuffer
+{
+private:
+	unsigned int VBO;
+	unsigned int capacity;
+	unsigned int count;
+	void Allocate(unsigned int capacity);
+	void Grow(unsigned int capacity);
+public:
+	InstanceBuffer(unsigned int capacity);
+	~InstanceBuffer();
+	unsigned int ID() const;
+	unsigned int GetCount() const;
+	void Reset();
+	unsigned int Append(const std::vector<InstanceData>& instances);
+	void SetupAttributes(unsigned int VAO) const;
+};
@@ -0,0 +1,146 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(unsigned int threadsCount)
+{
+	stopping = false;
+	deterministic = false;
+	queuedCount = 0;
+	//	Render and simulation threads keep their own cores
+	if (threadsCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadsCount = cores > 2 ? cores - 2 : 1;
+	}
+	//	Queue 0 is shared by the threads that submit work, the rest belong to workers
+	for (unsigned int i = 0; i <= threadsCount; i++)
+	{
+		queues.push_back(new WorkerQueue());
+	}
+	for (unsigned int i = 1; i <= threadsCount; i++)
+	{
+		workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	sleepCondition.notify_all();
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	for (int i = 0; i < queues.size(); i++)
+	{
+		delete queues[i];
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int queueIndex)
+{
+	while (true)
+	{
+		Job job;
+		if (PopJob(queueIndex, job))
+		{
+			Execute(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this] { return stopping || queuedCount > 0; });
+		if (stopping) return;
+	}
+}
+
+bool JobSystem::PopJob(unsigned int queueIndex, Job& job)
+{
+	//	Own work is taken from the back while it is still hot in cache
+	{
+		WorkerQueue* queue = queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = std::move(queue->jobs.back());
+			queue->jobs.pop_back();
+			queuedCount--;
+			return true;
+		}
+	}
+	//	Idle threads steal the oldest work of the others
+	for (unsigned int i = 1; i < queues.size(); i++)
+	{
+		WorkerQueue* queue = queues[(queueIndex + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = std::move(queue->jobs.front());
+			queue->jobs.pop_front();
+			queuedCount--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+	job.task();
+	(*job.counter)--;
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& func)
+{
+	if (count == 0) return;
+	if (grainSize == 0) grainSize = 1;
+	unsigned int chunksCount = (count + grainSize - 1) / grainSize;
+	//	Deterministic mode runs the ranges on the calling thread in index order, as a serial loop would
+	if (deterministic || chunksCount == 1 || workers.empty())
+	{
+		func(0, count);
+		return;
+	}
+	std::atomic<unsigned int> counter(chunksCount);
+	for (unsigned int i = 0; i < chunksCount; i++)
+	{
+		unsigned int begin = i * grainSize;
+		unsigned int end = begin + grainSize < count ? begin + grainSize : count;
+		Job job;
+		job.task = [&func, begin, end]() { func(begin, end); };
+		job.counter = &counter;
+		//	Chunks are spread over all queues so every worker starts with local work
+		WorkerQueue* queue = queues[i % queues.size()];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(std::move(job));
+		queuedCount++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_all();
+	//	The calling thread works on the loop too instead of blocking
+	while (counter > 0)
+	{
+		Job job;
+		if (PopJob(0, job))
+			Execute(job);
+		else std::this_thread::yield();
+	}
+}
+
+unsigned int JobSystem::GetThreadsCount() const
+{
+	return workers.size();
+}
+
+bool JobSystem::IsDeterministic() const
+{
+	return deterministic;
+}
+
+void JobSystem::SetDeterministic(bool deterministic)
+{
+	this->deterministic = deterministic;
+}
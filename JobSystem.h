@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+class JobSystem
+{
+private:
+	struct Job
+	{
+		std::function<void()> task;
+		std::atomic<unsigned int>* counter;
+	};
+	struct WorkerQueue
+	{
+		std::deque<Job> jobs;
+		std::mutex mutex;
+	};
+	std::vector<std::thread> workers;
+	std::vector<WorkerQueue*> queues;
+	std::atomic<unsigned int> queuedCount;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	bool stopping;
+	bool deterministic;
+	void WorkerLoop(unsigned int queueIndex);
+	bool PopJob(unsigned int queueIndex, Job& job);
+	void Execute(Job& job);
+public:
+	JobSystem(unsigned int threadsCount = 0);
+	~JobSystem();
+	void ParallelFor(unsigned int count, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& func);
+	unsigned int GetThreadsCount() const;
+	bool IsDeterministic() const;
+	void SetDeterministic(bool deterministic);
+};
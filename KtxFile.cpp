@@ -0,0 +1,160 @@
+#include "KtxFile.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+//	KTX 1.1: identifier, 13 header words, key/value data, then every mip level as size and data.
+//	Only single 2D images without array layers or faces are supported.
+const unsigned char KtxFile::identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+struct KtxHeader
+{
+	uint32_t endianness;
+	uint32_t glType;
+	uint32_t glTypeSize;
+	uint32_t glFormat;
+	uint32_t glInternalFormat;
+	uint32_t glBaseInternalFormat;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t numberOfArrayElements;
+	uint32_t numberOfFaces;
+	uint32_t numberOfMipmapLevels;
+	uint32_t bytesOfKeyValueData;
+};
+
+KtxImage::KtxImage()
+{
+	internalFormat = 0;
+	baseInternalFormat = 0;
+	width = 0;
+	height = 0;
+}
+
+bool KtxImage::IsEmpty() const
+{
+	return levels.empty();
+}
+
+size_t KtxImage::GetDataSize() const
+{
+	size_t size = 0;
+	for (int i = 0; i < levels.size(); i++)
+	{
+		size += levels[i].size();
+	}
+	return size;
+}
+
+void KtxImage::Clear()
+{
+	levels.clear();
+	levels.shrink_to_fit();
+	width = 0;
+	height = 0;
+}
+
+std::string KtxFile::GetCompressedPath(const std::string& sourcePath)
+{
+	return std::filesystem::path(sourcePath).replace_extension(".ktx").string();
+}
+
+bool KtxFile::Read(const std::string& path, KtxImage& image)
+{
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream.is_open())
+		return false;
+	unsigned char fileIdentifier[12];
+	KtxHeader header;
+	stream.read((char*)fileIdentifier, sizeof(fileIdentifier));
+	stream.read((char*)&header, sizeof(header));
+	if (!stream || std::memcmp(fileIdentifier, identifier, sizeof(identifier)) != 0 || header.endianness != endianness)
+	{
+		std::cout << "ERROR::KTX::Invalid file:: Path:" << path << std::endl;
+		return false;
+	}
+	if (header.glType != 0 || header.pixelDepth > 1 || header.numberOfArrayElements > 0 || header.numberOfFaces != 1)
+	{
+		std::cout << "ERROR::KTX::Only compressed 2D textures are supported:: Path:" << path << std::endl;
+		return false;
+	}
+	stream.seekg(header.bytesOfKeyValueData, std::ios::cur);
+	image.Clear();
+	image.internalFormat = header.glInternalFormat;
+	image.baseInternalFormat = header.glBaseInternalFormat;
+	image.width = header.pixelWidth;
+	image.height = header.pixelHeight;
+	unsigned int levelsCount = header.numberOfMipmapLevels > 0 ? header.numberOfMipmapLevels : 1;
+	image.levels.resize(levelsCount);
+	for (unsigned int i = 0; i < levelsCount; i++)
+	{
+		uint32_t imageSize = 0;
+		stream.read((char*)&imageSize, sizeof(imageSize));
+		image.levels[i].resize(imageSize);
+		stream.read((char*)image.levels[i].data(), imageSize);
+		//	Mip data is padded to 4 bytes
+		stream.seekg(3 - (imageSize + 3) % 4, std::ios::cur);
+		if (!stream)
+		{
+			std::cout << "ERROR::KTX::Unexpected end of file:: Path:" << path << std::endl;
+			image.Clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool KtxFile::Write(const std::string& path, const KtxImage& image)
+{
+	//	Written next to the final file and renamed, so the game never reads a half-written texture
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			std::cout << "ERROR::KTX::Couldn't create file:: Path:" << tempPath << std::endl;
+			return false;
+		}
+		KtxHeader header;
+		header.endianness = endianness;
+		header.glType = 0;
+		header.glTypeSize = 1;
+		header.glFormat = 0;
+		header.glInternalFormat = image.internalFormat;
+		header.glBaseInternalFormat = image.baseInternalFormat;
+		header.pixelWidth = image.width;
+		header.pixelHeight = image.height;
+		header.pixelDepth = 0;
+		header.numberOfArrayElements = 0;
+		header.numberOfFaces = 1;
+		header.numberOfMipmapLevels = image.levels.size();
+		header.bytesOfKeyValueData = 0;
+		stream.write((const char*)identifier, sizeof(identifier));
+		stream.write((const char*)&header, sizeof(header));
+		static const char padding[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < image.levels.size(); i++)
+		{
+			uint32_t imageSize = image.levels[i].size();
+			stream.write((const char*)&imageSize, sizeof(imageSize));
+			stream.write((const char*)image.levels[i].data(), imageSize);
+			stream.write(padding, 3 - (imageSize + 3) % 4);
+		}
+		if (!stream)
+		{
+			std::cout << "ERROR::KTX::Couldn't write file:: Path:" << tempPath << std::endl;
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		std::cout << "ERROR::KTX::Couldn't replace file:: Path:" << path << std::endl;
+		return false;
+	}
+	return true;
+}
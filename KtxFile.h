@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+struct KtxImage
+{
+	unsigned int internalFormat;
+	unsigned int baseInternalFormat;
+	int width;
+	int height;
+	std::vector<std::vector<unsigned char>> levels;
+	KtxImage();
+	bool IsEmpty() const;
+	size_t GetDataSize() const;
+	void Clear();
+};
+
+class KtxFile
+{
+private:
+	static const unsigned char identifier[12];
+	static const uint32_t endianness = 0x04030201;
+public:
+	static std::string GetCompressedPath(const std::string& sourcePath);
+	static bool Read(const std::string& path, KtxImage& image);
+	static bool Write(const std::string& path, const KtxImage& image);
+};
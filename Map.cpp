@@ -1,11 +1,27 @@
 #include "Map.h"
 
+CullingStats::CullingStats()
+{
+	objectsCount = 0;
+	mainPassCulled = 0;
+}
+
+SimulationSnapshot::SimulationSnapshot()
+{
+	playerSpeed = glm::dvec3(0.0);
+	alpha = 1.0f;
+}
+
 Map::Map(const GameGlobal& gameGlob)
 {
 	game = &gameGlob;
-	LoadGameProps();
+	pointShadowMode = game->GetPointShadowMode();
 	treesCount = 100;
 	botsCount = 15;
+	rainDropsCount = 600;
+	LoadGameProps();
+	//	  ,    
+	lightsGrid = SpatialGrid(16.0f);
 }
 
 void Map::RenderSkybox()
@@ -22,43 +38,81 @@ void Map::RenderSkybox()
 
 bool Map::LoadGameProps()
 {
-	//tinyxml2::XMLDocument doc;
-	//doc.LoadFile("C:\\Users\\nekit\\Documents\\Visual Studio 2019\\Projects\\"
-	//	"Garbage Need For Speed\\properties.xml");
-	//tinyxml2::XMLElement* root = doc.RootElement();
-
-	////	Bots count setup
-	//tinyxml2::XMLElement* node = root->FirstChildElement("bots_pop");
-	//if (node != NULL)
-	//{
-	//	try
-	//	{
-	//		int value = std::stoi(node->GetText());
-	//		if (value < 0) value = abs(value);
-	//		botsCount = (unsigned int)value;
-	//	}
-	//	catch (std::invalid_argument)
-	//	{
-	//		std::cout << "ERROR::Reading bots count from props file error." << std::endl;
-	//		botsCount = 15;
-	//	}
-	//}
-	////	Trees count setup
-	//node = root->FirstChildElement("trees_count");
-	//if (node != NULL)
-	//{
-	//	try
-	//	{
-	//		int value = std::stoi(node->GetText());
-	//		if (value < 0) value = abs(value);
-	//		treesCount = (unsigned int)value;
-	//	}
-	//	catch (std::invalid_argument)
-	//	{
-	//		std::cout << "ERROR::Reading trees count from props file error." << std::endl;
-	//		treesCount = 100;
-	//	}
-	//}
+	//	      ,      
+	tinyxml2::XMLDocument doc;
+	if (doc.LoadFile("properties.xml") != tinyxml2::XML_SUCCESS)
+	{
+		std::cout << "ERROR::MAP::Props file properties.xml is not loaded." << std::endl;
+		return false;
+	}
+	tinyxml2::XMLElement* root = doc.RootElement();
+	if (root == NULL) return false;
+
+	//	Bots count setup
+	tinyxml2::XMLElement* node = root->FirstChildElement("bots_pop");
+	if (node != NULL && node->GetText() != NULL)
+	{
+		try
+		{
+			int value = std::stoi(node->GetText());
+			if (value < 0) value = abs(value);
+			botsCount = (unsigned int)value;
+		}
+		catch (const std::exception&)
+		{
+			std::cout << "ERROR::MAP::Reading bots count from props file error." << std::endl;
+			botsCount = 15;
+		}
+	}
+	//	Trees count setup
+	node = root->FirstChildElement("trees_count");
+	if (node != NULL && node->GetText() != NULL)
+	{
+		try
+		{
+			int value = std::stoi(node->GetText());
+			if (value < 0) value = abs(value);
+			treesCount = (unsigned int)value;
+		}
+		catch (const std::exception&)
+		{
+			std::cout << "ERROR::MAP::Reading trees count from props file error." << std::endl;
+			treesCount = 100;
+		}
+	}
+	//	World seed setup: the same seed builds the same road, zero takes a random one
+	node = root->FirstChildElement("world_seed");
+	if (node != NULL)
+	{
+		RoadStreamerSettings settings = roadStreamer.GetSettings();
+		uint64_t seed = 0;
+		if (node->QueryUnsigned64Text(&seed) != tinyxml2::XML_SUCCESS)
+			std::cout << "ERROR::MAP::Reading world seed from props file error." << std::endl;
+		settings.seed = seed;
+		roadStreamer.SetSettings(settings);
+	}
+	//	Simulation LOD setup: distances of the tiers from the player and the step of mid-range bots
+	node = root->FirstChildElement("simulation_lod");
+	if (node != NULL)
+	{
+		SimulationLodSettings settings;
+		tinyxml2::XMLElement* child = node->FirstChildElement("enabled");
+		if (child != NULL && child->QueryBoolText(&settings.enabled) != tinyxml2::XML_SUCCESS)
+			std::cout << "ERROR::MAP::Reading simulation LOD switch from props file error." << std::endl;
+		child = node->FirstChildElement("full_distance");
+		if (child != NULL && child->QueryFloatText(&settings.fullDistance) != tinyxml2::XML_SUCCESS)
+			std::cout << "ERROR::MAP::Reading full simulation distance from props file error." << std::endl;
+		child = node->FirstChildElement("kinematic_distance");
+		if (child != NULL && child->QueryFloatText(&settings.kinematicDistance) != tinyxml2::XML_SUCCESS)
+			std::cout << "ERROR::MAP::Reading kinematic simulation distance from props file error." << std::endl;
+		child = node->FirstChildElement("hysteresis");
+		if (child != NULL && child->QueryFloatText(&settings.hysteresis) != tinyxml2::XML_SUCCESS)
+			std::cout << "ERROR::MAP::Reading simulation LOD hysteresis from props file error." << std::endl;
+		child = node->FirstChildElement("reduced_interval");
+		if (child != NULL && child->QueryUnsignedText(&settings.reducedInterval) != tinyxml2::XML_SUCCESS)
+			std::cout << "ERROR::MAP::Reading reduced simulation interval from props file error." << std::endl;
+		simulationLod.SetSettings(settings);
+	}
 	return true;
 }
 
@@ -71,20 +125,72 @@ void Map::Initialize()
 {
 	CameraTPM* camera = new CameraTPM(glm::vec3(0.0f, 0.0f, 2.0f));
 	SetCamera(camera);
-	//	 
-
+	//	   ,     
+	AssetLoader* loader = game->assetLoader;
+	Model* terrain[3] = {
+		loader->LoadModel(std::filesystem::canonical("models/Road Objects/terrain").string(), "terrain.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f)) ,
+		loader->LoadModel(std::filesystem::canonical("models/Road Objects/terrain").string(), "terrain2.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f)),
+		loader->LoadModel(std::filesystem::canonical("models/Road Objects/terrain").string(), "terrain3.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f))
+	};
+	Model* StreetLightModel = loader->LoadModel(std::filesystem::canonical("models/Road Objects/Street Light 5").string(),
+		"street_light.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f));
+	Model* trees[2] = {
+	loader->LoadModel(std::filesystem::canonical("models/Trees/tree7").string(), "Eastern Red Cedar_Low.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f),
+		VertexFormat::PACKED),
+	loader->LoadModel(std::filesystem::canonical("models/Trees/tree8").string(), "Fraser Fir_Low.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f),
+		VertexFormat::PACKED)
+	};
+	Model* carModel = loader->LoadModel(std::filesystem::canonical("models/2107").string(), "2107.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f),
+		VertexFormat::PACKED);
+	Model* botModels[3] =
+	{
+		loader->LoadModel(std::filesystem::canonical("models/1997 Volkswagen Golf").string(),
+		"1997_vw_golf_5door.obj", camera, glm::vec3(0.0f, 0.0f, 1.0f), VertexFormat::PACKED),
+		loader->LoadModel(std::filesystem::canonical("models/Camry").string(), "Toyota Camry .obj", camera, glm::vec3(0.0f, 0.0f, 1.0f),
+		VertexFormat::PACKED),
+		loader->LoadModel(std::filesystem::canonical("models/Nissan 240SX").string(), "240sx.obj", camera, glm::vec3(0.0f, 0.0f, 1.0f),
+		VertexFormat::PACKED)
+	};
+	Model* rainDrop = loader->LoadModel(std::filesystem::canonical("models/Other/raindrop").string(),
+		"raindrop.obj", camera, glm::vec3(1.0f, 0.0f, 0.0f));
+	//	       
 	std::vector<Texture> roadTextures;
 	roadTextures.push_back(Texture(0, TextureDataType::DIFFUSE, TextureType::TEXTURE2D, "textures/road/asphalt_road_D.png"));
 	roadTextures.push_back(Texture(0, TextureDataType::SPECULAR, TextureType::TEXTURE2D, "textures/road/asphalt_road_wet_S.png"));
+	std::vector<Texture> loadedTextures(roadTextures.size());
+	for (int i = 0; i < roadTextures.size(); i++)
+	{
+		loader->LoadTexture(roadTextures[i].GetPath(), false, [&loadedTextures, i](const Texture& texture)
+		{
+			loadedTextures[i] = texture;
+		});
+	}
+	std::vector<std::string> faces
+	{
+		"textures\\skybox\\field\\right.png", "textures\\skybox\\field\\left.png",
+		"textures\\skybox\\field\\top.png", "textures\\skybox\\field\\bottom.png",
+		"textures\\skybox\\field\\front.png", "textures\\skybox\\field\\back.png"
+	};
+	unsigned int skyboxCubeMap = 0;
+	loader->LoadCubeMap(faces, [&skyboxCubeMap](unsigned int id)
+	{
+		skyboxCubeMap = id;
+	});
+	loader->Wait([](float progress)
+	{
+		std::cout << "Loading: " << (int)(progress * 100.0f) << "%" << std::endl;
+		glfwPollEvents();
+	});
+	//	 
+	//	    ,    ,      
 	Model* roadModel = Model::CreatePlane(7.0f, 7.0f, "road_section", &roadTextures, true);
+	for (int i = 0; i < loadedTextures.size(); i++)
+	{
+		TextureCache::Release(loadedTextures[i]);
+	}
 	models.insert(std::make_pair("road_section", roadModel));
 	roadModel->SetGlobalShader(game->shaders.find("standart")->second);
 	roadModel->SetCamera(camera);
-	Model* terrain[3] = {
-		new Model(std::filesystem::canonical("models/Road Objects/terrain").string(), "terrain.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f)) ,
-		new Model(std::filesystem::canonical("models/Road Objects/terrain").string(), "terrain2.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f)),
-		new Model(std::filesystem::canonical("models/Road Objects/terrain").string(), "terrain3.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f))
-	};
 	for (int i = 0; i < 3; i++)
 	{
 		terrain[i]->SetGlobalShader(game->shaders.find("standart")->second);
@@ -94,57 +200,9 @@ void Map::Initialize()
 		mat->SetColor(MaterialType::SPECULAR, glm::vec4(0.005f, 0.005f, 0.005f, 1.0f));
 		models.insert(std::make_pair("terrain" + std::to_string(i + 1), terrain[i]));
 	}
-	for (int i = 0; i < 30; i++)
-	{
-		//	Road Section
-		Object* roadSection = new Object(glm::vec3((i - 15) * 7.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f));
-		roadSection->SetModel(roadModel);
-		AddObject(roadSection);
-		SetRoadObject(roadSection);
-		//	Terrain
-		Object* terrainSection = new Object(glm::vec3((i - 15) * 7.0f, -0.01f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f));
-		terrainSection->SetModel(terrain[i % 3]);
-		AddObject(terrainSection);
-		SetRoadObject(terrainSection);
-	}
-	Model* StreetLightModel = new Model(std::filesystem::canonical("models/Road Objects/Street Light 5").string(),
-		"street_light.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f));
 	StreetLightModel->SetScale(glm::vec3(0.085f));
 	StreetLightModel->SetGlobalShader(game->shaders.find("standart")->second);
 	models.insert(std::make_pair("street_light", StreetLightModel));
-	for (int i = 0; i < 16; i++)
-	{
-		//	Street Light Left
-		Object* streetLightLeft = new Object(glm::vec3((i - 8) * 14.0f, -0.1f, -3.7f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f));
-		streetLightLeft->SetModel(StreetLightModel);
-		AddObject(streetLightLeft);
-		SetRoadObject(streetLightLeft);
-		//	Adding Light Source
-		SpotLight* lightLeft = new SpotLight(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.1f),
-			glm::vec3(0.01f), glm::vec3(0.6f), glm::vec3(1.0f), 1.0f, 0.01f, 0.06f,
-			glm::cos(glm::radians(15.0f)), glm::cos(glm::radians(40.0f)));
-		lightLeft->SetOffset(glm::vec3(0.0f, 2.6f, 1.0f));
-		lights.push_back(lightLeft);
-		streetLightLeft->BindLightSource("lamp", lightLeft);
-		//	Street Light Right
-		Object* streetLightRight = new Object(glm::vec3((i - 8) * 14.0f, -0.1f, 3.7f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f));
-		streetLightRight->SetDirection(glm::vec3(-1.0f, 0.0f, 0.0f));
-		streetLightRight->SetModel(StreetLightModel);
-		AddObject(streetLightRight);
-		SetRoadObject(streetLightRight);
-		//	Adding Light Source
-		SpotLight* lightRight = new SpotLight(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.1f),
-			glm::vec3(0.01f), glm::vec3(0.6f), glm::vec3(1.0f), 1.0f, 0.01f, 0.06f,
-			glm::cos(glm::radians(15.0f)), glm::cos(glm::radians(40.0f)));
-		lightRight->SetOffset(glm::vec3(0.0f, 2.6f, 1.0f));
-		lights.push_back(lightRight);
-		streetLightRight->BindLightSource("lamp", lightRight);
-
-	}
-	Model* trees[2] = {
-	new Model(std::filesystem::canonical("models/Trees/tree7").string(), "Eastern Red Cedar_Low.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f)),
-	new Model(std::filesystem::canonical("models/Trees/tree8").string(), "Fraser Fir_Low.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f))
-	};
 	trees[0]->SetScale(glm::vec3(0.0035f));
 	trees[1]->SetScale(glm::vec3(0.01f));
 	for (int i = 0; i < 2; i++)
@@ -161,19 +219,49 @@ void Map::Initialize()
 		}
 		models.insert(std::make_pair("tree" + std::to_string(i + 1), trees[i]));
 	}
-	for (int i = 0, sign = 1; i < treesCount; i++)
+	//	 , ,           
+	//	   .    ,       treesCount
+	RoadStreamerSettings streamerSettings = roadStreamer.GetSettings();
+	streamerSettings.treesPerChunk = (unsigned int)glm::round(treesCount * roadStreamer.GetChunkLength() /
+		(streamerSettings.viewDistance * 2.0f));
+	if (streamerSettings.seed == 0)
 	{
-		Object* tree = new Object();
-		tree->SetModel(trees[rand() % 2]);
-		tree->SetDirection(glm::vec3((float)(rand() % 11) / 10.0f, 0.0f, (float)(rand() % 11) / 10.0f));
-		tree->SetPosition(glm::vec3((rand() % 30 - 15) * (rand() % 4 + 3.0f), 0.0f, sign * (rand() % 60 + 4.0f)));
-		AddObject(tree);
-		SetRoadObject(tree);
-		sign *= -1;
+		//	rand   15   ,     32-  random_device
+		std::random_device device;
+		streamerSettings.seed = ((uint64_t)device() << 32) ^ (uint64_t)device();
 	}
+	//	 ,        world_seed
+	std::cout << "World seed: " << streamerSettings.seed << std::endl;
+	roadStreamer.SetSettings(streamerSettings);
+	Model* roadObjectModels[roadObjectKindsCount] = {
+		roadModel, terrain[0], terrain[1], terrain[2], StreetLightModel, StreetLightModel, trees[0], trees[1]
+	};
+	for (int kind = 0; kind < roadObjectKindsCount; kind++)
+	{
+		unsigned int count = roadStreamer.GetPoolSize((RoadObjectKind)kind);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Object* object = new Object(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f));
+			object->SetModel(roadObjectModels[kind]);
+			AddObject(object);
+			SetRoadObject(object);
+			roadStreamer.AddPoolObject((RoadObjectKind)kind, object);
+			if ((RoadObjectKind)kind != RoadObjectKind::STREET_LIGHT_LEFT && (RoadObjectKind)kind != RoadObjectKind::STREET_LIGHT_RIGHT)
+				continue;
+			//	Adding Light Source
+			SpotLight* lamp = new SpotLight(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.1f),
+				glm::vec3(0.01f), glm::vec3(0.6f), glm::vec3(1.0f), 1.0f, 0.01f, 0.06f,
+				glm::cos(glm::radians(15.0f)), glm::cos(glm::radians(40.0f)));
+			lamp->SetOffset(glm::vec3(0.0f, 2.6f, 1.0f));
+			lights.push_back(lamp);
+			object->BindLightSource("lamp", lamp);
+		}
+	}
+	//	    ,     
+	roadStreamer.Update(0.0f);
 
 	//	 
-	Car* car = new Car(glm::vec3(1.0f, 0.0f, 0.0f), glm::dvec3(0.0f), glm::vec3(0.0f), 216.0f, 2000.0f, 50.0f, 50.0);
+	Car* car = new Car(vehicles, glm::vec3(1.0f, 0.0f, 0.0f), glm::dvec3(0.0f), glm::vec3(0.0f), 216.0f, 2000.0f, 50.0f, 50.0);
 	SpotLight* lightLeft = new SpotLight(glm::vec3(0.0f), glm::vec3(0.8f, -0.3f, -0.1f),
 		glm::vec3(0.004f), glm::vec3(0.9f), glm::vec3(1.0f), 1.0f, 0.09f, 0.2f,
 		glm::cos(glm::radians(12.5f)), glm::cos(glm::radians(28.5f)));
@@ -186,7 +274,6 @@ void Map::Initialize()
 	lightRight->SetOffset(glm::vec3(1.0f, 0.3f, 0.28f));
 	lights.push_back(lightRight);
 	car->BindLightSource("headlight_right", lightRight);
-	Model* carModel = new Model(std::filesystem::canonical("models/2107").string(), "2107.obj", camera, glm::vec3(0.0f, 0.0f, -1.0f));
 	carModel->SetGlobalShader(game->shaders.find("standart")->second);
 	carModel->SetScale(glm::vec3(0.45f));
 	models.insert(std::make_pair("vaz_2107", carModel));
@@ -194,14 +281,6 @@ void Map::Initialize()
 	AddObject(car);
 
 	//	 
-	Model* botModels[3] =
-	{
-		new Model(std::filesystem::canonical("models/1997 Volkswagen Golf").string(),
-		"1997_vw_golf_5door.obj", camera, glm::vec3(0.0f, 0.0f, 1.0f)),
-		new Model(std::filesystem::canonical("models/Camry").string(), "Toyota Camry .obj", camera, glm::vec3(0.0f, 0.0f, 1.0f)),
-		new Model(std::filesystem::canonical("models/Nissan 240SX").string(), "240sx.obj", camera, glm::vec3(0.0f, 0.0f, 1.0f))
-	};
-
 	botModels[0]->SetGlobalShader(game->shaders.find("standart")->second);
 	botModels[0]->SetScale(glm::vec3(0.52f));
 	models.insert(std::make_pair("volkswagen", botModels[0]));
@@ -211,12 +290,17 @@ void Map::Initialize()
 	botModels[2]->SetGlobalShader(game->shaders.find("standart")->second);
 	botModels[2]->SetScale(glm::vec3(0.55f));
 	models.insert(std::make_pair("nissan", botModels[2]));
+	//	  7 :      ,  
+	traffic.AddLane(-2.625f, -1.0f);
+	traffic.AddLane(-0.875f, -1.0f);
+	traffic.AddLane(0.875f, 1.0f);
+	traffic.AddLane(2.625f, 1.0f);
 	for (int i = 0; i < botsCount; i++)
 	{
 		int sign = 1 - 2 * (rand() % 2);
-		CarBot* bot = new CarBot(glm::vec3(sign * 1.0f, 0.0f, 0.0f), glm::dvec3(0.0f),
+		CarBot* bot = new CarBot(vehicles, traffic, simulationLod, glm::vec3(sign * 1.0f, 0.0f, 0.0f), glm::dvec3(0.0f),
 			glm::vec3((i - float(botsCount) / 2.0f) * 2.5f * 7.0f + (rand() % 9 - 4), 0.0f,
-				sign * (1.0f + (rand() % 2) * 1.5f) + (rand() % 4 - 3) / 10.0f),
+				sign * (0.875f + (rand() % 2) * 1.75f) + (rand() % 4 - 3) / 10.0f),
 			216.0f, 2000.0f, 60.0f, 50.0);
 		bot->SetModel(botModels[i % 3]);
 		AddObject(bot);
@@ -224,13 +308,7 @@ void Map::Initialize()
 	}
 
 	//	Skybox
-	std::vector<std::string> faces
-	{
-		"textures\\skybox\\field\\right.png", "textures\\skybox\\field\\left.png",
-		"textures\\skybox\\field\\top.png", "textures\\skybox\\field\\bottom.png",
-		"textures\\skybox\\field\\front.png", "textures\\skybox\\field\\back.png"
-	};
-	Model* skyboxModel = Model::CreateSkybox(faces);
+	Model* skyboxModel = Model::CreateSkybox(faces, skyboxCubeMap);
 	models.insert(std::make_pair("skybox", skyboxModel));
 	skyboxModel->SetGlobalShader(game->shaders.find("skybox")->second);
 	skyboxModel->SetCamera(camera);
@@ -247,12 +325,19 @@ void Map::Initialize()
 	//	  
 	SetPlayer(car);
 
-	camera->BindToTarget(car->GetPosition());
+	camera->BindToTarget(car->GetRenderPosition());
 	camera->offset = glm::vec3(0.0f, 0.2f, 0.0f);
-	ParticleSystem* ps = new ParticleSystem(0.02f, 3, 600, true, false, glm::vec3(6.0f, 0.0f, 6.0f), 100.0f);
+	//	  5 ,        
+	unsigned int rainSpawnCount = glm::max(3u, (unsigned int)glm::ceil(rainDropsCount * 0.02f / 5.0f));
+	ParticleSystem* ps = new ParticleSystem(0.02f, rainSpawnCount, rainDropsCount, true, false, glm::vec3(6.0f, 0.0f, 6.0f), 100.0f);
 	ps->SetParticlesAcceleration(glm::vec3(0.0f, -0.2f, 0.0f));
-	Model* rainDrop = new Model(std::filesystem::canonical("models/Other/raindrop").string(),
-		"raindrop.obj", camera, glm::vec3(1.0f, 0.0f, 0.0f));
+	//	         GPU  
+	auto particlesUpdate = game->shaders.find("particles_update");
+	auto raindropGpu = game->shaders.find("raindrop_gpu");
+	if (particlesUpdate != game->shaders.end() && raindropGpu != game->shaders.end())
+	{
+		ps->SetBackend(ParticleBackend::GPU, (ComputeShader*)particlesUpdate->second, raindropGpu->second);
+	}
 	rainDrop->SetGlobalShader(game->shaders.find("raindrop")->second);
 	rainDrop->SetCamera(camera);
 	rainDrop->GetMesh(0)->GetMaterial()->SetProperty(MaterialProp::ALPHA, 0.4f);
@@ -265,6 +350,8 @@ void Map::Initialize()
 
 	//	-  
 	lightsUbo = LightsUBO(*(game->shaders.find("standart")->second), 1, 4, 8);
+	//	-  
+	frameUbo = FrameUBO(*(game->shaders.find("standart")->second), ShadowCascades::maxCascadesCount, 8);
 
 	Texture skyboxTexture = skybox->GetModel()->GetMesh(0)->GetMaterial()->GetTextures()[0][0];
 	for (auto it = models.begin(); it != models.end(); it++)
@@ -275,6 +362,11 @@ void Map::Initialize()
 			(*mshs)[i].GetMaterial()->AddTexture(skyboxTexture);
 		}
 	}
+	BuildSimulationGrid();
+	BuildCollisionBodies();
+	BuildTraffic();
+	//	    ,     
+	WriteSnapshot(snapshots[frontSnapshot]);
 }
 
 void Map::AddObject(Object* object)
@@ -299,6 +391,8 @@ void Map::SetCamera(Camera* camera)
 
 void Map::SetRoadObject(Object* object)
 {
+	//	     ,   
+	object->SetStatic(true);
 	roadObjects.push_back(object);
 }
 
@@ -317,6 +411,374 @@ Object* Map::GetSkybox()
 	return skybox;
 }
 
+const CullingStats& Map::GetCullingStats() const
+{
+	return cullingStats;
+}
+
+const RenderQueueStats& Map::GetRenderStats() const
+{
+	//	  ,   
+	return renderQueue.GetStats();
+}
+
+const CollisionStats& Map::GetCollisionStats() const
+{
+	return collisions.GetStats();
+}
+
+TrafficSystem& Map::GetTraffic()
+{
+	return traffic;
+}
+
+const SimulationLod& Map::GetSimulationLod() const
+{
+	return simulationLod;
+}
+
+const RoadStreamer& Map::GetRoadStreamer() const
+{
+	return roadStreamer;
+}
+
+bool Map::IsInstancingEnabled() const
+{
+	return instancing;
+}
+
+void Map::EnableInstancing(bool enable)
+{
+	instancing = enable;
+}
+
+bool Map::IsShadowCachingEnabled() const
+{
+	return shadowCaching;
+}
+
+void Map::EnableShadowCaching(bool enable)
+{
+	shadowCaching = enable;
+	if (!enable) game->shadowCache->Invalidate();
+}
+
+bool Map::IsThreadedSimulationEnabled() const
+{
+	return threadedSimulation;
+}
+
+void Map::EnableThreadedSimulation(bool enable)
+{
+	//	     
+	Synchronize();
+	threadedSimulation = enable;
+}
+
+PointShadowMode Map::GetPointShadowMode() const
+{
+	return pointShadowMode;
+}
+
+void Map::SetPointShadowMode(PointShadowMode mode)
+{
+	//	   ,   
+	if (mode == PointShadowMode::LAYERED && game->GetPointShadowMode() != PointShadowMode::LAYERED)
+	{
+		std::cout << "WARNING:: Layered point shadows are not supported, mode is not changed" << std::endl;
+		return;
+	}
+	pointShadowMode = mode;
+}
+
+void Map::StartPointShadowBenchmark(int framesPerMode)
+{
+	//	        ,  GPU   
+	std::vector<PointShadowMode> modes;
+	modes.push_back(PointShadowMode::GEOMETRY);
+	if (game->GetPointShadowMode() == PointShadowMode::LAYERED)
+		modes.push_back(PointShadowMode::LAYERED);
+	modes.push_back(PointShadowMode::MULTIPASS);
+	//	    ,       
+	bool hasPointLight = false;
+	for (int i = 0; i < lights.size(); i++)
+	{
+		if (lights[i]->GetType() == SourceType::POINT) hasPointLight = true;
+	}
+	if (!hasPointLight && player != NULL)
+	{
+		PointLight* beacon = new PointLight(glm::vec3(0.0f), glm::vec3(0.01f), glm::vec3(0.8f, 0.6f, 0.3f),
+			glm::vec3(1.0f), 1.0f, 0.09f, 0.032f);
+		beacon->SetOffset(glm::vec3(0.0f, 1.6f, 0.0f));
+		lights.push_back(beacon);
+		player->BindLightSource("benchmark_beacon", beacon);
+	}
+	if (pointShadowBenchmark == NULL)
+		pointShadowBenchmark = new PointShadowBenchmark();
+	pointShadowBenchmark->Start(modes, framesPerMode);
+}
+
+FixedTimestep& Map::GetSimulationClock()
+{
+	return simulationClock;
+}
+
+void Map::PrepareObjectsForRender()
+{
+	objectsBounds.resize(objects.size());
+	objectsInstances.resize(objects.size());
+	staticObjectsCount = 0;
+	for (int i = 0; i < objects.size(); i++)
+	{
+		//	       
+		objectsBounds[i] = objects[i]->GetWorldBounds();
+		//	      ,     
+		objectsGrid.Update(i, objectsBounds[i]);
+		if (objects[i]->IsStatic())
+			staticObjectsCount++;
+		if (objects[i]->IsInstanceable())
+			objectsInstances[i] = InstanceData(objects[i]->GetModel()->GetModelMatrix());
+	}
+	game->instanceBuffer->Reset();
+}
+
+unsigned int Map::DrawObjects(const Frustum& frustum, const Shader* shader, ObjectsFilter filter)
+{
+	//	   ,  ,   
+	unsigned int filteredCount = objects.size();
+	if (filter == ObjectsFilter::STATIC)
+		filteredCount = staticObjectsCount;
+	else if (filter == ObjectsFilter::DYNAMIC)
+		filteredCount = objects.size() - staticObjectsCount;
+	visibleObjects.clear();
+	objectsGrid.QueryFrustum(frustum, renderQuery);
+	for (int j = 0; j < renderQuery.size(); j++)
+	{
+		int i = renderQuery[j];
+		if ((filter == ObjectsFilter::STATIC && !objects[i]->IsStatic()) ||
+			(filter == ObjectsFilter::DYNAMIC && objects[i]->IsStatic()))
+			continue;
+		visibleObjects.push_back(i);
+	}
+	unsigned int culled = filteredCount - visibleObjects.size();
+	DrawVisibleObjects(camera->GetPosition(), shader);
+	return culled;
+}
+
+uint64_t Map::GetStaticCastersSignature(const Frustum& frustum)
+{
+	//	 ,      ,   
+	uint64_t signature = 1469598103934665603ull;
+	objectsGrid.QueryFrustum(frustum, renderQuery);
+	for (int j = 0; j < renderQuery.size(); j++)
+	{
+		int i = renderQuery[j];
+		if (!objects[i]->IsStatic() || !objects[i]->IsInstanceable()) continue;
+		signature = ShadowCache::Hash(signature, &i, sizeof(i));
+		signature = ShadowCache::Hash(signature, &objectsInstances[i].model, sizeof(glm::mat4));
+	}
+	return signature;
+}
+
+unsigned int Map::DrawObjects(const glm::vec3& center, float radius, const Shader* shader)
+{
+	objectsGrid.QueryRange(center, radius, renderQuery);
+	unsigned int culled = objects.size() - renderQuery.size();
+	visibleObjects.clear();
+	for (int j = 0; j < renderQuery.size(); j++)
+	{
+		int i = renderQuery[j];
+		if (!objectsBounds[i].IntersectsSphere(center, radius))
+		{
+			culled++;
+			continue;
+		}
+		visibleObjects.push_back(i);
+	}
+	DrawVisibleObjects(center, shader);
+	return culled;
+}
+
+void Map::DrawVisibleObjects(const glm::vec3& viewPos, const Shader* shader)
+{
+	//	         
+	renderQueue.Clear();
+	renderQueue.SetViewPosition(viewPos);
+	unqueuedObjects.clear();
+	instanceBatches.clear();
+	for (int i = 0; i < visibleObjects.size(); i++)
+	{
+		int index = visibleObjects[i];
+		Object* object = objects[index];
+		//	    ( )   
+		if (!object->IsInstanceable())
+			unqueuedObjects.push_back(index);
+		else if (instancing)
+			instanceBatches.push_back(std::make_pair(object->GetModel(), index));
+		else renderQueue.SubmitModel(object->GetModel(), shader, objectsInstances[index].model,
+			objectsBounds[index].GetCenter());
+	}
+	//	    
+	std::sort(instanceBatches.begin(), instanceBatches.end());
+	for (int i = 0; i < instanceBatches.size();)
+	{
+		Model* model = instanceBatches[i].first;
+		int end = i;
+		while (end < instanceBatches.size() && instanceBatches[end].first == model)
+			end++;
+		//	         
+		if (end - i < 2 || !model->CanDrawInstanced(shader))
+		{
+			for (int j = i; j < end; j++)
+			{
+				int index = instanceBatches[j].second;
+				renderQueue.SubmitModel(model, shader, objectsInstances[index].model, objectsBounds[index].GetCenter());
+			}
+		}
+		else
+		{
+			batchInstances.clear();
+			for (int j = i; j < end; j++)
+			{
+				batchInstances.push_back(objectsInstances[instanceBatches[j].second]);
+			}
+			unsigned int baseInstance = game->instanceBuffer->Append(batchInstances);
+			renderQueue.SubmitModelInstanced(model, shader, *game->instanceBuffer, end - i, baseInstance,
+				objectsBounds[instanceBatches[i].second].GetCenter());
+		}
+		i = end;
+	}
+	renderQueue.Execute();
+	for (int i = 0; i < unqueuedObjects.size(); i++)
+	{
+		objects[unqueuedObjects[i]]->Draw(shader);
+	}
+}
+
+unsigned int Map::DrawObjectsLayered(const glm::vec3& center, float radius, const std::list<glm::mat4>& faceMatrices,
+	const Shader* shader)
+{
+	const int facesCount = ShadowMapShaderUniforms::cubeFacesCount;
+	Frustum faces[facesCount];
+	int index = 0;
+	for (auto it = faceMatrices.begin(); it != faceMatrices.end() && index < facesCount; it++)
+	{
+		faces[index++].Update(*it);
+	}
+	objectsGrid.QueryRange(center, radius, renderQuery);
+	unsigned int culled = objects.size() - renderQuery.size();
+	renderQueue.Clear();
+	renderQueue.SetViewPosition(center);
+	unqueuedObjects.clear();
+	layeredBatches.clear();
+	for (int j = 0; j < renderQuery.size(); j++)
+	{
+		int i = renderQuery[j];
+		if (!objectsBounds[i].IntersectsSphere(center, radius))
+		{
+			culled++;
+			continue;
+		}
+		//	         
+		if (!objects[i]->IsInstanceable() || !objects[i]->GetModel()->CanDrawInstanced(shader))
+		{
+			unqueuedObjects.push_back(i);
+			continue;
+		}
+		//	    ,     
+		bool visible = false;
+		for (int face = 0; face < index; face++)
+		{
+			if (!faces[face].Intersects(objectsBounds[i])) continue;
+			layeredBatches.push_back(std::make_pair(objects[i]->GetModel(), i * facesCount + face));
+			visible = true;
+		}
+		if (!visible) culled++;
+	}
+	//	  -  
+	std::sort(layeredBatches.begin(), layeredBatches.end());
+	for (int i = 0; i < layeredBatches.size();)
+	{
+		Model* model = layeredBatches[i].first;
+		int end = i;
+		batchInstances.clear();
+		while (end < layeredBatches.size() && layeredBatches[end].first == model)
+		{
+			int object = layeredBatches[end].second / facesCount;
+			batchInstances.push_back(InstanceData(objectsInstances[object].model, layeredBatches[end].second % facesCount));
+			end++;
+		}
+		unsigned int baseInstance = game->instanceBuffer->Append(batchInstances);
+		renderQueue.SubmitModelInstanced(model, shader, *game->instanceBuffer, end - i, baseInstance,
+			objectsBounds[layeredBatches[i].second / facesCount].GetCenter());
+		i = end;
+	}
+	renderQueue.Execute();
+	for (int i = 0; i < unqueuedObjects.size(); i++)
+	{
+		objects[unqueuedObjects[i]]->Draw(shader);
+	}
+	return culled;
+}
+
+unsigned int Map::RenderPointShadow(const PointLight* light, const Texture& shadowMap, std::list<glm::mat4>& lightSpaceMats,
+	PointShadowMode mode)
+{
+	const float farPlane = 25.9f;
+	unsigned int culled = 0;
+	switch (mode)
+	{
+	case PointShadowMode::LAYERED:
+	{
+		//	  ,     
+		ShadowMapShader* shader = (ShadowMapShader*)(game->shaders.find("depth_cube_map_layered")->second);
+		shader->setLightSpaceMatrices(lightSpaceMats);
+		shader->enableLinearDepth(true);
+		shader->setFarPlane(farPlane);
+		shader->setLightPos(light->GetPosition());
+		game->depthBuffer->BindTexture(shadowMap);
+		game->depthBuffer->Bind();
+		game->depthBuffer->PrepareForRender();
+		culled = DrawObjectsLayered(light->GetPosition(), farPlane, lightSpaceMats, shader);
+		game->depthBuffer->Unbind();
+	}; break;
+	case PointShadowMode::MULTIPASS:
+	{
+		//	       
+		ShadowMapShader* shader = (ShadowMapShader*)(game->shaders.find("depth")->second);
+		shader->enableLinearDepth(true);
+		shader->setFarPlane(farPlane);
+		shader->setLightPos(light->GetPosition());
+		int face = 0;
+		for (auto it = lightSpaceMats.begin(); it != lightSpaceMats.end(); it++, face++)
+		{
+			game->depthBuffer->BindTextureLayer(shadowMap, face);
+			game->depthBuffer->Bind();
+			game->depthBuffer->PrepareForRender();
+			shader->setLightSpaceMatrix(*it);
+			culled += DrawObjects(Frustum(*it), shader);
+			game->depthBuffer->Unbind();
+		}
+		shader->enableLinearDepth(false);
+	}; break;
+	default:
+	{
+		//	       
+		ShadowMapShader* shader = (ShadowMapShader*)(game->shaders.find("depth_cube_map")->second);
+		game->depthBuffer->BindTexture(shadowMap);
+		game->depthBuffer->Bind();
+		game->depthBuffer->PrepareForRender();
+		shader->setLightSpaceMatrices(lightSpaceMats);
+		shader->enableLinearDepth(true);
+		shader->setFarPlane(farPlane);
+		shader->setLightPos(light->GetPosition());
+		culled = DrawObjects(light->GetPosition(), farPlane, shader);
+		game->depthBuffer->Unbind();
+	}; break;
+	}
+	return culled;
+}
+
 void Map::AddBot(Bot* bot)
 {
 	bots.push_back(bot);
@@ -324,125 +786,158 @@ void Map::AddBot(Bot* bot)
 
 void Map::UpdateObjects(double dTime)
 {
-	for (int i = 0; i < objects.size(); i++)
+	//	      ,    
+	game->jobSystem->ParallelFor(objects.size(), 64, [this, dTime](unsigned int begin, unsigned int end)
 	{
-		objects[i]->Update(dTime);
-	}
+		for (unsigned int i = begin; i < end; i++)
+		{
+			if (!objects[i]->IsSimulated()) continue;
+			objects[i]->Update(dTime);
+		}
+	});
 }
 
 void Map::ActBots(double dTime)
 {
-	for (int i = 0; i < bots.size(); i++)
+	game->jobSystem->ParallelFor(bots.size(), 64, [this, dTime](unsigned int begin, unsigned int end)
 	{
-		bots[i]->Act(dTime);
-	}
+		for (unsigned int i = begin; i < end; i++)
+		{
+			bots[i]->Act(dTime);
+		}
+	});
 }
 
 void Map::Render()
 {	
+	double renderStart = glfwGetTime();
 	//	  
 	MaterialShader* matShader = (MaterialShader*)(game->shaders.find("standart")->second);
 	ShadowMapShader* shdMapShader = (ShadowMapShader*)(game->shaders.find("depth")->second);
 	ShadowMapShader* shdCubeMapShader = (ShadowMapShader*)(game->shaders.find("depth_cube_map")->second);
-	std::list<Texture> shadowMaps;
+	ShadowAtlas* shadowAtlas = game->shadowAtlas;
+	ShadowCache* shadowCache = game->shadowCache;
+	shadowCache->BeginFrame();
+	//	       
+	PrepareObjectsForRender();
+	cullingStats.objectsCount = objects.size();
+	cullingStats.shadowPassesCulled.clear();
+	//	        
+	PointShadowMode pointMode = pointShadowMode;
+	if (pointShadowBenchmark != NULL && pointShadowBenchmark->IsRunning())
+		pointMode = pointShadowBenchmark->GetMode();
+	int pLightsIndex = 0;
+	int sLightsIndex = 0;
 	for (auto it = activeLights.begin(); it != activeLights.end(); it++)
 	{
-		Texture shadowMap;
 		switch ((*it)->GetType())
 		{
 		case SourceType::DIRECTIONAL:
 		{
 			DirLight* dLight = (DirLight*)(*it);
-			shadowMap = Texture::CreateEmptyTexture(8092, 8092, TextureDataType::DEPTH);
-			game->depthBuffer->BindTexture(shadowMap);
-			//	  
-			game->depthBuffer->Bind();
-			game->depthBuffer->PrepareForRender();
-			//	   
-			glm::mat4 lightSpaceMat = dLight->GetLightSpaceMatrix(camera->GetPosition() - dLight->GetDirection() * 25.0f);
-			shdMapShader->setLightSpaceMatrix(lightSpaceMat);
+			ShadowCascades* cascades = game->shadowCascades;
+			//	           
+			cascades->Update(*camera, *dLight);
 			shdCubeMapShader->enableLinearDepth(false);
-			for (int i = 0; i < objects.size(); i++)
+			for (int i = 0; i < cascades->GetCascadesCount(); i++)
 			{
-				objects[i]->Draw(shdMapShader);
+				//	      
+				game->depthBuffer->BindTextureLayer(cascades->GetTexture(), i);
+				game->depthBuffer->Bind();
+				game->depthBuffer->PrepareForRender();
+				const glm::mat4& lightSpaceMat = cascades->GetLightSpaceMatrix(i);
+				shdMapShader->setLightSpaceMatrix(lightSpaceMat);
+				cullingStats.shadowPassesCulled.push_back(DrawObjects(Frustum(lightSpaceMat), shdMapShader));
+				game->depthBuffer->Unbind();
 			}
-			game->depthBuffer->Unbind();
-			//	   (     )
-			unsigned int shadowMapID = game->depthBuffer->GetBoundTexture()->GetId();
-			//	         
-			matShader->addLightInfo(LightInfo(lightSpaceMat, shadowMapID, SourceType::DIRECTIONAL));
+			//	    ,     
+			LightInfo info(cascades->GetLightSpaceMatrices(), cascades->GetTexture().GetId(), SourceType::DIRECTIONAL,
+				cascades->GetShadowDistance());
+			info.cascadeSplits = cascades->GetSplitDistances();
+			matShader->addLightInfo(info);
 		}; break;
 		case SourceType::POINT:
 		{
 			PointLight* pLight = (PointLight*)(*it);
-			shadowMap = Texture::CreateEmptyTexture(1024, 1024, TextureDataType::DEPTH, TextureType::CUBEMAP);
-			game->depthBuffer->BindTexture(shadowMap);
-			//	  
-			game->depthBuffer->Bind();
-			game->depthBuffer->PrepareForRender();
-			//	   
+			const Texture* shadowMap = shadowAtlas->GetPointMap(pLightsIndex++);
+			if (shadowMap == NULL) break;
 			std::list<glm::mat4> lightSpaceMats = pLight->GetLightSpaceMatrices();
-			shdCubeMapShader->setLightSpaceMatrices(lightSpaceMats);
-			shdCubeMapShader->enableLinearDepth(true);
-			shdCubeMapShader->setFarPlane(25.9f);
-			shdCubeMapShader->setLightPos(pLight->GetPosition());
-			for (int i = 0; i < objects.size(); i++)
-			{
-				objects[i]->Draw(shdCubeMapShader);
-			}
-			game->depthBuffer->Unbind();
-			//	   (     )
-			unsigned int shadowMapID = game->depthBuffer->GetBoundTexture()->GetId();
+			if (pointShadowBenchmark != NULL) pointShadowBenchmark->BeginPass();
+			cullingStats.shadowPassesCulled.push_back(RenderPointShadow(pLight, *shadowMap, lightSpaceMats, pointMode));
+			if (pointShadowBenchmark != NULL) pointShadowBenchmark->EndPass();
 			//	         
-			matShader->addLightInfo(LightInfo(lightSpaceMats, shadowMapID, SourceType::POINT, 25.9f));
+			matShader->addLightInfo(LightInfo(lightSpaceMats, shadowMap->GetId(), SourceType::POINT, 25.9f));
 		}; break;
 		case SourceType::SPOTLIGHT:
 		{
 			SpotLight* sLight = (SpotLight*)(*it);
-			shadowMap = Texture::CreateEmptyTexture(1024, 1024, TextureDataType::DEPTH);
-			game->depthBuffer->BindTexture(shadowMap);
-			//	  
-			game->depthBuffer->Bind();
-			game->depthBuffer->PrepareForRender();
+			const ShadowTile* tile = shadowAtlas->GetSpotTile(sLightsIndex++);
+			if (tile == NULL) break;
 			//	   
 			glm::mat4 lightSpaceMat = sLight->GetLightSpaceMatrix();
+			Frustum lightFrustum(lightSpaceMat);
 			shdMapShader->setLightSpaceMatrix(lightSpaceMat);
 			shdCubeMapShader->enableLinearDepth(true);
 			shdCubeMapShader->setFarPlane(25.9f);
 			shdCubeMapShader->setLightPos(sLight->GetPosition());
-			for (int i = 0; i < objects.size(); i++)
+			//	            
+			bool upToDate = false;
+			const ShadowTile* cacheTile = NULL;
+			if (shadowCaching)
+				cacheTile = shadowCache->Acquire(sLight, lightSpaceMat, GetStaticCastersSignature(lightFrustum), upToDate);
+			if (cacheTile != NULL)
+			{
+				if (!upToDate)
+				{
+					game->depthBuffer->BindTexture(shadowCache->GetTexture());
+					game->depthBuffer->Bind();
+					ShadowAtlas::PrepareTileForRender(*cacheTile);
+					DrawObjects(lightFrustum, shdMapShader, ObjectsFilter::STATIC);
+					game->depthBuffer->Unbind();
+				}
+				shadowCache->CopyTile(*cacheTile, shadowAtlas->GetTexture(), *tile);
+				//	     
+				game->depthBuffer->BindTexture(shadowAtlas->GetTexture());
+				game->depthBuffer->Bind();
+				ShadowAtlas::PrepareTileForRender(*tile, false);
+				cullingStats.shadowPassesCulled.push_back(DrawObjects(lightFrustum, shdMapShader, ObjectsFilter::DYNAMIC));
+			}
+			else
 			{
-				objects[i]->Draw(shdMapShader);
+				game->depthBuffer->BindTexture(shadowAtlas->GetTexture());
+				//	  
+				game->depthBuffer->Bind();
+				ShadowAtlas::PrepareTileForRender(*tile);
+				cullingStats.shadowPassesCulled.push_back(DrawObjects(lightFrustum, shdMapShader));
 			}
 			game->depthBuffer->Unbind();
-			//	   (     )
-			unsigned int shadowMapID = game->depthBuffer->GetBoundTexture()->GetId();
-			//	         
-			matShader->addLightInfo(LightInfo(lightSpaceMat, shadowMapID, SourceType::SPOTLIGHT));
+			//	    ,         
+			matShader->addLightInfo(LightInfo(lightSpaceMat, shadowAtlas->GetTexture().GetId(), SourceType::SPOTLIGHT,
+				25.0f, shadowAtlas->GetTileRect(*tile)));
 		}; break;
 		default: break;
 		}
-
-		shadowMaps.push_back(shadowMap);
-
 	}
 
+	//	         
+	frameUbo.LoadInfo(camera->GetViewMatrix(), camera->GetProjectionMatrix(), camera->GetPosition(),
+		matShader->getLightsInfo());
+	frameUbo.Bind();
+	//	      
+	matShader->loadLightsInfo();
+
 	//	   
 	game->screenBuffer->Bind();
 	game->screenBuffer->PrepareForRender();
 	//	 
 	RenderSkybox();
-	for (int i = 0; i < objects.size(); i++)
-	{
-		objects[i]->Draw();
-	}
+	cullingStats.mainPassCulled = DrawObjects(Frustum(camera->GetSpaceMatrix()));
 	//	    
 	game->screenBuffer->Render();
+	simulationClock.AddRenderTime(glfwGetTime() - renderStart);
 	glfwSwapBuffers(game->window);
-	for (auto it = shadowMaps.begin(); it != shadowMaps.end(); it++)
-	{
-		it->Delete();
-	}
+	if (pointShadowBenchmark != NULL)
+		pointShadowBenchmark->EndFrame();
 }
 
 void Map::QuickCameraSetUp(Camera* camera)
@@ -453,48 +948,226 @@ void Map::QuickCameraSetUp(Camera* camera)
 	}
 }
 
-void Map::Update(float dTime)
+void Map::Step(double dTime)
 {
-	//	  
-	for (auto it = game->shaders.begin(); it != game->shaders.end(); it++)
+	//	       
+	for (int i = 0; i < objects.size(); i++)
 	{
-		it->second->clear();
+		if (objects[i]->IsSimulated())
+			objects[i]->SaveState();
 	}
-	//	      
+	//	  ,         
+	//	      ,        
+	double trafficStart = glfwGetTime();
+	simulationLod.Update(vehicles, *player->GetPosition());
+	traffic.Prepare(vehicles);
 	ActBots(dTime);
+	traffic.AddStepTime(glfwGetTime() - trafficStart);
+	game->jobSystem->ParallelFor(vehicles.GetSlotsCount(), 1024, [this, dTime](unsigned int begin, unsigned int end)
+	{
+		vehicles.Update((float)dTime, begin, end);
+	});
+	//	     ,     
+	collisions.Update(vehicles);
 	UpdateObjects(dTime);
+	//	      ,  -   
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (objects[i]->IsSimulated() && !objects[i]->IsStatic())
+			objects[i]->UpdateGridCell();
+	}
+	//	         
+	roadStreamer.Update(player->GetPosition()->x);
+	RecycleObjects();
+}
 
-	//	  ,    
-	Camera* camera = player->GetModel()->GetCamera();
-	camera->SetFov(45 + glm::length(player->GetSpeed()));
-	camera->UpdateCameraVectors();
-	ScreenShader* screenShader = (ScreenShader*)(game->shaders.find("screen")->second);
-	screenShader->setPlayerSpeed(player->GetSpeed());
-	const glm::vec3* playerPos = player->GetPosition();
+void Map::BuildSimulationGrid()
+{
+	//	    ,    
+	simulationGrid.Clear();
+	recycledObjects.assign(objects.size(), false);
+	objectVehicles.assign(objects.size(), -1);
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (!objects[i]->IsSimulated()) continue;
+		objects[i]->BindToGrid(&simulationGrid, i);
+		recycledObjects[i] = dynamic_cast<Bot*>(objects[i]) != NULL;
+		//	      ,      
+		Car* car = dynamic_cast<Car*>(objects[i]);
+		if (car != NULL)
+			objectVehicles[i] = car->GetVehicleIndex();
+	}
+}
+
+void Map::BuildCollisionBodies()
+{
+	collisions.Clear();
+	collisions.Reserve(vehicles.GetSlotsCount());
+	for (int i = 0; i < objects.size(); i++)
+	{
+		Car* car = dynamic_cast<Car*>(objects[i]);
+		if (car != NULL)
+			car->BindToCollisions(&collisions);
+	}
+}
 
-	//	  
-	for (int i = 0; i < roadObjects.size(); i++)
+void Map::BuildTraffic()
+{
+	//	      ,     -   
+	for (int i = 0; i < objects.size(); i++)
 	{
-		const glm::vec3* objectPos = roadObjects[i]->GetPosition();
-		float dist = playerPos->x - objectPos->x;
-		if (abs(dist) > 7.0f * 30 / 2.0f)
+		Car* car = dynamic_cast<Car*>(objects[i]);
+		if (car == NULL) continue;
+		glm::vec3 halfExtents, center;
+		car->GetBodyShape(halfExtents, center);
+		if (dynamic_cast<Bot*>(car) != NULL)
 		{
-			roadObjects[i]->SetPosition(*objectPos +
-				glm::vec3(glm::sign(dist) * 30 * 7.0f, 0.0f, 0.0f));
+			DriverParams params;
+			params.desiredSpeed = 10.0f + (rand() % 61) / 10.0f;
+			traffic.AddDriver(car->GetVehicleIndex(), halfExtents.x * 2.0f, params);
+			simulationLod.AddVehicle(car->GetVehicleIndex());
 		}
+		else
+			traffic.AddObstacle(car->GetVehicleIndex(), halfExtents.x * 2.0f);
 	}
+}
 
-	//	 
-	for (int i = 0; i < bots.size(); i++)
+void Map::RecycleObjects()
+{
+	//	,     ,     .   
+	//	     ,         .
+	//	      ,    .    :
+	//	,  ,  ,   ,    ,
+	//	        
+	float windowMin, windowMax;
+	roadStreamer.GetWindow(windowMin, windowMax);
+	const float shift = roadStreamer.GetSettings().viewDistance * 2.0f;
+	AABB areas[2] = {
+		AABB(glm::vec3(-FLT_MAX), glm::vec3(windowMin, FLT_MAX, FLT_MAX)),
+		AABB(glm::vec3(windowMax, -FLT_MAX, -FLT_MAX), glm::vec3(FLT_MAX))
+	};
+	for (int area = 0; area < 2; area++)
 	{
-		CarBot* bot = ((CarBot*)bots[i]);
-		const glm::vec3* botPos = bot->GetPosition();
-		float dist = playerPos->x - botPos->x;
-		if (abs(dist) > 7.0f * 30 / 2.0f)
+		simulationGrid.QueryBox(areas[area], simulationQuery);
+		for (int j = 0; j < simulationQuery.size(); j++)
 		{
-			bot->SetPosition(*botPos + glm::vec3(glm::sign(dist) * 30 * 7.0f, 0.0f, 0.0f));
+			int i = simulationQuery[j];
+			if (!recycledObjects[i]) continue;
+			const glm::vec3* objectPos = objects[i]->GetPosition();
+			float direction;
+			if (objectPos->x < windowMin)
+				direction = 1.0f;
+			else if (objectPos->x > windowMax)
+				direction = -1.0f;
+			else continue;
+			//	         ,    ,
+			//	    
+			const float spacing = traffic.GetSpacing(objectVehicles[i]);
+			const int attemptsCount = 4;
+			for (int attempt = 0; attempt < attemptsCount; attempt++)
+			{
+				glm::vec3 target = *objectPos + glm::vec3(direction * (shift - attempt * spacing), 0.0f, 0.0f);
+				if (!IsLaneFree(i, target, spacing)) continue;
+				objects[i]->Teleport(target);
+				break;
+			}
 		}
 	}
+}
+
+bool Map::IsLaneFree(int object, const glm::vec3& position, float gap)
+{
+	//	    ,         
+	const float laneWidth = traffic.GetLaneWidth();
+	simulationGrid.QueryRange(position, gap, wrapQuery);
+	for (int j = 0; j < wrapQuery.size(); j++)
+	{
+		int i = wrapQuery[j];
+		if (i == object || objectVehicles[i] < 0) continue;
+		const glm::vec3* otherPos = objects[i]->GetPosition();
+		if (std::abs(otherPos->z - position.z) < laneWidth && std::abs(otherPos->x - position.x) < gap)
+			return false;
+	}
+	return true;
+}
+
+void Map::Simulate(double dTime)
+{
+	//	       
+	unsigned int stepsCount = simulationClock.Advance(dTime);
+	double simulationStart = glfwGetTime();
+	for (unsigned int i = 0; i < stepsCount; i++)
+	{
+		Step(simulationClock.GetStepDuration());
+	}
+	simulationClock.AddSimulationTime(glfwGetTime() - simulationStart);
+	//	    ,   
+	WriteSnapshot(snapshots[1 - frontSnapshot]);
+}
+
+void Map::WriteSnapshot(SimulationSnapshot& snapshot)
+{
+	snapshot.objects.resize(objects.size());
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (objects[i]->IsSimulated())
+			snapshot.objects[i] = objects[i]->GetState();
+	}
+	snapshot.playerSpeed = player->GetSpeed();
+	snapshot.alpha = simulationClock.GetAlpha();
+}
+
+void Map::Synchronize()
+{
+	//	  :  ,    
+	if (!simulationPending) return;
+	simulationThread->Wait();
+	frontSnapshot = 1 - frontSnapshot;
+	simulationPending = false;
+}
+
+void Map::Update(float dTime)
+{
+	//	  
+	for (auto it = game->shaders.begin(); it != game->shaders.end(); it++)
+	{
+		it->second->clear();
+	}
+	//	      ,    
+	if (threadedSimulation)
+	{
+		Synchronize();
+		if (simulationThread == NULL)
+			simulationThread = new SimulationThread();
+		simulationPending = true;
+		simulationThread->Start([this, dTime]() { Simulate(dTime); });
+	}
+	else
+	{
+		Simulate(dTime);
+		frontSnapshot = 1 - frontSnapshot;
+	}
+	//	         
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (objects[i]->IsSimulated()) continue;
+		objects[i]->Update(dTime);
+		objects[i]->Interpolate(objects[i]->GetState(), 1.0f);
+	}
+	//	      
+	const SimulationSnapshot& snapshot = snapshots[frontSnapshot];
+	for (int i = 0; i < objects.size() && i < snapshot.objects.size(); i++)
+	{
+		if (objects[i]->IsSimulated())
+			objects[i]->Interpolate(snapshot.objects[i], snapshot.alpha);
+	}
+
+	//	  ,    
+	Camera* camera = player->GetModel()->GetCamera();
+	camera->SetFov(45 + glm::length(snapshot.playerSpeed));
+	camera->UpdateCameraVectors();
+	ScreenShader* screenShader = (ScreenShader*)(game->shaders.find("screen")->second);
+	screenShader->setPlayerSpeed(snapshot.playerSpeed);
 
 	//	  
 	glm::vec3 lightPos = glm::vec3(0.0f);
@@ -502,8 +1175,18 @@ void Map::Update(float dTime)
 	glm::vec3 camPos = player->GetModel()->GetCamera()->GetPosition();
 	activeLights.clear();
 	std::list<std::pair<int, float>> lightsDistances;
+	//	   ,        
 	for (int i = 0; i < lights.size(); i++)
 	{
+		if (lights[i]->GetType() == SourceType::POINT || lights[i]->GetType() == SourceType::SPOTLIGHT)
+			lightsGrid.Update(i, ((MovingLight*)lights[i])->GetPosition());
+		else lightsGrid.Update(i, AABB());
+	}
+	//	     ,     
+	lightsGrid.QueryRange(camPos, 55.0f, renderQuery);
+	for (int j = 0; j < renderQuery.size(); j++)
+	{
+		int i = renderQuery[j];
 		switch (lights[i]->GetType())
 		{
 		case SourceType::POINT:
@@ -572,6 +1255,9 @@ void Map::Update(float dTime)
 
 void Map::Clear()
 {
+	Synchronize();
+	delete simulationThread;
+	simulationThread = NULL;
 	//	Objects clearing
 	for (int i = 0; i < objects.size(); i++)
 	{
@@ -590,4 +1276,13 @@ void Map::Clear()
 		delete lights[i];
 	}
 	lights.clear();
+	simulationGrid.Clear();
+	objectsGrid.Clear();
+	lightsGrid.Clear();
+	collisions.Clear();
+	traffic.Clear();
+	simulationLod.Clear();
+	roadStreamer.Clear();
+	delete pointShadowBenchmark;
+	pointShadowBenchmark = NULL;
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <map>
 #include <list>
 #include <string>
+#include <stdexcept>
+#include <random>
 #include <tinyxml2/tinyxml2.h>
 #include "Object.h"
 #include "LightSource.h"
@@ -17,9 +19,41 @@
 #include "Shader.h"
 #include "ParticleSystem.h"
 #include "GameGlobal.h"
+#include "Frustum.h"
+#include "InstanceBuffer.h"
+#include "RenderQueue.h"
+#include "PointShadowBenchmark.h"
+#include "FixedTimestep.h"
+#include "SimulationThread.h"
+#include "SpatialGrid.h"
+#include "CollisionSystem.h"
+#include "TrafficSystem.h"
+#include "SimulationLod.h"
+#include "RoadStreamer.h"
 
 class GameGlobal;
 
+struct CullingStats
+{
+	unsigned int objectsCount;
+	unsigned int mainPassCulled;
+	std::vector<unsigned int> shadowPassesCulled;
+	CullingStats();
+};
+
+struct SimulationSnapshot
+{
+	std::vector<ObjectState> objects;
+	glm::dvec3 playerSpeed;
+	float alpha;
+	SimulationSnapshot();
+};
+
+enum class ObjectsFilter
+{
+	ALL, STATIC, DYNAMIC
+};
+
 class Map
 {
 private:
@@ -29,23 +63,91 @@ private:
 	std::vector<Object*> roadObjects;
 	std::vector<LightSource*> lights;
 	LightsUBO lightsUbo;
+	FrameUBO frameUbo;
 	std::vector<const LightSource*> activeLights;
 	std::map<std::string, Model*> models;
 	unsigned int botsCount;
 	unsigned int treesCount;
+	unsigned int rainDropsCount;
 	Object* player = NULL;
 	Camera* camera = NULL;
 	Object* skybox = NULL;
+	std::vector<AABB> objectsBounds;
+	std::vector<InstanceData> objectsInstances;
+	std::vector<int> visibleObjects;
+	std::vector<std::pair<Model*, int>> instanceBatches;
+	std::vector<std::pair<Model*, int>> layeredBatches;
+	std::vector<InstanceData> batchInstances;
+	std::vector<int> unqueuedObjects;
+	RenderQueue renderQueue;
+	CullingStats cullingStats;
+	bool instancing = true;
+	bool shadowCaching = true;
+	PointShadowMode pointShadowMode;
+	PointShadowBenchmark* pointShadowBenchmark = NULL;
+	FixedTimestep simulationClock;
+	VehicleSimulation vehicles;
+	CollisionSystem collisions;
+	TrafficSystem traffic;
+	SimulationLod simulationLod;
+	RoadStreamer roadStreamer;
+	SimulationSnapshot snapshots[2];
+	int frontSnapshot = 0;
+	bool threadedSimulation = true;
+	bool simulationPending = false;
+	SimulationThread* simulationThread = NULL;
+	SpatialGrid simulationGrid;
+	SpatialGrid objectsGrid;
+	SpatialGrid lightsGrid;
+	std::vector<int> simulationQuery;
+	std::vector<int> renderQuery;
+	std::vector<int> wrapQuery;
+	std::vector<bool> recycledObjects;
+	std::vector<int> objectVehicles;
+	unsigned int staticObjectsCount = 0;
 	void RenderSkybox();
+	void PrepareObjectsForRender();
+	unsigned int DrawObjects(const Frustum& frustum, const Shader* shader = NULL, ObjectsFilter filter = ObjectsFilter::ALL);
+	uint64_t GetStaticCastersSignature(const Frustum& frustum);
+	unsigned int DrawObjects(const glm::vec3& center, float radius, const Shader* shader = NULL);
+	void DrawVisibleObjects(const glm::vec3& viewPos, const Shader* shader = NULL);
+	unsigned int DrawObjectsLayered(const glm::vec3& center, float radius, const std::list<glm::mat4>& faceMatrices,
+		const Shader* shader);
+	unsigned int RenderPointShadow(const PointLight* light, const Texture& shadowMap, std::list<glm::mat4>& lightSpaceMats,
+		PointShadowMode mode);
 	bool LoadGameProps();
 	void UpdateObjects(double dTime);
 	void ActBots(double dTime);
+	void Step(double dTime);
+	void Simulate(double dTime);
+	void WriteSnapshot(SimulationSnapshot& snapshot);
+	void BuildSimulationGrid();
+	void BuildCollisionBodies();
+	void BuildTraffic();
+	void RecycleObjects();
+	bool IsLaneFree(int object, const glm::vec3& position, float gap);
 public:
 	Map(const GameGlobal& gameGlob);
 	Object* GetPlayer();
 	std::vector<Object*>& GetObjects();
 	Camera* GetCamera();
 	Object* GetSkybox();
+	const CullingStats& GetCullingStats() const;
+	const RenderQueueStats& GetRenderStats() const;
+	const CollisionStats& GetCollisionStats() const;
+	TrafficSystem& GetTraffic();
+	const SimulationLod& GetSimulationLod() const;
+	const RoadStreamer& GetRoadStreamer() const;
+	bool IsInstancingEnabled() const;
+	void EnableInstancing(bool enable);
+	bool IsShadowCachingEnabled() const;
+	void EnableShadowCaching(bool enable);
+	bool IsThreadedSimulationEnabled() const;
+	void EnableThreadedSimulation(bool enable);
+	PointShadowMode GetPointShadowMode() const;
+	void SetPointShadowMode(PointShadowMode mode);
+	void StartPointShadowBenchmark(int framesPerMode);
+	FixedTimestep& GetSimulationClock();
 	void Initialize();
 	void AddObject(Object* object);
 	void AddBot(Bot* bot);
@@ -54,6 +156,7 @@ public:
 	void SetRoadObject(Object* object);
 	void SetSkybox(Object* skybox);
 	void Render();
+	void Synchronize();
 	void Update(float dTime);
 	void QuickCameraSetUp(Camera* camera);
 	void Clear();
@@ -0,0 +1,101 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	data = NULL;
+	size = 0;
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#else
+	file = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		Close();
+		return false;
+	}
+	data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	file = open(path.c_str(), O_RDONLY);
+	if (file < 0) return false;
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+	size = (size_t)fileStat.st_size;
+	void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	data = view == MAP_FAILED ? NULL : (const unsigned char*)view;
+#endif
+	if (data == NULL)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != NULL) UnmapViewOfFile(data);
+	if (mapping != NULL) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#else
+	if (data != NULL) munmap((void*)data, size);
+	if (file >= 0) close(file);
+	file = -1;
+#endif
+	data = NULL;
+	size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return data != NULL;
+}
+
+const unsigned char* MappedFile::GetData() const
+{
+	return data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
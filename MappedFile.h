@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+class MappedFile
+{
+private:
+	const unsigned char* data;
+	size_t size;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#else
+	int file;
+#endif
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+public:
+	MappedFile();
+	~MappedFile();
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen() const;
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+};
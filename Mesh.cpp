@@ -69,6 +69,47 @@ void Vertex::SetBitangent(glm::vec3 biTangent)
 	this->biTangent = biTangent;
 }
 
+//	 PackedVertex
+
+PackedVertex::PackedVertex()
+{
+	position = glm::vec3(0.0f);
+	normal = 0;
+	tangent = 0;
+	texture = 0;
+}
+
+PackedVertex::PackedVertex(Vertex& vertex)
+{
+	position = vertex.GetPosition();
+	normal = glm::packSnorm2x16(EncodeOctahedral(vertex.GetNormal()));
+	//	        .  
+	//	   snorm16,           
+	const float snormStep = 1.0f / 32767.0f;
+	glm::vec2 tangentOct = EncodeOctahedral(vertex.GetTangent());
+	glm::vec3 biTangent = glm::cross(vertex.GetNormal(), vertex.GetTangent());
+	if (glm::dot(biTangent, vertex.GetBitangent()) < 0.0f)
+		tangentOct.y = (tangentOct.y * 0.5f - 0.5f) * (1.0f - snormStep) - snormStep;
+	else tangentOct.y = tangentOct.y * 0.5f + 0.5f;
+	tangent = glm::packSnorm2x16(tangentOct);
+	texture = glm::packHalf2x16(vertex.GetTexture());
+}
+
+glm::vec2 PackedVertex::EncodeOctahedral(const glm::vec3& direction)
+{
+	float length = glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z);
+	if (length == 0.0f) return glm::vec2(0.0f);
+	glm::vec3 n = direction / length;
+	glm::vec2 result = glm::vec2(n.x, n.y);
+	//	     
+	if (n.z < 0.0f)
+	{
+		result.x = (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		result.y = (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return result;
+}
+
 //	 Material
 
 Material::Material()
@@ -184,13 +225,15 @@ void Material::AddTexture(const Texture& texture)
 
 //	 Mesh
 
-Mesh::Mesh(const Model* root, const Mesh* parent, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
-	const std::vector<Texture>* textures, const std::string& name = "mesh")
+Mesh::Mesh(const Model* root, const Mesh* parent, std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+	const std::vector<Texture>* textures, const std::string& name = "mesh", VertexFormat vertexFormat)
 {
 	this->root = root;
 	this->parent = parent;
-	this->vertices = vertices;
-	this->indices = indices;
+	//	  ,   ,      
+	this->vertices = std::move(vertices);
+	this->indices = std::move(indices);
+	this->vertexFormat = vertexFormat;
 	if (textures != NULL)
 		this->material.textures = *textures;
 	this->name = name;
@@ -199,6 +242,10 @@ Mesh::Mesh(const Model* root, const Mesh* parent, const std::vector<Vertex>& ver
 	_startRotation = rotation;
 	scale = glm::vec3(1.0f);
 	model = glm::mat4(1.0f);
+	for (int i = 0; i < this->vertices.size(); i++)
+	{
+		bounds.Expand(this->vertices[i].GetPosition());
+	}
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
@@ -206,34 +253,55 @@ Mesh::Mesh(const Model* root, const Mesh* parent, const std::vector<Vertex>& ver
 	glBindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-	glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(Vertex), &this->vertices[0], GL_STATIC_DRAW);
+	if (vertexFormat == VertexFormat::PACKED)
+	{
+		//	 :      ,    half
+		std::vector<PackedVertex> packedVertices;
+		packedVertices.reserve(this->vertices.size());
+		for (int i = 0; i < this->vertices.size(); i++)
+		{
+			packedVertices.push_back(PackedVertex(this->vertices[i]));
+		}
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedVertex), &packedVertices[0], GL_STATIC_DRAW);
+	}
+	else glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(Vertex), &this->vertices[0], GL_STATIC_DRAW);
 
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(unsigned int), &this->indices[0], GL_STATIC_DRAW);
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(8 * sizeof(float)));
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(11 * sizeof(float)));
-	glEnableVertexAttribArray(4);
+	if (vertexFormat == VertexFormat::PACKED)
+	{
+		//	  ,       
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texture));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, tangent));
+		glEnableVertexAttribArray(3);
+	}
+	else
+	{
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(8 * sizeof(float)));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(11 * sizeof(float)));
+		glEnableVertexAttribArray(4);
+	}
 	glBindVertexArray(0);
 }
 void Mesh::Draw(const Shader& shader)
 {
 	shader.use();
 	//	   
-	UpdateModelMatrix();
-	glm::mat4 modelMat = root->GetModelMatrix();
-	for (const Mesh* mesh = this; mesh != NULL; mesh = mesh->parent)
-	{
-		modelMat = modelMat * mesh->model;
-	}
+	glm::mat4 modelMat = root->GetModelMatrix() * GetHierarchyMatrix();
 	//	   
 	switch (shader.GetType())
 	{
@@ -241,9 +309,11 @@ void Mesh::Draw(const Shader& shader)
 	{
 		const MaterialShader* matShader = (const MaterialShader*)(&shader);
 		Camera* cam = root->GetCamera();
-		if (cam != NULL)
+		//	   -      
+		if (cam != NULL && !matShader->hasFrameBlock())
 			matShader->loadMainInfo(&cam->GetPosition(), &cam->GetSpaceMatrix(), &modelMat, &material);
 		else matShader->loadMainInfo(NULL, NULL, &modelMat, &material);
+		matShader->loadVertexFormat(vertexFormat == VertexFormat::PACKED);
 		matShader->draw(VAO, indices.size());
 		matShader->clearSamplers();
 	}; break;
@@ -257,6 +327,81 @@ void Mesh::Draw(const Shader& shader)
 	}
 }
 
+void Mesh::DrawInstanced(const Shader& shader, const InstanceBuffer& buffer, unsigned int instancesCount, unsigned int baseInstance)
+{
+	const Shader* instShader = shader.GetInstancedVariant();
+	if (instShader == NULL)
+	{
+		std::cout << "ERROR::SHADER:: Shader has no instanced variant: " << name << std::endl;
+		return;
+	}
+	BindInstanceBuffer(buffer);
+	instShader->use();
+	//	    ,     
+	glm::mat4 modelMat = GetHierarchyMatrix();
+	switch (instShader->GetType())
+	{
+	case ShaderType::MATERIAL:
+	{
+		const MaterialShader* matShader = (const MaterialShader*)instShader;
+		Camera* cam = root->GetCamera();
+		//	   -      
+		if (cam != NULL && !matShader->hasFrameBlock())
+			matShader->loadMainInfo(&cam->GetPosition(), &cam->GetSpaceMatrix(), &modelMat, &material);
+		else matShader->loadMainInfo(NULL, NULL, &modelMat, &material);
+		matShader->loadVertexFormat(vertexFormat == VertexFormat::PACKED);
+		matShader->drawInstanced(VAO, indices.size(), instancesCount, baseInstance);
+		matShader->clearSamplers();
+	}; break;
+	case ShaderType::SHADOW_MAP:
+	{
+		const ShadowMapShader* shdMapShader = (const ShadowMapShader*)instShader;
+		shdMapShader->loadMainInfo(NULL, &modelMat, NULL, 0.0f, &material);
+		shdMapShader->drawInstanced(VAO, indices.size(), instancesCount, baseInstance);
+	}; break;
+	default: break;
+	}
+}
+
+void Mesh::DrawIndirect(const Shader& shader, unsigned int commandBuffer)
+{
+	if (shader.GetType() != ShaderType::MATERIAL)
+		return;
+	shader.use();
+	//	      ,    
+	glm::mat4 modelMat = root->GetModelMatrix() * GetHierarchyMatrix();
+	const MaterialShader* matShader = (const MaterialShader*)(&shader);
+	Camera* cam = root->GetCamera();
+	if (cam != NULL && !matShader->hasFrameBlock())
+		matShader->loadMainInfo(&cam->GetPosition(), &cam->GetSpaceMatrix(), &modelMat, &material);
+	else matShader->loadMainInfo(NULL, NULL, &modelMat, &material);
+	matShader->loadVertexFormat(vertexFormat == VertexFormat::PACKED);
+	matShader->drawIndirect(VAO, commandBuffer);
+	matShader->clearSamplers();
+}
+
+void Mesh::BindInstanceBuffer(const InstanceBuffer& buffer)
+{
+	//	    VAO 
+	if (instanceVBO != buffer.ID())
+	{
+		buffer.SetupAttributes(VAO);
+		instanceVBO = buffer.ID();
+	}
+}
+
+glm::mat4 Mesh::GetHierarchyMatrix()
+{
+	//	      
+	UpdateModelMatrix();
+	glm::mat4 modelMat = glm::mat4(1.0f);
+	for (const Mesh* mesh = this; mesh != NULL; mesh = mesh->parent)
+	{
+		modelMat = modelMat * mesh->model;
+	}
+	return modelMat;
+}
+
 void Mesh::Draw()
 {
 	if (material.GetShader() != NULL)
@@ -299,6 +444,16 @@ const glm::mat4& Mesh::GetModelMatrix() const
 	return model;
 }
 
+const AABB& Mesh::GetBounds() const
+{
+	return bounds;
+}
+
+VertexFormat Mesh::GetVertexFormat() const
+{
+	return vertexFormat;
+}
+
 void Mesh::SetPosition(glm::vec3 position)
 {
 	this->position = position;
@@ -1,11 +1,15 @@
 #pragma once
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 #include <vector>
 #include <string>
 #include "Shader.h"
 #include "Texture.h"
 #include "Model.h"
+#include "Frustum.h"
+#include "InstanceBuffer.h"
+#include "VertexFormat.h"
 
 class Shader;
 class Model;
@@ -44,6 +48,17 @@ public:
 	void SetBitangent(glm::vec3 biTangent);
 };
 
+struct PackedVertex
+{
+	glm::vec3 position;
+	glm::uint normal;
+	glm::uint tangent;
+	glm::uint texture;
+	PackedVertex();
+	PackedVertex(Vertex& vertex);
+	static glm::vec2 EncodeOctahedral(const glm::vec3& direction);
+};
+
 class Material
 {
 private:
@@ -75,7 +90,11 @@ class Mesh
 {
 private:
 	friend class Model;
+	friend class RenderQueue;
+	friend class GpuParticles;
 	unsigned int VAO, VBO, EBO;
+	unsigned int instanceVBO = 0;
+	VertexFormat vertexFormat;
 	std::vector<Vertex> vertices;
 	std::vector<unsigned int> indices;
 	Material material;
@@ -84,19 +103,26 @@ private:
 	glm::vec3 _startRotation;
 	glm::vec3 scale;
 	glm::mat4 model;
+	AABB bounds;
 	const Mesh* parent;
 	const Model* root;
 	void Draw(const Shader& shader);
 	void Draw();
+	void DrawInstanced(const Shader& shader, const InstanceBuffer& buffer, unsigned int instancesCount, unsigned int baseInstance);
+	void DrawIndirect(const Shader& shader, unsigned int commandBuffer);
+	void BindInstanceBuffer(const InstanceBuffer& buffer);
+	glm::mat4 GetHierarchyMatrix();
 public:
 	std::string name;
-	Mesh(const Model* root, const Mesh* parent, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
-		const std::vector<Texture>* textures, const std::string& name);
+	Mesh(const Model* root, const Mesh* parent, std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+		const std::vector<Texture>* textures, const std::string& name, VertexFormat vertexFormat = VertexFormat::FULL);
 	std::vector<Vertex>& GetVertices();
 	std::vector<unsigned int>& GetIndices();
 	Shader* GetShader();
 	Material* GetMaterial();
 	const glm::mat4& GetModelMatrix() const;
+	const AABB& GetBounds() const;
+	VertexFormat GetVertexFormat() const;
 	void SetPosition(glm::vec3 position);
 	void SetRotation(glm::vec3 rotation);
 	void SetScale(glm::vec3 scale);
@@ -0,0 +1,236 @@
+#include "MeshCache.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <type_traits>
+#include "MappedFile.h"
+
+//	Layout: header (magic, version, import flags, source size and time, source path), meshes count,
+//	then every mesh as name, counts, material, texture paths, vertices and indices.
+//	Every field is padded to 4 bytes, so vertex and index arrays are aligned inside the mapping.
+static const char magic[8] = { 'G', 'N', 'F', 'S', 'M', 'E', 'S', 'H' };
+
+static_assert(std::is_trivially_copyable<Vertex>::value, "Vertex is stored in the cache as raw bytes");
+
+const char* MeshCache::cacheDirectory = "cache\\models";
+
+MeshData::MeshData()
+{
+	ambient = glm::vec4(0.0f);
+	diffuse = glm::vec4(0.0f);
+	specular = glm::vec4(0.0f);
+	shininess = 0.0f;
+	alpha = 1.0f;
+	transparent = false;
+}
+
+class CacheWriter
+{
+private:
+	std::ofstream& stream;
+public:
+	CacheWriter(std::ofstream& stream) : stream(stream) {}
+	void Write(const void* data, size_t size)
+	{
+		static const char padding[4] = { 0, 0, 0, 0 };
+		stream.write((const char*)data, size);
+		if (size % 4 != 0) stream.write(padding, 4 - size % 4);
+	}
+	template<typename T> void Write(const T& value)
+	{
+		Write(&value, sizeof(T));
+	}
+	void Write(const std::string& value)
+	{
+		Write((uint32_t)value.size());
+		Write(value.data(), value.size());
+	}
+};
+
+class CacheReader
+{
+private:
+	const unsigned char* data;
+	size_t size;
+	size_t offset;
+	bool valid;
+public:
+	CacheReader(const unsigned char* data, size_t size) : data(data), size(size), offset(0), valid(true) {}
+	bool IsValid() const
+	{
+		return valid;
+	}
+	const unsigned char* Read(size_t length)
+	{
+		size_t padded = (length + 3) / 4 * 4;
+		if (!valid || size - offset < padded)
+		{
+			valid = false;
+			return NULL;
+		}
+		const unsigned char* result = data + offset;
+		offset += padded;
+		return result;
+	}
+	template<typename T> T Read()
+	{
+		T value = T();
+		const unsigned char* bytes = Read(sizeof(T));
+		if (bytes != NULL) std::memcpy(&value, bytes, sizeof(T));
+		return value;
+	}
+	std::string ReadString()
+	{
+		uint32_t length = Read<uint32_t>();
+		const unsigned char* bytes = Read(length);
+		if (bytes == NULL) return std::string();
+		return std::string((const char*)bytes, length);
+	}
+	template<typename T> void ReadArray(std::vector<T>& values, uint32_t count)
+	{
+		const unsigned char* bytes = Read((size_t)count * sizeof(T));
+		if (bytes == NULL) return;
+		values.resize(count);
+		if (count > 0) std::memcpy(&values[0], bytes, (size_t)count * sizeof(T));
+	}
+};
+
+std::string MeshCache::GetCachePath(const std::string& sourcePath)
+{
+	//	Cache files are named by the hash of the source path, the full path is checked on load
+	uint64_t hash = 1469598103934665603ull;
+	for (int i = 0; i < sourcePath.size(); i++)
+	{
+		hash ^= (unsigned char)sourcePath[i];
+		hash *= 1099511628211ull;
+	}
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long)hash);
+	return std::string(cacheDirectory) + "\\" + name;
+}
+
+bool MeshCache::GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time)
+{
+	std::error_code error;
+	size = std::filesystem::file_size(sourcePath, error);
+	if (error) return false;
+	auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+	if (error) return false;
+	time = (int64_t)writeTime.time_since_epoch().count();
+	return true;
+}
+
+bool MeshCache::Load(const std::string& sourcePath, unsigned int importFlags, std::vector<MeshData>& meshes)
+{
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!GetSourceStamp(sourcePath, sourceSize, sourceTime)) return false;
+	MappedFile file;
+	if (!file.Open(GetCachePath(sourcePath))) return false;
+	CacheReader reader(file.GetData(), file.GetSize());
+	const unsigned char* fileMagic = reader.Read(sizeof(magic));
+	if (fileMagic == NULL || std::memcmp(fileMagic, magic, sizeof(magic)) != 0) return false;
+	//	Any change of the format, import flags or source file makes the cache stale
+	if (reader.Read<uint32_t>() != version) return false;
+	if (reader.Read<uint32_t>() != importFlags) return false;
+	if (reader.Read<uint64_t>() != sourceSize) return false;
+	if (reader.Read<int64_t>() != sourceTime) return false;
+	if (reader.ReadString() != sourcePath) return false;
+	uint32_t meshesCount = reader.Read<uint32_t>();
+	std::vector<MeshData> result(reader.IsValid() ? meshesCount : 0);
+	for (int i = 0; i < result.size() && reader.IsValid(); i++)
+	{
+		MeshData& mesh = result[i];
+		mesh.name = reader.ReadString();
+		uint32_t verticesCount = reader.Read<uint32_t>();
+		uint32_t indicesCount = reader.Read<uint32_t>();
+		uint32_t texturesCount = reader.Read<uint32_t>();
+		mesh.ambient = reader.Read<glm::vec4>();
+		mesh.diffuse = reader.Read<glm::vec4>();
+		mesh.specular = reader.Read<glm::vec4>();
+		mesh.shininess = reader.Read<float>();
+		mesh.alpha = reader.Read<float>();
+		mesh.transparent = reader.Read<uint32_t>() != 0;
+		for (uint32_t j = 0; j < texturesCount && reader.IsValid(); j++)
+		{
+			MeshTextureInfo texture;
+			texture.path = reader.ReadString();
+			texture.dataType = (TextureDataType)reader.Read<uint32_t>();
+			mesh.textures.push_back(texture);
+		}
+		reader.ReadArray(mesh.vertices, verticesCount);
+		reader.ReadArray(mesh.indices, indicesCount);
+	}
+	if (!reader.IsValid())
+	{
+		std::cout << "WARNING::MESH_CACHE:: Cache file is damaged: " << sourcePath << std::endl;
+		return false;
+	}
+	meshes.swap(result);
+	return true;
+}
+
+bool MeshCache::Save(const std::string& sourcePath, unsigned int importFlags, const std::vector<MeshData>& meshes)
+{
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (!GetSourceStamp(sourcePath, sourceSize, sourceTime)) return false;
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory, error);
+	//	The file is written aside and renamed, an interrupted write never leaves a broken cache
+	std::string path = GetCachePath(sourcePath);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			std::cout << "WARNING::MESH_CACHE:: Couldn't write cache file: " << tempPath << std::endl;
+			return false;
+		}
+		CacheWriter writer(stream);
+		writer.Write(magic, sizeof(magic));
+		writer.Write(version);
+		writer.Write((uint32_t)importFlags);
+		writer.Write(sourceSize);
+		writer.Write(sourceTime);
+		writer.Write(sourcePath);
+		writer.Write((uint32_t)meshes.size());
+		for (int i = 0; i < meshes.size(); i++)
+		{
+			const MeshData& mesh = meshes[i];
+			writer.Write(mesh.name);
+			writer.Write((uint32_t)mesh.vertices.size());
+			writer.Write((uint32_t)mesh.indices.size());
+			writer.Write((uint32_t)mesh.textures.size());
+			writer.Write(mesh.ambient);
+			writer.Write(mesh.diffuse);
+			writer.Write(mesh.specular);
+			writer.Write(mesh.shininess);
+			writer.Write(mesh.alpha);
+			writer.Write((uint32_t)mesh.transparent);
+			for (int j = 0; j < mesh.textures.size(); j++)
+			{
+				writer.Write(mesh.textures[j].path);
+				writer.Write((uint32_t)mesh.textures[j].dataType);
+			}
+			if (mesh.vertices.size() > 0)
+				writer.Write(&mesh.vertices[0], mesh.vertices.size() * sizeof(Vertex));
+			if (mesh.indices.size() > 0)
+				writer.Write(&mesh.indices[0], mesh.indices.size() * sizeof(unsigned int));
+		}
+		if (!stream.good())
+		{
+			stream.close();
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Mesh.h"
+#include "Texture.h"
+
+struct MeshTextureInfo
+{
+	std::string path;
+	TextureDataType dataType;
+};
+
+struct MeshData
+{
+	std::string name;
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<MeshTextureInfo> textures;
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+	float shininess;
+	float alpha;
+	bool transparent;
+	MeshData();
+};
+
+class MeshCache
+{
+private:
+	static const uint32_t version = 1;
+	static std::string GetCachePath(const std::string& sourcePath);
+	static bool GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time);
+public:
+	static const char* cacheDirectory;
+	static bool Load(const std::string& sourcePath, unsigned int importFlags, std::vector<MeshData>& meshes);
+	static bool Save(const std::string& sourcePath, unsigned int importFlags, const std::vector<MeshData>& meshes);
+};
@@ -1,19 +1,34 @@
 #include "Model.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+
+ModelLoadStats Model::loadStats;
+std::mutex Model::loadStatsMutex;
+
+ModelLoadStats::ModelLoadStats()
+{
+	cachedCount = 0;
+	importedCount = 0;
+	cachedTime = 0.0;
+	importedTime = 0.0;
+}
 
 Model::Model(const std::string& directory, const std::string& modelPath, Camera* camera,
-	glm::vec3 origOrientation)
+	glm::vec3 origOrientation, VertexFormat vertexFormat, bool loadNow)
 {
 	this->directory = directory;
 	this->modelPath = modelPath;
 	this->camera = camera;
 	this->origOrientation = origOrientation;
+	this->vertexFormat = vertexFormat;
 	scale = glm::vec3(1.0f);
 	scaleMult = glm::vec3(1.0f);
 	rotation = glm::vec3(1.0f, 0.0f, 0.0f);
 	position = glm::vec3(0.0f);
 	worldPos = glm::vec3(0.0f);
 	UpdateModelMatrix();
-	LoadModel();
+	//	    
+	if (loadNow) LoadModel();
 }
 
 Model::Model()
@@ -21,6 +36,7 @@ Model::Model()
 	directory = "";
 	modelPath = "";
 	origOrientation = glm::vec3(1.0f, 0.0f, 0.0f);
+	vertexFormat = VertexFormat::FULL;
 	scale = glm::vec3(1.0f);
 	scaleMult = glm::vec3(1.0f);
 	rotation = glm::vec3(1.0f, 0.0f, 0.0f);
@@ -29,6 +45,15 @@ Model::Model()
 	UpdateModelMatrix();
 }
 
+Model::~Model()
+{
+	//	  ,        
+	for (int i = 0; i < cachedTextures.size(); i++)
+	{
+		TextureCache::Release(cachedTextures[i]);
+	}
+	cachedTextures.clear();
+}
 
 void Model::Draw(const Shader& shader)
 {
@@ -56,6 +81,38 @@ void Model::Draw()
 	}
 }
 
+void Model::DrawInstanced(const Shader* shader, const InstanceBuffer& buffer, unsigned int instancesCount, unsigned int baseInstance)
+{
+	for (int i = 0; i < meshes.size(); i++)
+	{
+		const Shader* meshShader = shader;
+		if (meshShader == NULL)
+			meshShader = meshes[i].GetShader();
+		if (meshShader != NULL)
+		{
+			meshes[i].DrawInstanced(*meshShader, buffer, instancesCount, baseInstance);
+		}
+		else
+		{
+			std::cout << "ERROR::SHADER:: Shader is not set to mesh: " << meshes[i].name << std::endl;
+		}
+	}
+}
+
+bool Model::CanDrawInstanced(const Shader* shader)
+{
+	if (meshes.size() == 0) return false;
+	for (int i = 0; i < meshes.size(); i++)
+	{
+		const Shader* meshShader = shader;
+		if (meshShader == NULL)
+			meshShader = meshes[i].GetShader();
+		if (meshShader == NULL || meshShader->GetInstancedVariant() == NULL)
+			return false;
+	}
+	return true;
+}
+
 void Model::UpdateModelMatrix()
 {
 	glm::mat4 model = glm::mat4(1.0f);
@@ -75,40 +132,84 @@ void Model::UpdateModelMatrix()
 
 void Model::LoadModel()
 {
-	Assimp::Importer import;
+	std::vector<MeshData> meshesData;
+	if (!LoadMeshesData(meshesData)) return;
+	BuildMeshes(meshesData);
+}
+
+bool Model::LoadMeshesData(std::vector<MeshData>& meshesData) const
+{
+	//	   OpenGL      
 	std::string path = directory + "\\" + modelPath;
-	const aiScene* scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals
-		| aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+	double startTime = glfwGetTime();
+	//	    , Assimp       
+	bool cached = MeshCache::Load(path, importFlags, meshesData);
+	if (!cached)
+	{
+		Assimp::Importer import;
+		const aiScene* scene = import.ReadFile(path, importFlags);
+
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
+			!scene->mRootNode)
+		{
+			std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+			return false;
+		}
+		ProcessNode(scene->mRootNode, scene, meshesData);
+		import.FreeScene();
+		MeshCache::Save(path, importFlags, meshesData);
+	}
+	//	        
+	double loadTime = glfwGetTime() - startTime;
+	std::lock_guard<std::mutex> lock(loadStatsMutex);
+	if (cached)
+	{
+		loadStats.cachedCount++;
+		loadStats.cachedTime += loadTime;
+	}
+	else
+	{
+		loadStats.importedCount++;
+		loadStats.importedTime += loadTime;
+	}
+	return true;
+}
 
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
-		!scene->mRootNode)
+void Model::BuildMeshes(std::vector<MeshData>& meshesData, const std::map<std::string, ImageData>* decodedImages)
+{
+	//	      .
+	//	     ,     
+	this->decodedImages = decodedImages;
+	for (int i = 0; i < meshesData.size(); i++)
 	{
-		std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
-		return;
+		meshes.push_back(BuildMesh(meshesData[i]));
 	}
-	ProcessNode(scene->mRootNode, scene);
-	import.FreeScene();
+	this->decodedImages = NULL;
+}
+
+std::string Model::GetTexturePath(const std::string& path) const
+{
+	return directory + "\\" + path;
 }
 
-void Model::ProcessNode(aiNode* node, const aiScene* scene)
+void Model::ProcessNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshesData) const
 {
 	for (unsigned int i = 0; i < node->mNumMeshes; i++)
 	{
 		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		meshes.push_back(ProcessMesh(mesh, scene));
+		meshesData.push_back(ProcessMesh(mesh, scene));
 	}
 
 	for (unsigned int i = 0; i < node->mNumChildren; i++)
 	{
-		ProcessNode(node->mChildren[i], scene);
+		ProcessNode(node->mChildren[i], scene, meshesData);
 	}
 }
 
-Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
+MeshData Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) const
 {
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices;
-	std::vector<Texture> textures;
+	MeshData data;
+	data.name = mesh->mName.C_Str();
 
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
@@ -149,7 +250,7 @@ Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
 			vertex.SetBitangent(vertexField);
 		}
 
-		vertices.push_back(vertex);
+		data.vertices.push_back(vertex);
 	}
 
 	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
@@ -157,77 +258,90 @@ Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
 		aiFace face = mesh->mFaces[i];
 		for (unsigned int j = 0; j < face.mNumIndices; j++)
 		{
-			indices.push_back(face.mIndices[j]);
+			data.indices.push_back(face.mIndices[j]);
 		}
 	}
 
 	aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-	std::vector<Texture> diffuseMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE, TextureDataType::DIFFUSE);
-	textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-	std::vector<Texture> specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR, TextureDataType::SPECULAR);
-	textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-	std::vector<Texture> normalMaps = LoadMaterialTextures(material, aiTextureType_HEIGHT, TextureDataType::NORMAL);
-	textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-	std::vector<Texture> heightMaps = LoadMaterialTextures(material, aiTextureType_AMBIENT, TextureDataType::HEIGHT);
-	textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-	Mesh resultMesh = Mesh(this, NULL, vertices, indices, &textures, mesh->mName.C_Str());
-	Material* resMeshMat = resultMesh.GetMaterial();
-	for (auto it = diffuseMaps.begin(); it != diffuseMaps.end(); it++)
-	{
-		if (it->GetChannelsCount() >= 4) resMeshMat->SetTransparencyStatus(true);
-	}
+	CollectMaterialTextures(material, aiTextureType_DIFFUSE, TextureDataType::DIFFUSE, data.textures);
+	CollectMaterialTextures(material, aiTextureType_SPECULAR, TextureDataType::SPECULAR, data.textures);
+	CollectMaterialTextures(material, aiTextureType_HEIGHT, TextureDataType::NORMAL, data.textures);
+	CollectMaterialTextures(material, aiTextureType_AMBIENT, TextureDataType::HEIGHT, data.textures);
+
 	aiColor4D color;
 	aiGetMaterialColor(material, AI_MATKEY_COLOR_AMBIENT, &color);
-	resMeshMat->SetColor(MaterialType::AMBIENT, glm::vec4(color.r, color.g, color.b, color.a));
-	if (color.a < 1.0) resMeshMat->SetTransparencyStatus(true);
+	data.ambient = glm::vec4(color.r, color.g, color.b, color.a);
+	if (color.a < 1.0) data.transparent = true;
 	aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &color);
-	resMeshMat->SetColor(MaterialType::DIFFUSE, glm::vec4(color.r, color.g, color.b, color.a));
+	data.diffuse = glm::vec4(color.r, color.g, color.b, color.a);
 	aiGetMaterialColor(material, AI_MATKEY_COLOR_SPECULAR, &color);
-	resMeshMat->SetColor(MaterialType::SPECULAR, glm::vec4(color.r, color.g, color.b, color.a));
-	float shininess;
+	data.specular = glm::vec4(color.r, color.g, color.b, color.a);
+	float shininess = 0.0f;
 	aiGetMaterialFloatArray(material, AI_MATKEY_SHININESS, &shininess, NULL);
-	if (shininess > 0.0f)
-		resMeshMat->SetProperty(MaterialProp::SHININESS, shininess);
-	float alpha;
+	data.shininess = shininess;
+	float alpha = 1.0f;
 	aiGetMaterialFloatArray(material, AI_MATKEY_OPACITY, &alpha, NULL);
-	resMeshMat->SetProperty(MaterialProp::ALPHA, alpha);
-	if (alpha < 1.0f) resMeshMat->SetTransparencyStatus(true);
-	return resultMesh;
+	data.alpha = alpha;
+	if (alpha < 1.0f) data.transparent = true;
+	return data;
 }
 
-std::vector<Texture> Model::LoadMaterialTextures(aiMaterial* material, aiTextureType aiType, TextureDataType dataType)
+Mesh Model::BuildMesh(MeshData& data)
 {
 	std::vector<Texture> textures;
+	bool transparent = data.transparent;
+	for (int i = 0; i < data.textures.size(); i++)
+	{
+		Texture texture = LoadMaterialTexture(data.textures[i].path, data.textures[i].dataType);
+		if (texture.GetDataType() == TextureDataType::DIFFUSE && texture.GetChannelsCount() >= 4)
+			transparent = true;
+		textures.push_back(texture);
+	}
+
+	Mesh resultMesh = Mesh(this, NULL, std::move(data.vertices), std::move(data.indices), &textures, data.name, vertexFormat);
+	Material* resMeshMat = resultMesh.GetMaterial();
+	if (transparent) resMeshMat->SetTransparencyStatus(true);
+	resMeshMat->SetColor(MaterialType::AMBIENT, data.ambient);
+	resMeshMat->SetColor(MaterialType::DIFFUSE, data.diffuse);
+	resMeshMat->SetColor(MaterialType::SPECULAR, data.specular);
+	if (data.shininess > 0.0f)
+		resMeshMat->SetProperty(MaterialProp::SHININESS, data.shininess);
+	resMeshMat->SetProperty(MaterialProp::ALPHA, data.alpha);
+	//	      
+	bounds.Expand(resultMesh.GetBounds());
+	return resultMesh;
+}
 
+void Model::CollectMaterialTextures(aiMaterial* material, aiTextureType aiType, TextureDataType dataType,
+	std::vector<MeshTextureInfo>& textures) const
+{
 	for (unsigned int i = 0; i < material->GetTextureCount(aiType); i++)
 	{
 		aiString path;
 		material->GetTexture(aiType, i, &path);
-		bool loaded = false;
-		for (unsigned int j = 0; j < meshes.size(); j++)
-		{
-			const std::vector<Texture>* meshTextures = meshes[j].material.GetTextures();
-			for (int k = 0; k < meshTextures->size(); k++)
-			{
-				if (std::strcmp((*meshTextures)[k].GetPath().data(), (directory + "\\" + path.C_Str()).c_str()) == 0)
-				{
-					textures.push_back((*meshTextures)[k]);
-					loaded = true;
-					break;
-				}
-			}
-		}
-		if (!loaded)
-		{
-			bool loadSRGB = false;
-			if (dataType == TextureDataType::DIFFUSE) loadSRGB = true;
-			Texture texture = Texture::LoadTexture(std::string(directory + "\\" + path.C_Str()), loadSRGB);
-			texture.SetDataType(dataType);
-			textures.push_back(texture);
-		}
+		MeshTextureInfo texture;
+		texture.path = path.C_Str();
+		texture.dataType = dataType;
+		textures.push_back(texture);
+	}
+}
+
+Texture Model::LoadMaterialTexture(const std::string& path, TextureDataType dataType)
+{
+	std::string fullPath = GetTexturePath(path);
+	bool loadSRGB = false;
+	if (dataType == TextureDataType::DIFFUSE) loadSRGB = true;
+	const ImageData* image = NULL;
+	if (decodedImages != NULL)
+	{
+		auto decoded = decodedImages->find(fullPath);
+		if (decoded != decodedImages->end()) image = &decoded->second;
 	}
-	return textures;
+	//	    ,     ,     
+	Texture texture = TextureCache::Acquire(fullPath, loadSRGB, image);
+	if (texture.GetId() != 0) cachedTextures.push_back(texture.GetId());
+	texture.SetDataType(dataType);
+	return texture;
 }
 
 Mesh* Model::GetMesh(int index)
@@ -256,11 +370,31 @@ glm::vec3 Model::GetOrigOrientation() const
 	return origOrientation;
 }
 
+glm::vec3 Model::GetScale() const
+{
+	return scale;
+}
+
 const glm::mat4& Model::GetModelMatrix() const
 {
 	return model;
 }
 
+const ModelLoadStats& Model::GetLoadStats()
+{
+	return loadStats;
+}
+
+const AABB& Model::GetBounds() const
+{
+	return bounds;
+}
+
+VertexFormat Model::GetVertexFormat() const
+{
+	return vertexFormat;
+}
+
 Camera* Model::GetCamera() const
 {
 	return camera;
@@ -318,6 +452,7 @@ void Model::SetCamera(Camera* camera)
 
 void Model::AddMesh(Mesh mesh)
 {
+	bounds.Expand(mesh.GetBounds());
 	meshes.push_back(mesh);
 }
 
@@ -364,9 +499,10 @@ Model* Model::CreatePlane(float width, float length, const std::string& name, st
 			Texture texture;
 			if (loadTextures)
 			{
-				texture = Texture::LoadTexture(textures[0][i].GetPath());
+				texture = TextureCache::Acquire(textures[0][i].GetPath());
 				texture.SetType(textures[0][i].GetType());
 				texture.SetDataType(textures[0][i].GetDataType());
+				if (texture.GetId() != 0) plane->cachedTextures.push_back(texture.GetId());
 			}
 			else
 				texture = Texture(textures[0][i].GetId(), textures[0][i].GetDataType(), textures[0][i].GetType(), textures[0][i].GetPath());
@@ -459,9 +595,10 @@ Model* Model::CreateCube(glm::vec3 scale, const std::string& name, std::vector<T
 			Texture texture;
 			if (loadTextures)
 			{
-				texture = Texture::LoadTexture(textures[0][i].GetPath());
+				texture = TextureCache::Acquire(textures[0][i].GetPath());
 				texture.SetType(textures[0][i].GetType());
 				texture.SetDataType(textures[0][i].GetDataType());
+				if (texture.GetId() != 0) cube->cachedTextures.push_back(texture.GetId());
 			}
 			else
 				texture = Texture(textures[0][i].GetId(), textures[0][i].GetDataType(), textures[0][i].GetType(), textures[0][i].GetPath());
@@ -474,7 +611,7 @@ Model* Model::CreateCube(glm::vec3 scale, const std::string& name, std::vector<T
 	return cube;
 }
 
-Model* Model::CreateSkybox(const std::vector<std::string>& textures)
+Model* Model::CreateSkybox(const std::vector<std::string>& textures, unsigned int cubeMap)
 {
 	Model* skybox = new Model();
 	std::vector<Vertex> vertices;
@@ -541,7 +678,8 @@ Model* Model::CreateSkybox(const std::vector<std::string>& textures)
 	{
 		indices.push_back(i);
 	}
-	unsigned int id = Texture::LoadCubeMap(textures);
+	//	 ,  ,  
+	unsigned int id = cubeMap != 0 ? cubeMap : Texture::LoadCubeMap(textures);
 	modelTextures.push_back(Texture(id, TextureDataType::DIFFUSE, TextureType::CUBEMAP, textures[0].c_str()));
 	Mesh mesh = Mesh(skybox, NULL, vertices, indices, &modelTextures, "skybox");
 	skybox->AddMesh(mesh);
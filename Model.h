@@ -12,6 +12,11 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include "Frustum.h"
+#include "InstanceBuffer.h"
+#include "VertexFormat.h"
 #include "Shader.h"
 #include "Mesh.h"
 #include "Texture.h"
@@ -19,6 +24,17 @@
 
 class Mesh;
 class Shader;
+struct MeshData;
+struct MeshTextureInfo;
+
+struct ModelLoadStats
+{
+	unsigned int cachedCount;
+	unsigned int importedCount;
+	double cachedTime;
+	double importedTime;
+	ModelLoadStats();
+};
 
 class Model
 {
@@ -33,24 +49,45 @@ private:
 	glm::vec3 position;
 	glm::vec3 worldPos;
 	glm::mat4 model;
+	AABB bounds;
 	Camera* camera = NULL;
+	VertexFormat vertexFormat;
+	std::vector<unsigned int> cachedTextures;
 	Model();
 	void LoadModel();
-	void ProcessNode(aiNode* node, const aiScene* scene);
-	Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene);
-	std::vector<Texture> LoadMaterialTextures(aiMaterial* material, aiTextureType aiType, TextureDataType dataType);
+	const std::map<std::string, ImageData>* decodedImages = NULL;
+	void ProcessNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshesData) const;
+	MeshData ProcessMesh(aiMesh* mesh, const aiScene* scene) const;
+	Mesh BuildMesh(MeshData& data);
+	void CollectMaterialTextures(aiMaterial* material, aiTextureType aiType, TextureDataType dataType,
+		std::vector<MeshTextureInfo>& textures) const;
+	Texture LoadMaterialTexture(const std::string& path, TextureDataType dataType);
+	static const unsigned int importFlags = aiProcess_Triangulate | aiProcess_GenSmoothNormals
+		| aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+	static ModelLoadStats loadStats;
+	static std::mutex loadStatsMutex;
 	void AddMesh(Mesh mesh);
 public:
 	Model(const std::string& directory, const std::string& modelPath, Camera* camera,
-		glm::vec3 origOrientation = glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::vec3 origOrientation = glm::vec3(1.0f, 0.0f, 0.0f), VertexFormat vertexFormat = VertexFormat::FULL,
+		bool loadNow = true);
+	~Model();
+	bool LoadMeshesData(std::vector<MeshData>& meshesData) const;
+	void BuildMeshes(std::vector<MeshData>& meshesData, const std::map<std::string, ImageData>* decodedImages = NULL);
+	std::string GetTexturePath(const std::string& path) const;
 	void Draw(const Shader& shader);
 	void Draw();
+	void DrawInstanced(const Shader* shader, const InstanceBuffer& buffer, unsigned int instancesCount, unsigned int baseInstance);
+	bool CanDrawInstanced(const Shader* shader);
 	void UpdateModelMatrix();
 	Mesh* GetMesh(int index);
 	Mesh* GetMesh(const std::string& name);
 	std::vector<Mesh>* GetMeshes();
 	glm::vec3 GetOrigOrientation() const;
+	glm::vec3 GetScale() const;
 	const glm::mat4& GetModelMatrix() const;
+	const AABB& GetBounds() const;
+	VertexFormat GetVertexFormat() const;
 	Camera* GetCamera() const;
 	void SetOrigOrientation(glm::vec3 orientation);
 	void SetScale(glm::vec3 scale);
@@ -64,6 +101,7 @@ public:
 		std::vector<Texture>* textures = NULL, bool loadTextures = false);
 	static Model* CreateCube(glm::vec3 scale, const std::string& name,
 		std::vector<Texture>* texturesToLoad = NULL, bool loadTextures = false);
-	static Model* CreateSkybox(const std::vector<std::string>& textures);
+	static Model* CreateSkybox(const std::vector<std::string>& textures, unsigned int cubeMap = 0);
+	static const ModelLoadStats& GetLoadStats();
 };
 
@@ -11,6 +11,7 @@ Object::Object()
 	up = glm::vec3(0.0f, 1.0f, 0.0f);
 	worldUp = up;
 	_startDirection = direction;
+	ResetRenderState();
 	speed = glm::vec3(0.0f, 0.0f, 0.0f);
 	force = glm::vec3(0.0f, 0.0f, 0.0f);
 	forces = std::vector<Force>();
@@ -26,6 +27,7 @@ Object::Object(const glm::vec3& position, const glm::vec3& direction, const glm:
 	worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
 	UpdateVectors();
 	_startDirection = direction;
+	ResetRenderState();
 	speed = glm::vec3(0.0f, 0.0f, 0.0f);
 	force = glm::vec3(0.0f, 0.0f, 0.0f);
 	forces = std::vector<Force>();
@@ -41,6 +43,7 @@ Object::Object(const glm::vec3& position, const glm::vec3& direction, const glm:
 	SetWorldUp(worldUp);
 	UpdateVectors();
 	_startDirection = direction;
+	ResetRenderState();
 	speed = glm::vec3(0.0f, 0.0f, 0.0f);
 	force = glm::vec3(0.0f, 0.0f, 0.0f);
 	forces = std::vector<Force>();
@@ -104,6 +107,26 @@ glm::dvec3 Object::GetSpeedProjToDirection()
 }
 
 glm::mat4 Object::GetModelMatrix()
+{
+	return GetModelMatrix(position, direction);
+}
+
+const glm::vec3* Object::GetRenderPosition()
+{
+	return &renderPosition;
+}
+
+glm::vec3 Object::GetRenderDirection()
+{
+	return renderDirection;
+}
+
+glm::mat4 Object::GetRenderModelMatrix()
+{
+	return GetModelMatrix(renderPosition, renderDirection);
+}
+
+glm::mat4 Object::GetModelMatrix(const glm::vec3& position, const glm::vec3& direction)
 {
 	glm::mat4 model = glm::mat4(1.0f);
 	model = glm::translate(model, position);
@@ -117,16 +140,54 @@ glm::mat4 Object::GetModelMatrix()
 	}
 	else if (direction == -_startDirection)
 	{
-		glm::quat direction = glm::angleAxis(glm::radians(180.0f), up);
+		//	Also called on the render thread: the simulation rewrites up, the world up is set once at creation
+		glm::quat direction = glm::angleAxis(glm::radians(180.0f), worldUp);
 		model = model * glm::mat4_cast(direction);
 	}
 	model = glm::scale(model, scale);
 	return model;
 }
 
+AABB Object::GetWorldBounds()
+{
+	if (model == NULL) return AABB();
+	UpdateModelProps();
+	model->UpdateModelMatrix();
+	return model->GetBounds().Transform(model->GetModelMatrix());
+}
+
+bool Object::IsStatic() const
+{
+	return staticObject;
+}
+
 void Object::SetPosition(const glm::vec3& position)
 {
+	//	Explicit placement is a teleport, it is not blended with the previous step
+	this->position = position;
+	previousPosition = position;
+	renderPosition = position;
+	UpdateGridCell();
+}
+
+void Object::Teleport(const glm::vec3& position)
+{
+	//	Called from the simulation, the render transform follows on the next interpolation
 	this->position = position;
+	previousPosition = position;
+	UpdateGridCell();
+}
+
+void Object::Place(const glm::vec3& position, const glm::vec3& direction)
+{
+	//	Teleport with a new heading, e.g. of a pooled object reused elsewhere.
+	//	The render transform is left to the next interpolation as well
+	if (glm::length(direction) != 0.0f)
+		this->direction = glm::normalize(direction);
+	else this->direction = glm::vec3(1.0f, 0.0f, 0.0f);
+	previousDirection = this->direction;
+	UpdateVectors();
+	Teleport(position);
 }
 
 void Object::SetDirection(const glm::vec3& direction)
@@ -134,6 +195,8 @@ void Object::SetDirection(const glm::vec3& direction)
 	if (glm::length(direction) != 0.0f)
 		this->direction = glm::normalize(direction);
 	else this->direction = glm::vec3(1.0f, 0.0f, 0.0f);
+	previousDirection = this->direction;
+	renderDirection = this->direction;
 	UpdateVectors();
 	//_startDirection = direction;
 }
@@ -157,10 +220,32 @@ void Object::SetWorldUp(glm::vec3 up)
 	else this->direction = glm::vec3(0.0f, 1.0f, 0.0f);
 }
 
+void Object::SetStatic(bool isStatic)
+{
+	//	Static objects are only moved explicitly, e.g. when road sections are recycled
+	staticObject = isStatic;
+}
+
+void Object::BindToGrid(SpatialGrid* grid, int item)
+{
+	if (this->grid != NULL)
+		this->grid->Remove(gridItem);
+	this->grid = grid;
+	gridItem = item;
+	UpdateGridCell();
+}
+
+void Object::UpdateGridCell()
+{
+	//	The grid relinks the object only when it crosses into another cell
+	if (grid != NULL)
+		grid->Update(gridItem, position);
+}
+
 void Object::UpdateModelProps()
 {
-	model->SetWorldPosition(*GetPosition());
-	model->SetRotation(GetDirection());
+	model->SetWorldPosition(renderPosition);
+	model->SetRotation(renderDirection);
 	model->SetScaleMultiplicator(scale);
 }
 
@@ -200,7 +285,8 @@ void Object::UnbindAllLightSources()
 
 void Object::UpdateLightsPositions()
 {
-	glm::mat4 model = GetModelMatrix();
+	if (lights.empty()) return;
+	glm::mat4 model = GetRenderModelMatrix();
 	for (auto it = lights.begin(); it != lights.end(); it++)
 	{
 		auto light = it->second;
@@ -216,6 +302,41 @@ void Object::UpdateVectors()
 	up = glm::normalize(glm::cross(right, direction));
 }
 
+void Object::SaveState()
+{
+	previousPosition = position;
+	previousDirection = direction;
+}
+
+ObjectState Object::GetState()
+{
+	ObjectState state;
+	state.previousPosition = previousPosition;
+	state.previousDirection = previousDirection;
+	state.position = position;
+	state.direction = direction;
+	return state;
+}
+
+void Object::Interpolate(const ObjectState& state, float alpha)
+{
+	//	Render state lies between the last two simulation steps
+	renderPosition = glm::mix(state.previousPosition, state.position, alpha);
+	renderDirection = glm::mix(state.previousDirection, state.direction, alpha);
+	if (glm::length(renderDirection) != 0.0f)
+		renderDirection = glm::normalize(renderDirection);
+	else renderDirection = state.direction;
+	UpdateLightsPositions();
+}
+
+void Object::ResetRenderState()
+{
+	previousPosition = position;
+	previousDirection = direction;
+	renderPosition = position;
+	renderDirection = direction;
+}
+
 MovingLight* Object::GetLightSource(const std::string& name)
 {
 	return lights.find(name)->second;
@@ -236,12 +357,22 @@ void Object::Draw(const Shader* shader)
 	}
 }
 
+bool Object::IsInstanceable()
+{
+	return model != NULL;
+}
+
+bool Object::IsSimulated()
+{
+	return true;
+}
+
 void Object::ProcessInput(const std::vector<Key>& keys, Mouse& mouse, double dTime) {}
 
 void Object::Move(double dTime) {}
 
 void Object::Update(double dTime)
 {
+	//	Bound lights follow the render transform in Interpolate
 	Move(dTime);
-	UpdateLightsPositions();
 }
\ No newline at end of file
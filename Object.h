@@ -8,6 +8,16 @@
 #include "GameGlobalStructs.h"
 #include "Model.h"
 #include "Force.h"
+#include "Frustum.h"
+#include "SpatialGrid.h"
+
+struct ObjectState
+{
+	glm::vec3 previousPosition;
+	glm::vec3 previousDirection;
+	glm::vec3 position;
+	glm::vec3 direction;
+};
 
 class Object
 {
@@ -21,11 +31,20 @@ protected:
 	glm::vec3 up;
 	glm::vec3 worldUp;
 	glm::vec3 _startDirection;
+	glm::vec3 previousPosition;
+	glm::vec3 previousDirection;
+	glm::vec3 renderPosition;
+	glm::vec3 renderDirection;
 	glm::vec3 scale;
 	glm::dvec3 speed;
 	glm::vec3 force;
 	std::vector<Force> forces;
+	bool staticObject = false;
+	SpatialGrid* grid = NULL;
+	int gridItem = -1;
 	virtual void Move(double dTime);
+	glm::mat4 GetModelMatrix(const glm::vec3& position, const glm::vec3& direction);
+	void ResetRenderState();
 public:
 	Object();
 	Object(const glm::vec3& position, const glm::vec3& direction, const glm::vec3& scale);
@@ -41,19 +60,34 @@ public:
 	glm::dvec3 GetSpeed();
 	glm::dvec3 GetSpeedProjToDirection();
 	glm::mat4 GetModelMatrix();
+	const glm::vec3* GetRenderPosition();
+	glm::vec3 GetRenderDirection();
+	glm::mat4 GetRenderModelMatrix();
+	AABB GetWorldBounds();
+	bool IsStatic() const;
 	MovingLight* GetLightSource(const std::string& name);
-	void SetPosition(const glm::vec3& position);
-	void SetDirection(const glm::vec3& direction);
+	virtual void SetPosition(const glm::vec3& position);
+	virtual void Teleport(const glm::vec3& position);
+	void Place(const glm::vec3& position, const glm::vec3& direction);
+	virtual void SetDirection(const glm::vec3& direction);
 	void SetScale(const glm::vec3& scale);
 	void SetModel(Model* model);
 	void SetWorldUp(glm::vec3 up);
+	void SetStatic(bool isStatic);
+	void BindToGrid(SpatialGrid* grid, int item);
+	void UpdateGridCell();
 	void UpdateModelProps();
 	void BindLightSource(const std::string& name, MovingLight* light);
 	void UnbindLightSource(const std::string& name);
 	void UnbindAllLightSources();
 	void UpdateLightsPositions();
 	void UpdateVectors();
+	void SaveState();
+	ObjectState GetState();
+	void Interpolate(const ObjectState& state, float alpha);
 	virtual void Draw(const Shader* shader = NULL);
+	virtual bool IsInstanceable();
+	virtual bool IsSimulated();
 	virtual void ProcessInput(const std::vector<Key>& keys, Mouse& mouse, double dTime);
 	virtual void Update(double dTime);
 	virtual ~Object() = default;
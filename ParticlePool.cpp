@@ -0,0 +1,131 @@
+#include "ParticlePool.h"
+
+ParticlePool::ParticlePool(unsigned int capacity, float lifetime)
+{
+	count = 0;
+	this->capacity = 0;
+	SetLifetime(lifetime);
+	SetCapacity(capacity);
+}
+
+void ParticlePool::SetCapacity(unsigned int capacity)
+{
+	//	All storage is allocated here, spawning and dying particles never touch the heap
+	this->capacity = capacity;
+	if (count > capacity) count = capacity;
+	positionX.resize(capacity);
+	positionY.resize(capacity);
+	positionZ.resize(capacity);
+	velocityX.resize(capacity);
+	velocityY.resize(capacity);
+	velocityZ.resize(capacity);
+	age.resize(capacity);
+	modelIndex.resize(capacity);
+}
+
+bool ParticlePool::Spawn(glm::vec3 position, glm::vec3 velocity, unsigned short modelIndex)
+{
+	if (count >= capacity)
+		return false;
+	positionX[count] = position.x;
+	positionY[count] = position.y;
+	positionZ[count] = position.z;
+	velocityX[count] = velocity.x;
+	velocityY[count] = velocity.y;
+	velocityZ[count] = velocity.z;
+	age[count] = 0.0f;
+	this->modelIndex[count] = modelIndex;
+	count++;
+	return true;
+}
+
+void ParticlePool::Remove(unsigned int index)
+{
+	//	Swap with the last live particle, the order of particles is not kept
+	unsigned int last = count - 1;
+	positionX[index] = positionX[last];
+	positionY[index] = positionY[last];
+	positionZ[index] = positionZ[last];
+	velocityX[index] = velocityX[last];
+	velocityY[index] = velocityY[last];
+	velocityZ[index] = velocityZ[last];
+	age[index] = age[last];
+	modelIndex[index] = modelIndex[last];
+	count = last;
+}
+
+void ParticlePool::Update(float dTime, glm::vec3 acceleration)
+{
+	//	Integration runs over plain float arrays without branches, so the compiler can vectorize it
+	float* __restrict px = positionX.data();
+	float* __restrict py = positionY.data();
+	float* __restrict pz = positionZ.data();
+	float* __restrict vx = velocityX.data();
+	float* __restrict vy = velocityY.data();
+	float* __restrict vz = velocityZ.data();
+	float* __restrict ages = age.data();
+	const float dvx = acceleration.x * dTime;
+	const float dvy = acceleration.y * dTime;
+	const float dvz = acceleration.z * dTime;
+	const int n = count;
+	for (int i = 0; i < n; i++)
+	{
+		vx[i] += dvx;
+		vy[i] += dvy;
+		vz[i] += dvz;
+		px[i] += vx[i] * dTime;
+		py[i] += vy[i] * dTime;
+		pz[i] += vz[i] * dTime;
+		ages[i] += dTime;
+	}
+	for (unsigned int i = 0; i < count;)
+	{
+		if (age[i] >= lifetime) Remove(i);
+		else i++;
+	}
+}
+
+void ParticlePool::Clear()
+{
+	count = 0;
+}
+
+unsigned int ParticlePool::GetCount() const
+{
+	return count;
+}
+
+unsigned int ParticlePool::GetCapacity() const
+{
+	return capacity;
+}
+
+float ParticlePool::GetLifetime() const
+{
+	return lifetime;
+}
+
+void ParticlePool::SetLifetime(float lifetime)
+{
+	this->lifetime = glm::max(0.0f, lifetime);
+}
+
+glm::vec3 ParticlePool::GetPosition(unsigned int index) const
+{
+	return glm::vec3(positionX[index], positionY[index], positionZ[index]);
+}
+
+glm::vec3 ParticlePool::GetVelocity(unsigned int index) const
+{
+	return glm::vec3(velocityX[index], velocityY[index], velocityZ[index]);
+}
+
+float ParticlePool::GetAge(unsigned int index) const
+{
+	return age[index];
+}
+
+unsigned short ParticlePool::GetModelIndex(unsigned int index) const
+{
+	return modelIndex[index];
+}
@@ -0,0 +1,35 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+
+class ParticlePool
+{
+private:
+	unsigned int capacity;
+	unsigned int count;
+	float lifetime;
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> velocityZ;
+	std::vector<float> age;
+	std::vector<unsigned short> modelIndex;
+	void Remove(unsigned int index);
+public:
+	ParticlePool(unsigned int capacity = 0, float lifetime = 5.0f);
+	void SetCapacity(unsigned int capacity);
+	bool Spawn(glm::vec3 position, glm::vec3 velocity, unsigned short modelIndex = 0);
+	void Update(float dTime, glm::vec3 acceleration);
+	void Clear();
+	unsigned int GetCount() const;
+	unsigned int GetCapacity() const;
+	float GetLifetime() const;
+	void SetLifetime(float lifetime);
+	glm::vec3 GetPosition(unsigned int index) const;
+	glm::vec3 GetVelocity(unsigned int index) const;
+	float GetAge(unsigned int index) const;
+	unsigned short GetModelIndex(unsigned int index) const;
+};
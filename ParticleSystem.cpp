@@ -1,109 +1,5 @@
 #include "ParticleSystem.h"
 
-ParticleSystem::Particle::Particle(ParticleSystem* system) :
-	system(system), Object(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f))
-{
-	acceleration = glm::vec3(0.0f, 0.3f, 0.0f);
-	speed = glm::vec3(0.0f);
-	opacity = 1.0f;
-	elapsedTime = 0.0f;
-	lifetime = 1.0f;
-	alive = true;
-}
-
-ParticleSystem::Particle::Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 acceleration) :
-	system(system), Object(position, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f))
-{
-	this->acceleration = acceleration;
-	speed = glm::vec3(0.0f);
-	opacity = 1.0f;
-	elapsedTime = 0.0f;
-	lifetime = 1.0f;
-	alive = true;
-}
-
-ParticleSystem::Particle::Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 speed, glm::vec3 acceleration) :
-	system(system), Object(position, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f))
-{
-	this->acceleration = acceleration;
-	this->speed = speed;
-	opacity = 1.0f;
-	elapsedTime = 0.0f;
-	lifetime = 1.0f;
-	alive = true;
-}
-
-ParticleSystem::Particle::Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 acceleration,
-	float lifetime) : system(system), Object(position, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f))
-{
-	this->acceleration = acceleration;
-	this->speed = glm::vec3(0.0f);
-	SetOpacity(opacity);
-	elapsedTime = 0.0f;
-	SetLifetime(lifetime);
-	alive = true;
-}
-
-ParticleSystem::Particle::Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 speed, glm::vec3 acceleration,
-	float lifetime) : system(system), Object(position, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f))
-{
-	this->acceleration = acceleration;
-	this->speed = speed;
-	opacity = 1.0f;
-	elapsedTime = 0.0f;
-	SetLifetime(lifetime);
-	alive = true;
-}
-
-ParticleSystem::Particle::Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 speed, glm::vec3 acceleration,
-	float opacity, float lifetime) : system(system), Object(position, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f))
-{
-	this->acceleration = acceleration;
-	this->speed = speed;
-	SetOpacity(opacity);
-	elapsedTime = 0.0f;
-	SetLifetime(lifetime);
-	alive = true;
-}
-
-void ParticleSystem::Particle::Update(double dTime)
-{
-	elapsedTime += dTime;
-	if (elapsedTime >= lifetime)
-	{
-		alive = false;
-		return;
-	}
-	speed += acceleration * dTime;
-	position += speed * dTime;
-	return;
-}
-
-void ParticleSystem::Particle::SetSpeed(glm::vec3 speed)
-{
-	this->speed = speed;
-}
-
-void ParticleSystem::Particle::SetAcceleration(glm::vec3 acceleration)
-{
-	this->acceleration = acceleration;
-}
-
-void ParticleSystem::Particle::SetOpacity(float opacity)
-{
-	this->opacity = glm::clamp(opacity, 0.0f, 1.0f);
-}
-
-void ParticleSystem::Particle::SetLifetime(float lifetime)
-{
-	this->lifetime = glm::max(0.0f, lifetime);
-}
-
-bool ParticleSystem::Particle::IsAlive()
-{
-	return alive;
-}
-
 ParticleSystem::ParticleSystem()
 {
 	spawnInterval = 0.5f;
@@ -118,6 +14,11 @@ ParticleSystem::ParticleSystem()
 	systemOffsetOfTarget = glm::vec3(0.0f);
 	_timer = 0.0;
 	targetCamera = NULL;
+	pool = ParticlePool(maxCount, 5.0f);
+	backend = ParticleBackend::CPU;
+	gpuParticles = NULL;
+	updateShader = NULL;
+	gpuDrawShader = NULL;
 }
 
 ParticleSystem::ParticleSystem(float spawnInterval, unsigned int spawnCount, unsigned int maxCount,
@@ -134,6 +35,16 @@ ParticleSystem::ParticleSystem(float spawnInterval, unsigned int spawnCount, uns
 	particlesScale = glm::vec3(1.0f);
 	_timer = 0.0;
 	targetCamera = NULL;
+	pool = ParticlePool(maxCount, 5.0f);
+	backend = ParticleBackend::CPU;
+	gpuParticles = NULL;
+	updateShader = NULL;
+	gpuDrawShader = NULL;
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	delete gpuParticles;
 }
 
 void ParticleSystem::SetOffsetRandom(float offsetRandom)
@@ -161,6 +72,8 @@ void ParticleSystem::AddParticleModel(Model* model)
 void ParticleSystem::ResetParticleModels()
 {
 	particleModels.clear();
+	pool.Clear();
+	if (gpuParticles != NULL) gpuParticles->Clear();
 }
 
 void ParticleSystem::BindToCamera(const Camera* camera, glm::vec3 systemOffset)
@@ -174,6 +87,35 @@ void ParticleSystem::UnbindFromCamera()
 	this->targetCamera = NULL;
 }
 
+unsigned int ParticleSystem::GetParticlesCount() const
+{
+	return pool.GetCount();
+}
+
+ParticleBackend ParticleSystem::GetBackend() const
+{
+	return backend;
+}
+
+bool ParticleSystem::SetBackend(ParticleBackend backend, const ComputeShader* updateShader, const Shader* drawShader)
+{
+	if (backend == ParticleBackend::GPU && (updateShader == NULL || drawShader == NULL))
+	{
+		std::cout << "ERROR::PARTICLES:: GPU backend needs update and draw shaders, staying on CPU" << std::endl;
+		return false;
+	}
+	delete gpuParticles;
+	gpuParticles = NULL;
+	pool.Clear();
+	this->backend = backend;
+	this->updateShader = updateShader;
+	this->gpuDrawShader = drawShader;
+	//	The GPU backend keeps its particles in shader storage buffers of the same capacity
+	if (backend == ParticleBackend::GPU)
+		gpuParticles = new GpuParticles(maxCount, pool.GetLifetime());
+	return true;
+}
+
 void ParticleSystem::UpdateWithBoundCamera()
 {
 	if (targetCamera == NULL) return;
@@ -204,37 +146,44 @@ void ParticleSystem::Update(double dTime)
 	UpdateWithBoundCamera();
 	auto random = [](float randomChance)
 	{return (rand() % (int)(101 - (1.0f - randomChance) * 100) + ((1.0f - randomChance) * 100.0f)) / 100.0f; };
+	glm::vec3 gravi = glm::vec3(0.0f);
+	if (gravitation) gravi.y = -1.8f;
 	_timer += dTime;
+	if (backend == ParticleBackend::GPU)
+	{
+		GpuParticleSpawn spawn;
+		if (_timer >= spawnInterval)
+		{
+			_timer -= spawnInterval;
+			spawn.count = spawnCount;
+		}
+		spawn.emitterPosition = position;
+		spawn.offset = offset;
+		spawn.offsetRandom = offsetRandom;
+		unsigned int indicesCount = 0;
+		if (particleModels.size() > 0)
+			indicesCount = particleModels[0]->GetMesh(0)->GetIndices().size();
+		gpuParticles->Update(*updateShader, dTime, particlesAccel + gravi, spawn, indicesCount);
+		return;
+	}
 	if (_timer >= spawnInterval)
 	{
 		_timer -= spawnInterval;
-		glm::vec3 gravi = glm::vec3(0.0f);
 		for (int i = 0; i < spawnCount; i++)
 		{
 			int signX = 1 - 2 * (rand() % 2);
 			int signY = 1 - 2 * (rand() % 2);
 			int signZ = 1 - 2 * (rand() % 2);
-			if (gravitation) gravi.y = -1.8f;
-			Particle* particle = new Particle(this, position +
-				glm::vec3(offset.x * random(offsetRandom) * signX, offset.y * random(offsetRandom) * signY,
-					offset.z * random(offsetRandom) * signZ), particlesAccel + gravi, 5.0f);
-			particle->SetScale(particlesScale);
+			unsigned short modelIndex = 0;
 			if (particleModels.size() > 0)
-				particle->SetModel(particleModels[rand() % particleModels.size()]);
-			particles.push_back(particle);
+				modelIndex = rand() % particleModels.size();
+			//	A full pool drops new particles until the oldest ones expire
+			if (!pool.Spawn(position + glm::vec3(offset.x * random(offsetRandom) * signX, offset.y * random(offsetRandom) * signY,
+				offset.z * random(offsetRandom) * signZ), glm::vec3(0.0f), modelIndex))
+				break;
 		}
 	}
-	for (auto it = particles.begin(); it != particles.end(); it++)
-	{
-		if (!(*it)->IsAlive())
-			it = particles.erase(it);
-	}
-	if (particles.size() > maxCount)
-		particles.erase(particles.begin(), particles.begin() + (particles.size() - maxCount));
-	for (auto it = particles.begin(); it != particles.end(); it++)
-	{
-		(*it)->Update(dTime);
-	}
+	pool.Update(dTime, particlesAccel + gravi);
 }
 
 void ParticleSystem::Draw(const Shader* shader)
@@ -248,8 +197,36 @@ void ParticleSystem::Draw(const Shader* shader)
 	{
 		//std::cout << "WARNING:: Can't draw object without model set: " << this->id << std::endl;
 	}
-	for (auto it = particles.begin(); it != particles.end(); it++)
+	if (particleModels.empty())
+		return;
+	if (backend == ParticleBackend::GPU)
+	{
+		//	One indirect draw of the first particle model, the instance count comes from the compute pass
+		Model* particleModel = particleModels[0];
+		particleModel->SetWorldPosition(glm::vec3(0.0f));
+		particleModel->SetRotation(glm::vec3(1.0f, 0.0f, 0.0f));
+		particleModel->SetScaleMultiplicator(particlesScale);
+		particleModel->UpdateModelMatrix();
+		gpuParticles->Draw(*particleModel->GetMesh(0), *gpuDrawShader);
+		return;
+	}
+	for (unsigned int i = 0; i < pool.GetCount(); i++)
 	{
-		(*it)->Draw();
+		Model* particleModel = particleModels[pool.GetModelIndex(i)];
+		particleModel->SetWorldPosition(pool.GetPosition(i));
+		particleModel->SetRotation(glm::vec3(1.0f, 0.0f, 0.0f));
+		particleModel->SetScaleMultiplicator(particlesScale);
+		particleModel->Draw();
 	}
+}
+
+bool ParticleSystem::IsInstanceable()
+{
+	return false;
+}
+
+bool ParticleSystem::IsSimulated()
+{
+	//	Follows the camera and may dispatch compute work, so it is updated once per frame on the render thread
+	return false;
 }
\ No newline at end of file
@@ -4,34 +4,22 @@
 #include <vector>
 #include "Object.h"
 #include "Camera.h"
+#include "ParticlePool.h"
+#include "GpuParticles.h"
+
+enum class ParticleBackend
+{
+	CPU, GPU
+};
 
 class ParticleSystem : public Object
 {
 private:
-	class Particle : public Object
-	{
-	private:
-		glm::dvec3 acceleration;
-		float opacity;
-		float lifetime;
-		double elapsedTime;
-		bool alive;
-		ParticleSystem* const system;
-	public:
-		Particle(ParticleSystem* system);
-		Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 acceleration);
-		Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 acceleration, float lifetime);
-		Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 speed, glm::vec3 acceleration);
-		Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 speed, glm::vec3 acceleration, float lifetime);
-		Particle(ParticleSystem* system, glm::vec3 position, glm::vec3 speed, glm::vec3 acceleration, float opacity, float lifetime);
-		void Update(double dTime);
-		void SetSpeed(glm::vec3 speed);
-		void SetAcceleration(glm::vec3 acceleration);
-		void SetOpacity(float opacity);
-		void SetLifetime(float lifetime);
-		bool IsAlive();
-	};
-	std::vector<Particle*> particles;
+	ParticlePool pool;
+	ParticleBackend backend;
+	GpuParticles* gpuParticles;
+	const ComputeShader* updateShader;
+	const Shader* gpuDrawShader;
 	std::vector<Model*> particleModels;
 	bool externalFactors;
 	bool gravitation;
@@ -48,6 +36,7 @@ private:
 	void UpdateWithBoundCamera();
 public:
 	ParticleSystem();
+	~ParticleSystem();
 	ParticleSystem(float spawnInterval = 0.2f, unsigned int spawnCount = 5, unsigned int maxCount = 100,
 		float gravitation = true, float externalFactors = false, glm::vec3 offset = glm::vec3(0.0f), float offsetRandom = 0.0f);
 	void SetOffsetRandom(float offsetRandom);
@@ -57,7 +46,12 @@ public:
 	void ResetParticleModels();
 	void BindToCamera(const Camera* camera, glm::vec3 systemOffset = glm::vec3(0.0f));
 	void UnbindFromCamera();
+	unsigned int GetParticlesCount() const;
+	ParticleBackend GetBackend() const;
+	bool SetBackend(ParticleBackend backend, const ComputeShader* updateShader = NULL, const Shader* drawShader = NULL);
 	virtual void Update(double dTime) override;
 	virtual void Draw(const Shader* shader = NULL) override;
+	virtual bool IsInstanceable() override;
+	virtual bool IsSimulated() override;
 };
 
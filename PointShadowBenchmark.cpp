@@ -0,0 +1,127 @@
+#include "PointShadowBenchmark.h"
+#include <iostream>
+
+PointShadowBenchmark::PointShadowBenchmark()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		glGenQueries(maxPassesCount, frames[i].queries);
+		frames[i].passesCount = 0;
+		frames[i].mode = PointShadowMode::GEOMETRY;
+	}
+	currentFrame = 0;
+	modeIndex = 0;
+	framesPerMode = 0;
+	modeFrame = 0;
+	running = false;
+	for (int i = 0; i < modesCount; i++)
+	{
+		totalTime[i] = 0.0;
+		passesMeasured[i] = 0;
+		framesMeasured[i] = 0;
+	}
+}
+
+PointShadowBenchmark::~PointShadowBenchmark()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		glDeleteQueries(maxPassesCount, frames[i].queries);
+	}
+}
+
+void PointShadowBenchmark::Start(const std::vector<PointShadowMode>& modes, int framesPerMode)
+{
+	if (modes.size() == 0) return;
+	this->modes = modes;
+	this->framesPerMode = glm::max(1, framesPerMode);
+	modeIndex = 0;
+	modeFrame = 0;
+	running = true;
+	for (int i = 0; i < modesCount; i++)
+	{
+		totalTime[i] = 0.0;
+		passesMeasured[i] = 0;
+		framesMeasured[i] = 0;
+	}
+	frames[0].passesCount = 0;
+	frames[1].passesCount = 0;
+}
+
+bool PointShadowBenchmark::IsRunning() const
+{
+	return running;
+}
+
+PointShadowMode PointShadowBenchmark::GetMode() const
+{
+	return modes[modeIndex];
+}
+
+void PointShadowBenchmark::BeginPass()
+{
+	FrameQueries& frame = frames[currentFrame];
+	if (!running || frame.passesCount >= maxPassesCount) return;
+	glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.passesCount]);
+}
+
+void PointShadowBenchmark::EndPass()
+{
+	FrameQueries& frame = frames[currentFrame];
+	if (!running || frame.passesCount >= maxPassesCount) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	frame.passesCount++;
+}
+
+void PointShadowBenchmark::ResolveFrame(FrameQueries& frame)
+{
+	if (frame.passesCount == 0) return;
+	int mode = (int)frame.mode;
+	for (int i = 0; i < frame.passesCount; i++)
+	{
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+		totalTime[mode] += elapsed / 1000000.0;
+	}
+	passesMeasured[mode] += frame.passesCount;
+	framesMeasured[mode]++;
+	frame.passesCount = 0;
+}
+
+void PointShadowBenchmark::EndFrame()
+{
+	if (!running) return;
+	frames[currentFrame].mode = GetMode();
+	//	Results are read a frame late so the CPU doesn't wait for the GPU
+	currentFrame = 1 - currentFrame;
+	ResolveFrame(frames[currentFrame]);
+	if (++modeFrame < framesPerMode) return;
+	modeFrame = 0;
+	if (++modeIndex < modes.size()) return;
+	ResolveFrame(frames[1 - currentFrame]);
+	modeIndex = 0;
+	running = false;
+	PrintReport();
+}
+
+void PointShadowBenchmark::PrintReport() const
+{
+	std::cout << "Point shadows benchmark, GPU time per frame:" << std::endl;
+	for (int i = 0; i < modesCount; i++)
+	{
+		if (framesMeasured[i] == 0) continue;
+		std::cout << "\t" << GetModeName((PointShadowMode)i) << ": " << totalTime[i] / framesMeasured[i] << " ms, "
+			<< totalTime[i] / glm::max(1u, passesMeasured[i]) << " ms per light (" << framesMeasured[i] << " frames)" << std::endl;
+	}
+}
+
+std::string PointShadowBenchmark::GetModeName(PointShadowMode mode)
+{
+	switch (mode)
+	{
+	case PointShadowMode::GEOMETRY: return "geometry shader";
+	case PointShadowMode::LAYERED: return "layered instancing";
+	case PointShadowMode::MULTIPASS: return "six passes";
+	}
+	return "unknown";
+}
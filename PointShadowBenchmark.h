@@ -0,0 +1,47 @@
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+
+enum class PointShadowMode
+{
+	GEOMETRY, LAYERED, MULTIPASS
+};
+
+class PointShadowBenchmark
+{
+private:
+	static const int maxPassesCount = 8;
+	static const int modesCount = 3;
+	struct FrameQueries
+	{
+		unsigned int queries[maxPassesCount];
+		int passesCount;
+		PointShadowMode mode;
+	};
+	FrameQueries frames[2];
+	int currentFrame;
+	std::vector<PointShadowMode> modes;
+	int modeIndex;
+	int framesPerMode;
+	int modeFrame;
+	bool running;
+	double totalTime[modesCount];
+	unsigned int passesMeasured[modesCount];
+	unsigned int framesMeasured[modesCount];
+	void ResolveFrame(FrameQueries& frame);
+public:
+	PointShadowBenchmark();
+	~PointShadowBenchmark();
+	void Start(const std::vector<PointShadowMode>& modes, int framesPerMode);
+	bool IsRunning() const;
+	PointShadowMode GetMode() const;
+	void BeginPass();
+	void EndPass();
+	void EndFrame();
+	void PrintReport() const;
+	static std::string GetModeName(PointShadowMode mode);
+};
@@ -0,0 +1,181 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+//	Key layout, most significant bits first:
+//	opaque:      [63] 0 | [62..48] program | [47..24] texture set | [23..0] depth, front to back
+//	transparent: [63] 1 | [62..39] inverted depth, back to front | [38..24] program | [23..0] texture set
+static const uint64_t transparentBit = 1ull << 63;
+static const uint64_t programMask = 0x7FFFull;
+static const uint64_t textureSetMask = 0xFFFFFFull;
+static const uint64_t depthMask = 0xFFFFFFull;
+
+RenderQueueStats::RenderQueueStats()
+{
+	packetsCount = 0;
+	transparentCount = 0;
+	programChanges = 0;
+	textureBinds = 0;
+	skippedTextureBinds = 0;
+}
+
+RenderQueue::RenderQueue(float maxDepth)
+{
+	this->maxDepth = glm::max(maxDepth, 1.0f);
+	viewPos = glm::vec3(0.0f);
+}
+
+void RenderQueue::Clear()
+{
+	opaquePackets.clear();
+	transparentPackets.clear();
+	stats = RenderQueueStats();
+}
+
+void RenderQueue::SetViewPosition(const glm::vec3& viewPos)
+{
+	this->viewPos = viewPos;
+}
+
+uint64_t RenderQueue::MakeKey(const Shader* shader, const Material* material, float depth, bool transparent) const
+{
+	uint64_t program = shader->ID() & programMask;
+	//	Meshes own their materials, so materials are grouped by the textures they bind
+	uint64_t textureSet = 0;
+	const std::vector<Texture>* textures = material->GetTextures();
+	if (textures != NULL)
+	{
+		for (int i = 0; i < textures->size(); i++)
+		{
+			textureSet = textureSet * 31 + (*textures)[i].GetId();
+		}
+	}
+	textureSet &= textureSetMask;
+	uint64_t quantDepth = (uint64_t)(glm::clamp(depth / maxDepth, 0.0f, 1.0f) * depthMask);
+	if (transparent)
+		return transparentBit | ((depthMask - quantDepth) << 39) | (program << 24) | textureSet;
+	return (program << 48) | (textureSet << 24) | quantDepth;
+}
+
+void RenderQueue::Submit(Mesh* mesh, const Shader* shader, const glm::mat4& modelMatrix, float depth,
+	const InstanceBuffer* buffer, unsigned int instancesCount, unsigned int baseInstance)
+{
+	DrawPacket packet;
+	bool transparent = mesh->GetMaterial()->HasTransparency();
+	packet.key = MakeKey(shader, mesh->GetMaterial(), depth, transparent);
+	packet.mesh = mesh;
+	packet.shader = shader;
+	packet.modelMatrix = modelMatrix;
+	packet.instanceBuffer = buffer;
+	packet.instancesCount = instancesCount;
+	packet.baseInstance = baseInstance;
+	if (transparent)
+		transparentPackets.push_back(packet);
+	else opaquePackets.push_back(packet);
+}
+
+void RenderQueue::SubmitModel(Model* model, const Shader* shader, const glm::mat4& modelMatrix, const glm::vec3& center)
+{
+	float depth = glm::distance(viewPos, center);
+	std::vector<Mesh>* meshes = model->GetMeshes();
+	for (int i = 0; i < meshes->size(); i++)
+	{
+		Mesh* mesh = &(*meshes)[i];
+		const Shader* meshShader = shader;
+		if (meshShader == NULL)
+			meshShader = mesh->GetShader();
+		if (meshShader == NULL)
+		{
+			std::cout << "ERROR::SHADER:: Shader is not set to mesh: " << mesh->name << std::endl;
+			continue;
+		}
+		Submit(mesh, meshShader, modelMatrix * mesh->GetHierarchyMatrix(), depth, NULL, 1, 0);
+	}
+}
+
+void RenderQueue::SubmitModelInstanced(Model* model, const Shader* shader, const InstanceBuffer& buffer,
+	unsigned int instancesCount, unsigned int baseInstance, const glm::vec3& center)
+{
+	float depth = glm::distance(viewPos, center);
+	std::vector<Mesh>* meshes = model->GetMeshes();
+	for (int i = 0; i < meshes->size(); i++)
+	{
+		Mesh* mesh = &(*meshes)[i];
+		const Shader* meshShader = shader;
+		if (meshShader == NULL)
+			meshShader = mesh->GetShader();
+		if (meshShader == NULL || meshShader->GetInstancedVariant() == NULL)
+		{
+			std::cout << "ERROR::SHADER:: Shader has no instanced variant: " << mesh->name << std::endl;
+			continue;
+		}
+		//	Instance matrices come from the buffer, the packet only keeps the mesh local matrix
+		Submit(mesh, meshShader->GetInstancedVariant(), mesh->GetHierarchyMatrix(), depth,
+			&buffer, instancesCount, baseInstance);
+	}
+}
+
+void RenderQueue::ExecutePackets(const std::vector<DrawPacket>& packets)
+{
+	const Material* lastMaterial = NULL;
+	for (int i = 0; i < packets.size(); i++)
+	{
+		const DrawPacket& packet = packets[i];
+		Mesh* mesh = packet.mesh;
+		const Shader* shader = packet.shader;
+		if (state.UseProgram(shader->ID()))
+		{
+			//	Material uniforms belong to the program, a new program needs them again
+			lastMaterial = NULL;
+			if (shader->GetType() == ShaderType::SHADOW_MAP)
+				((const ShadowMapShader*)shader)->loadLightPosAndFarPlane();
+		}
+		if (packet.instanceBuffer != NULL)
+			mesh->BindInstanceBuffer(*packet.instanceBuffer);
+		switch (shader->GetType())
+		{
+		case ShaderType::MATERIAL:
+		{
+			const MaterialShader* matShader = (const MaterialShader*)shader;
+			matShader->loadMatrices(NULL, NULL, &packet.modelMatrix);
+			matShader->loadVertexFormat(mesh->GetVertexFormat() == VertexFormat::PACKED);
+			if (lastMaterial != &mesh->material)
+				matShader->loadMaterial(&mesh->material, &state);
+		}; break;
+		case ShaderType::SHADOW_MAP:
+		{
+			const ShadowMapShader* shdMapShader = (const ShadowMapShader*)shader;
+			shdMapShader->loadMatrices(NULL, &packet.modelMatrix);
+			if (lastMaterial != &mesh->material)
+				shdMapShader->loadMaterial(&mesh->material, &state);
+		}; break;
+		default: break;
+		}
+		lastMaterial = &mesh->material;
+		if (packet.instanceBuffer != NULL)
+			shader->drawInstanced(mesh->VAO, mesh->indices.size(), packet.instancesCount, packet.baseInstance);
+		else shader->draw(mesh->VAO, mesh->indices.size());
+	}
+}
+
+void RenderQueue::Execute()
+{
+	auto cmp = [](const DrawPacket& a, const DrawPacket& b)
+	{
+		return a.key < b.key;
+	};
+	std::sort(opaquePackets.begin(), opaquePackets.end(), cmp);
+	std::sort(transparentPackets.begin(), transparentPackets.end(), cmp);
+	state.Reset();
+	ExecutePackets(opaquePackets);
+	ExecutePackets(transparentPackets);
+	stats.packetsCount = opaquePackets.size() + transparentPackets.size();
+	stats.transparentCount = transparentPackets.size();
+	stats.programChanges = state.GetProgramChangesCount();
+	stats.textureBinds = state.GetTextureBindsCount();
+	stats.skippedTextureBinds = state.GetSkippedTextureBindsCount();
+}
+
+const RenderQueueStats& RenderQueue::GetStats() const
+{
+	return stats;
+}
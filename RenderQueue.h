@@ -0,0 +1,56 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "Model.h"
+#include "Shader.h"
+#include "Mesh.h"
+#include "InstanceBuffer.h"
+
+struct DrawPacket
+{
+	uint64_t key;
+	Mesh* mesh;
+	const Shader* shader;
+	glm::mat4 modelMatrix;
+	const InstanceBuffer* instanceBuffer;
+	unsigned int instancesCount;
+	unsigned int baseInstance;
+};
+
+struct RenderQueueStats
+{
+	unsigned int packetsCount;
+	unsigned int transparentCount;
+	unsigned int programChanges;
+	unsigned int textureBinds;
+	unsigned int skippedTextureBinds;
+	RenderQueueStats();
+};
+
+class RenderQueue
+{
+private:
+	std::vector<DrawPacket> opaquePackets;
+	std::vector<DrawPacket> transparentPackets;
+	RenderStateCache state;
+	RenderQueueStats stats;
+	glm::vec3 viewPos;
+	float maxDepth;
+	uint64_t MakeKey(const Shader* shader, const Material* material, float depth, bool transparent) const;
+	void Submit(Mesh* mesh, const Shader* shader, const glm::mat4& modelMatrix, float depth,
+		const InstanceBuffer* buffer, unsigned int instancesCount, unsigned int baseInstance);
+	void ExecutePackets(const std::vector<DrawPacket>& packets);
+public:
+	RenderQueue(float maxDepth = 1000.0f);
+	void Clear();
+	void SetViewPosition(const glm::vec3& viewPos);
+	void SubmitModel(Model* model, const Shader* shader, const glm::mat4& modelMatrix, const glm::vec3& center);
+	void SubmitModelInstanced(Model* model, const Shader* shader, const InstanceBuffer& buffer,
+		unsigned int instancesCount, unsigned int baseInstance, const glm::vec3& center);
+	void Execute();
+	const RenderQueueStats& GetStats() const;
+};
@@ -0,0 +1,323 @@
+#include "RoadStreamer.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+//	SplitMix64 gives the same sequence with every compiler and standard library,
+//	unlike the std distributions, so a seed always produces the same road
+static uint64_t NextRandom(uint64_t& state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static float RandomFloat(uint64_t& state, float min, float max)
+{
+	return min + (max - min) * (float)(NextRandom(state) >> 40) / 16777216.0f;
+}
+
+RoadStreamerSettings::RoadStreamerSettings()
+{
+	//	Zero lets the map pick a random seed, a fixed one comes only from the props file
+	seed = 0;
+	sectionLength = 7.0f;
+	sectionsPerChunk = 6;
+	lightsPerChunk = 3;
+	treesPerChunk = 20;
+	viewDistance = 105.0f;
+	prefetchChunks = 1;
+}
+
+RoadStreamerStats::RoadStreamerStats()
+{
+	activeChunksCount = 0;
+	chunksActivated = 0;
+	chunksRetired = 0;
+	chunksPrefetched = 0;
+	chunksGeneratedInline = 0;
+}
+
+RoadStreamer::RoadStreamer() : chunksPrefetched(0), pool(1)
+{
+	firstChunk = 0;
+	lastChunk = -1;
+}
+
+const RoadStreamerSettings& RoadStreamer::GetSettings() const
+{
+	return settings;
+}
+
+void RoadStreamer::SetSettings(const RoadStreamerSettings& settings)
+{
+	//	Chunks already generated keep their layout, so the settings are changed before streaming starts
+	this->settings = settings;
+	this->settings.sectionsPerChunk = glm::max(settings.sectionsPerChunk, 1u);
+	this->settings.viewDistance = glm::max(settings.viewDistance, 0.0f);
+	this->settings.prefetchChunks = glm::max(settings.prefetchChunks, 0);
+}
+
+float RoadStreamer::GetChunkLength() const
+{
+	return settings.sectionLength * settings.sectionsPerChunk;
+}
+
+int RoadStreamer::GetChunkIndex(float x) const
+{
+	//	Sections are centred on multiples of their length, a chunk starts at the edge of its first section
+	return (int)std::floor((x + settings.sectionLength / 2.0f) / GetChunkLength());
+}
+
+unsigned int RoadStreamer::GetMaxActiveChunks() const
+{
+	//	The road around the focus overlaps one chunk more than it fills, unless it ends exactly on chunk edges
+	return (unsigned int)std::ceil(settings.viewDistance * 2.0f / GetChunkLength()) + 1;
+}
+
+unsigned int RoadStreamer::GetPoolSize(RoadObjectKind kind) const
+{
+	//	Every chunk holds the same number of objects of each kind, so the pools cover the largest window exactly
+	unsigned int chunks = GetMaxActiveChunks();
+	unsigned int sections = settings.sectionsPerChunk;
+	switch (kind)
+	{
+	case RoadObjectKind::ROAD:
+		return chunks * sections;
+	case RoadObjectKind::TERRAIN_1:
+	case RoadObjectKind::TERRAIN_2:
+	case RoadObjectKind::TERRAIN_3:
+	{
+		unsigned int variant = (int)kind - (int)RoadObjectKind::TERRAIN_1;
+		return chunks * (sections / 3 + (variant < sections % 3 ? 1 : 0));
+	}
+	case RoadObjectKind::STREET_LIGHT_LEFT:
+	case RoadObjectKind::STREET_LIGHT_RIGHT:
+		return chunks * settings.lightsPerChunk;
+	case RoadObjectKind::TREE_1:
+		return chunks * ((settings.treesPerChunk + 1) / 2);
+	case RoadObjectKind::TREE_2:
+		return chunks * (settings.treesPerChunk / 2);
+	}
+	return 0;
+}
+
+void RoadStreamer::AddPoolObject(RoadObjectKind kind, Object* object)
+{
+	pools[(int)kind].push_back(object);
+}
+
+RoadChunk RoadStreamer::Generate(int index) const
+{
+	//	Depends only on the seed and the index: a chunk left behind and reached again looks the same.
+	//	Called on the streaming thread, reads nothing but the settings
+	RoadChunk chunk;
+	chunk.index = index;
+	uint64_t state = settings.seed ^ ((uint64_t)(int64_t)index * 0xD1B54A32D192ED03ull);
+	float length = settings.sectionLength;
+	float start = index * GetChunkLength();
+	//	Road and terrain. Terrain variants are a shuffle of an even mix, so every chunk takes as many of each from the pools
+	std::vector<int> terrain(settings.sectionsPerChunk);
+	for (int i = 0; i < terrain.size(); i++)
+	{
+		terrain[i] = i % 3;
+	}
+	for (int i = terrain.size() - 1; i > 0; i--)
+	{
+		std::swap(terrain[i], terrain[NextRandom(state) % (i + 1)]);
+	}
+	for (int i = 0; i < terrain.size(); i++)
+	{
+		float x = start + i * length;
+		chunk.placements.push_back({ RoadObjectKind::ROAD, glm::vec3(x, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) });
+		chunk.placements.push_back({ (RoadObjectKind)((int)RoadObjectKind::TERRAIN_1 + terrain[i]),
+			glm::vec3(x, -0.01f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) });
+	}
+	//	Street lights in pairs facing the road at even spacing
+	float lightsSpacing = GetChunkLength() / glm::max(settings.lightsPerChunk, 1u);
+	for (int i = 0; i < settings.lightsPerChunk; i++)
+	{
+		float x = start + i * lightsSpacing;
+		chunk.placements.push_back({ RoadObjectKind::STREET_LIGHT_LEFT, glm::vec3(x, -0.1f, -3.7f), glm::vec3(1.0f, 0.0f, 0.0f) });
+		chunk.placements.push_back({ RoadObjectKind::STREET_LIGHT_RIGHT, glm::vec3(x, -0.1f, 3.7f), glm::vec3(-1.0f, 0.0f, 0.0f) });
+	}
+	//	Trees on both sides of the road, the kinds alternate like the sides
+	for (int i = 0; i < settings.treesPerChunk; i++)
+	{
+		float side = i % 2 == 0 ? 1.0f : -1.0f;
+		float x = start - length / 2.0f + RandomFloat(state, 0.0f, GetChunkLength());
+		float z = side * RandomFloat(state, 4.0f, 64.0f);
+		glm::vec3 direction = glm::vec3(RandomFloat(state, 0.0f, 1.0f), 0.0f, RandomFloat(state, 0.0f, 1.0f));
+		chunk.placements.push_back({ i % 2 == 0 ? RoadObjectKind::TREE_1 : RoadObjectKind::TREE_2, glm::vec3(x, 0.0f, z), direction });
+	}
+	return chunk;
+}
+
+bool RoadStreamer::IsActive(int index) const
+{
+	for (int i = 0; i < activeChunks.size(); i++)
+	{
+		if (activeChunks[i].chunk.index == index)
+			return true;
+	}
+	return false;
+}
+
+void RoadStreamer::Request(int index)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (readyChunks.count(index) > 0 || !requestedChunks.insert(index).second) return;
+	}
+	pool.Submit([this, index]()
+	{
+		RoadChunk chunk = Generate(index);
+		std::lock_guard<std::mutex> lock(mutex);
+		readyChunks[index] = std::move(chunk);
+		chunksPrefetched++;
+	});
+}
+
+bool RoadStreamer::TakeReady(int index, RoadChunk& chunk)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = readyChunks.find(index);
+	if (it == readyChunks.end()) return false;
+	chunk = std::move(it->second);
+	readyChunks.erase(it);
+	requestedChunks.erase(index);
+	return true;
+}
+
+void RoadStreamer::Activate(RoadChunk& chunk)
+{
+	ActiveChunk active;
+	active.chunk = std::move(chunk);
+	const std::vector<RoadPlacement>& placements = active.chunk.placements;
+	active.objects.reserve(placements.size());
+	for (int i = 0; i < placements.size(); i++)
+	{
+		const RoadPlacement& placement = placements[i];
+		std::vector<Object*>& objects = pools[(int)placement.kind];
+		if (objects.empty())
+		{
+			std::cout << "ERROR::ROAD_STREAMER::Pool of object kind " << (int)placement.kind << " is empty" << std::endl;
+			active.objects.push_back(NULL);
+			continue;
+		}
+		Object* object = objects.back();
+		objects.pop_back();
+		object->Place(placement.position, placement.direction);
+		active.objects.push_back(object);
+	}
+	activeChunks.push_back(std::move(active));
+	stats.chunksActivated++;
+}
+
+void RoadStreamer::Retire(ActiveChunk& chunk)
+{
+	for (int i = 0; i < chunk.objects.size(); i++)
+	{
+		if (chunk.objects[i] != NULL)
+			pools[(int)chunk.chunk.placements[i].kind].push_back(chunk.objects[i]);
+	}
+	chunk.objects.clear();
+	//	The layout is kept in case the player turns back, it is dropped with the others once out of range
+	std::lock_guard<std::mutex> lock(mutex);
+	readyChunks[chunk.chunk.index] = std::move(chunk.chunk);
+	stats.chunksRetired++;
+}
+
+void RoadStreamer::Update(float focusX)
+{
+	//	Called on the simulation thread. Every chunk overlapping the view distance on either side is active.
+	//	Chunks behind the window give their objects back first, so the chunks entering it always find them in the pools
+	firstChunk = GetChunkIndex(focusX - settings.viewDistance);
+	lastChunk = GetChunkIndex(focusX + settings.viewDistance);
+	for (int i = activeChunks.size() - 1; i >= 0; i--)
+	{
+		int index = activeChunks[i].chunk.index;
+		if (index >= firstChunk && index <= lastChunk) continue;
+		Retire(activeChunks[i]);
+		if (i + 1 < activeChunks.size())
+			activeChunks[i] = std::move(activeChunks.back());
+		activeChunks.pop_back();
+	}
+	for (int index = firstChunk; index <= lastChunk; index++)
+	{
+		if (IsActive(index)) continue;
+		RoadChunk chunk;
+		if (!TakeReady(index, chunk))
+		{
+			//	The streaming thread has not finished it yet, e.g. on the first update or after a teleport
+			chunk = Generate(index);
+			stats.chunksGeneratedInline++;
+		}
+		Activate(chunk);
+	}
+	//	Chunks a little further than the window are generated in the background, ahead of the player.
+	//	Requested after the window is filled, so the chunks just generated here are not queued again
+	int firstPrefetched = firstChunk - settings.prefetchChunks;
+	int lastPrefetched = lastChunk + settings.prefetchChunks;
+	for (int index = firstPrefetched; index <= lastPrefetched; index++)
+	{
+		if (index < firstChunk || index > lastChunk)
+			Request(index);
+	}
+	//	Layouts left outside the prefetch range are dropped, they are cheap to generate again
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto it = readyChunks.begin(); it != readyChunks.end();)
+		{
+			if (it->first < firstPrefetched || it->first > lastPrefetched)
+			{
+				requestedChunks.erase(it->first);
+				it = readyChunks.erase(it);
+			}
+			else it++;
+		}
+	}
+	stats.activeChunksCount = activeChunks.size();
+}
+
+void RoadStreamer::GetWindow(float& minX, float& maxX) const
+{
+	//	Edges of the active chunks, the road always reaches at least the view distance from the focus
+	minX = firstChunk * GetChunkLength() - settings.sectionLength / 2.0f;
+	maxX = (lastChunk + 1) * GetChunkLength() - settings.sectionLength / 2.0f;
+}
+
+void RoadStreamer::Clear()
+{
+	//	The objects belong to the map, only the references are dropped
+	for (int i = 0; i < roadObjectKindsCount; i++)
+	{
+		pools[i].clear();
+	}
+	activeChunks.clear();
+	firstChunk = 0;
+	lastChunk = -1;
+	std::lock_guard<std::mutex> lock(mutex);
+	readyChunks.clear();
+	requestedChunks.clear();
+	stats = RoadStreamerStats();
+	chunksPrefetched = 0;
+}
+
+RoadStreamerStats RoadStreamer::GetStats() const
+{
+	//	The background count is written by the streaming thread, the rest only by the caller of Update
+	RoadStreamerStats stats = this->stats;
+	stats.chunksPrefetched = chunksPrefetched.load();
+	return stats;
+}
+
+void RoadStreamer::PrintReport() const
+{
+	RoadStreamerStats stats = GetStats();
+	if (stats.chunksActivated == 0) return;
+	std::cout << "Road streaming: " << stats.activeChunksCount << " chunks active, " << stats.chunksActivated << " activated, "
+		<< stats.chunksRetired << " retired, " << stats.chunksPrefetched << " generated in the background, "
+		<< stats.chunksGeneratedInline << " on demand" << std::endl;
+}
\ No newline at end of file
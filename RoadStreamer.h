@@ -0,0 +1,95 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <iostream>
+#include <cstdint>
+#include "ThreadPool.h"
+#include "Object.h"
+
+enum class RoadObjectKind
+{
+	ROAD, TERRAIN_1, TERRAIN_2, TERRAIN_3, STREET_LIGHT_LEFT, STREET_LIGHT_RIGHT, TREE_1, TREE_2
+};
+
+const int roadObjectKindsCount = 8;
+
+struct RoadPlacement
+{
+	RoadObjectKind kind;
+	glm::vec3 position;
+	glm::vec3 direction;
+};
+
+struct RoadChunk
+{
+	int index;
+	std::vector<RoadPlacement> placements;
+};
+
+struct RoadStreamerSettings
+{
+	uint64_t seed;
+	float sectionLength;
+	unsigned int sectionsPerChunk;
+	unsigned int lightsPerChunk;
+	unsigned int treesPerChunk;
+	float viewDistance;
+	int prefetchChunks;
+	RoadStreamerSettings();
+};
+
+struct RoadStreamerStats
+{
+	unsigned int activeChunksCount;
+	unsigned long long chunksActivated;
+	unsigned long long chunksRetired;
+	unsigned long long chunksPrefetched;
+	unsigned long long chunksGeneratedInline;
+	RoadStreamerStats();
+};
+
+class RoadStreamer
+{
+private:
+	struct ActiveChunk
+	{
+		RoadChunk chunk;
+		std::vector<Object*> objects;
+	};
+	RoadStreamerSettings settings;
+	std::vector<Object*> pools[roadObjectKindsCount];
+	std::vector<ActiveChunk> activeChunks;
+	int firstChunk;
+	int lastChunk;
+	std::mutex mutex;
+	std::map<int, RoadChunk> readyChunks;
+	std::set<int> requestedChunks;
+	RoadStreamerStats stats;
+	std::atomic<unsigned long long> chunksPrefetched;
+	ThreadPool pool;
+	bool IsActive(int index) const;
+	void Request(int index);
+	bool TakeReady(int index, RoadChunk& chunk);
+	void Activate(RoadChunk& chunk);
+	void Retire(ActiveChunk& chunk);
+public:
+	RoadStreamer();
+	const RoadStreamerSettings& GetSettings() const;
+	void SetSettings(const RoadStreamerSettings& settings);
+	float GetChunkLength() const;
+	int GetChunkIndex(float x) const;
+	unsigned int GetMaxActiveChunks() const;
+	unsigned int GetPoolSize(RoadObjectKind kind) const;
+	void AddPoolObject(RoadObjectKind kind, Object* object);
+	RoadChunk Generate(int index) const;
+	void Update(float focusX);
+	void GetWindow(float& minX, float& maxX) const;
+	void Clear();
+	RoadStreamerStats GetStats() const;
+	void PrintReport() const;
+};
\ No newline at end of file
@@ -64,6 +64,37 @@ Shader::Shader(ShaderType type, const char* vertexPath, const char* fragmentPath
 	glDeleteShader(fragment);
 	if (geometryPath != NULL)
 		glDeleteShader(geometry);
+	loadUniformLocations();
+}
+
+Shader::Shader(ShaderType type, const char* computePath)
+{
+	this->type = type;
+	std::string cCode;
+	try
+	{
+		cCode = readShaderFromFile(computePath);
+	}
+	catch (std::ifstream::failure& e)
+	{
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+		return;
+	}
+	const char* cShaderCode = cCode.c_str();
+
+	unsigned int compute;
+	compute = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(compute, 1, &cShaderCode, NULL);
+	glCompileShader(compute);
+	checkCompileErrors(compute, "COMPUTE");
+
+	programID = glCreateProgram();
+	glAttachShader(programID, compute);
+	glLinkProgram(programID);
+	checkCompileErrors(programID, "PROGRAM");
+
+	glDeleteShader(compute);
+	loadUniformLocations();
 }
 
 Shader::~Shader()
@@ -85,6 +116,58 @@ std::string Shader::readShaderFromFile(const char* path)
 	return tmpCode;
 }
 
+void Shader::loadUniformLocations()
+{
+	//	      
+	uniformLocations.clear();
+	GLint uniformsCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &uniformsCount);
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<char> nameBuffer(glm::max(maxNameLength, 1));
+	for (GLint i = 0; i < uniformsCount; i++)
+	{
+		GLint size = 0;
+		GLenum type;
+		glGetActiveUniform(programID, i, nameBuffer.size(), NULL, &size, &type, &nameBuffer[0]);
+		std::string name = &nameBuffer[0];
+		GLint location = glGetUniformLocation(programID, name.c_str());
+		//	 -   
+		if (location < 0) continue;
+		//	    
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+		{
+			std::string baseName = name.substr(0, name.size() - 3);
+			uniformLocations[baseName] = location;
+			for (GLint j = 0; j < size; j++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(j) + "]";
+				uniformLocations[elementName] = glGetUniformLocation(programID, elementName.c_str());
+			}
+		}
+		else uniformLocations[name] = location;
+	}
+}
+
+GLint Shader::getUniformLocation(const std::string& name) const
+{
+	auto it = uniformLocations.find(name);
+	if (it == uniformLocations.end())
+		return -1;
+	return it->second;
+}
+
+void Shader::bindTexture(RenderStateCache* cache, int unit, GLenum target, GLuint texture) const
+{
+	if (cache != NULL)
+	{
+		cache->BindTexture(unit, target, texture);
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(target, texture);
+}
+
 void Shader::use() const
 {
 	glUseProgram(programID);
@@ -97,33 +180,33 @@ void Shader::free()
 
 void Shader::setBool(const std::string& name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(programID, name.c_str()), (int)value);
+	glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-	glUniform1i(glGetUniformLocation(programID, name.c_str()), value);
+	glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-	glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
+	glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec(const std::string& name, float x, float y) const
 {
-	glUniform2f(glGetUniformLocation(programID, name.c_str()), x, y);
+	glUniform2f(getUniformLocation(name), x, y);
 }
 
 
 void Shader::setVec(const std::string& name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(programID, name.c_str()), x, y, z);
+	glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setVec(const std::string& name, float x, float y, float z, float w) const
 {
-	glUniform4f(glGetUniformLocation(programID, name.c_str()), x, y, z, w);
+	glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setVec(const std::string& name, glm::vec2 vector) const
@@ -143,7 +226,37 @@ void Shader::setVec(const std::string& name, glm::vec4 vector) const
 
 void Shader::setMatrix4F(const std::string& name, const glm::mat4& m) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+	glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(m));
+}
+
+void Shader::set(const Uniform<bool>& uniform, bool value) const
+{
+	glUniform1i(uniform.location, (int)value);
+}
+
+void Shader::set(const Uniform<int>& uniform, int value) const
+{
+	glUniform1i(uniform.location, value);
+}
+
+void Shader::set(const Uniform<float>& uniform, float value) const
+{
+	glUniform1f(uniform.location, value);
+}
+
+void Shader::set(const Uniform<glm::vec3>& uniform, const glm::vec3& value) const
+{
+	glUniform3f(uniform.location, value.x, value.y, value.z);
+}
+
+void Shader::set(const Uniform<glm::vec4>& uniform, const glm::vec4& value) const
+{
+	glUniform4f(uniform.location, value.x, value.y, value.z, value.w);
+}
+
+void Shader::set(const Uniform<glm::mat4>& uniform, const glm::mat4& value) const
+{
+	glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 ShaderType Shader::GetType() const
@@ -151,6 +264,28 @@ ShaderType Shader::GetType() const
 	return type;
 }
 
+Shader* Shader::GetInstancedVariant() const
+{
+	return instancedVariant;
+}
+
+bool Shader::IsInstanced() const
+{
+	return instanced;
+}
+
+void Shader::SetInstancedVariant(Shader* shader)
+{
+	if (shader != NULL && shader->type != type)
+	{
+		std::cout << "ERROR::SHADER:: Instanced variant must have the same type" << std::endl;
+		return;
+	}
+	instancedVariant = shader;
+	if (shader != NULL)
+		shader->instanced = true;
+}
+
 void Shader::checkCompileErrors(unsigned int shader, std::string type)
 {
 	int success;
@@ -183,6 +318,25 @@ void Shader::draw(unsigned int VAO, size_t indicesCount) const
 	glActiveTexture(GL_TEXTURE0);
 }
 
+void Shader::drawInstanced(unsigned int VAO, size_t indicesCount, unsigned int instancesCount, unsigned int baseInstance) const
+{
+	glBindVertexArray(VAO);
+	glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT, 0, instancesCount, baseInstance);
+	glBindVertexArray(0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void Shader::drawIndirect(unsigned int VAO, unsigned int commandBuffer) const
+{
+	//	       GPU
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
 void Shader::clearSamplers() const
 {
 }
@@ -197,20 +351,26 @@ void Shader::clear()
 	clearShaderInfo();
 }
 
-LightInfo::LightInfo(const std::list<glm::mat4>& lightSpaceMats, unsigned int shadowMapID, SourceType type, float farPlane)
+LightInfo::LightInfo(const std::list<glm::mat4>& lightSpaceMats, unsigned int shadowMapID, SourceType type, float farPlane,
+	const glm::vec4& shadowRect)
 {
 	this->lightSpaceMats = lightSpaceMats;
 	this->shadowMapID = shadowMapID;
 	this->type = type;
 	this->farPlane = farPlane;
+	this->shadowRect = shadowRect;
+	this->cascadeSplits = glm::vec4(0.0f);
 }
 
-LightInfo::LightInfo(const glm::mat4& lightSpaceMat, unsigned int shadowMapID, SourceType type, float farPlane)
+LightInfo::LightInfo(const glm::mat4& lightSpaceMat, unsigned int shadowMapID, SourceType type, float farPlane,
+	const glm::vec4& shadowRect)
 {
 	this->lightSpaceMats.push_back(lightSpaceMat);
 	this->shadowMapID = shadowMapID;
 	this->type = type;
 	this->farPlane = farPlane;
+	this->shadowRect = shadowRect;
+	this->cascadeSplits = glm::vec4(0.0f);
 }
 
 LightInfo::LightInfo(unsigned int shadowMapID, SourceType type, float farPlane)
@@ -218,6 +378,8 @@ LightInfo::LightInfo(unsigned int shadowMapID, SourceType type, float farPlane)
 	this->shadowMapID = shadowMapID;
 	this->type = type;
 	this->farPlane = farPlane;
+	this->shadowRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	this->cascadeSplits = glm::vec4(0.0f);
 }
 
 MaterialShaderInfo::MaterialShaderInfo()
@@ -231,6 +393,45 @@ MaterialShader::MaterialShader(const char* vertexPath, const char* fragmentPath,
 	Shader(ShaderType::MATERIAL, vertexPath, fragmentPath, geometryPath)
 {
 	maxMatAndSkyboxTexsCnt = 9;
+	frameBlock = glGetUniformBlockIndex(programID, "FrameInfo") != GL_INVALID_INDEX;
+	loadLocations();
+}
+
+void MaterialShader::loadLocations()
+{
+	uniforms.viewPos = getUniform<glm::vec3>("viewPos");
+	uniforms.model = getUniform<glm::mat4>("model");
+	uniforms.normalMatrix = getUniform<glm::mat4>("normalMatrix");
+	uniforms.finalMatrix = getUniform<glm::mat4>("finalMatrix");
+	uniforms.spaceMatrix = getUniform<glm::mat4>("spaceMatrix");
+	uniforms.packedVertices = getUniform<bool>("packedVertices");
+	uniforms.hasSkybox = getUniform<bool>("hasSkybox");
+	uniforms.skybox = getUniform<int>("skybox");
+	for (int i = 0; i < MaterialShaderUniforms::texturesPerType; i++)
+	{
+		std::string index = std::to_string(i + 1);
+		uniforms.textureDiffuse[i] = getUniform<int>("material.texture_diffuse" + index);
+		uniforms.textureSpecular[i] = getUniform<int>("material.texture_specular" + index);
+		uniforms.textureNormal[i] = getUniform<int>("material.texture_normal" + index);
+		uniforms.textureHeight[i] = getUniform<int>("material.texture_height" + index);
+	}
+	uniforms.diffTextCount = getUniform<int>("material.diffTextCount");
+	uniforms.specTextCount = getUniform<int>("material.specTextCount");
+	uniforms.ambTextCount = getUniform<int>("material.ambTextCount");
+	uniforms.diffuse = getUniform<glm::vec4>("material.diffuse");
+	uniforms.ambient = getUniform<glm::vec4>("material.ambient");
+	uniforms.specular = getUniform<glm::vec4>("material.specular");
+	uniforms.shininess = getUniform<float>("material.shininess");
+	uniforms.alpha = getUniform<float>("material.alpha");
+	uniforms.reflectivity = getUniform<float>("material.reflectivity");
+	uniforms.shadowAtlas = getUniform<int>("shadowAtlas");
+	uniforms.dLightCascades = getUniform<int>("dLightCascades");
+	for (int i = 0; i < MaterialShaderUniforms::pointShadowsCount; i++)
+	{
+		std::string index = "[" + std::to_string(i) + "]";
+		uniforms.pLightShadowMaps[i] = getUniform<int>("pLightShadowMaps" + index);
+		uniforms.pLightFarPlane[i] = getUniform<float>("pLightFarPlane" + index);
+	}
 }
 
 MaterialShader::~MaterialShader()
@@ -239,35 +440,38 @@ MaterialShader::~MaterialShader()
 
 void MaterialShader::loadMatrices(const glm::vec3* viewPos, const glm::mat4* spaceMatrix, const glm::mat4* modelMatrix) const
 {
-	//	 
-	if (viewPos != NULL) setVec("viewPos", *viewPos);
-	else setVec("viewPos", shaderInfo.viewPos);
-	//	 
-	glm::mat4 spaceMat = shaderInfo.spaceMatrix;
-	if (spaceMatrix != NULL) spaceMat = *spaceMatrix;
 	//	 
 	glm::mat4 modelMat = shaderInfo.modelMatrix;
 	if (modelMatrix != NULL) modelMat = *modelMatrix;
-	setMatrix4F("model", modelMat);
+	set(uniforms.model, modelMat);
 	//	    
 	glm::mat4 normalMatrix = glm::transpose(glm::inverse(modelMat));
-	setMatrix4F("normalMatrix", normalMatrix);
+	set(uniforms.normalMatrix, normalMatrix);
+	//	           -
+	if (frameBlock) return;
+	//	 
+	if (viewPos != NULL) set(uniforms.viewPos, *viewPos);
+	else set(uniforms.viewPos, shaderInfo.viewPos);
+	//	 
+	glm::mat4 spaceMat = shaderInfo.spaceMatrix;
+	if (spaceMatrix != NULL) spaceMat = *spaceMatrix;
 	//	 
 	glm::mat4 finalMatrix = spaceMat * modelMat;
-	setMatrix4F("finalMatrix", finalMatrix);
-
+	set(uniforms.finalMatrix, finalMatrix);
+	//	    ,       
+	set(uniforms.spaceMatrix, spaceMat);
 }
 
-void MaterialShader::loadMaterial(const Material* material) const
+void MaterialShader::loadMaterial(const Material* material, RenderStateCache* cache) const
 {
-	setBool("hasSkybox", false);
+	set(uniforms.hasSkybox, false);
+	int diffuseN = 1;
+	int specularN = 1;
+	int normalN = 1;
+	int heightN = 1;
+	int cubeMapN = 1;
 	if (material != NULL)
 	{
-		unsigned int diffuseN = 1;
-		unsigned int specularN = 1;
-		unsigned int normalN = 1;
-		unsigned int heightN = 1;
-		unsigned int cubeMapN = 1;
 		unsigned int samplerIndex = 0;
 
 		const std::vector<Texture>* textures = material->GetTextures();
@@ -275,7 +479,7 @@ void MaterialShader::loadMaterial(const Material* material) const
 		{
 			for (int i = 0; i < textures->size(); i++)
 			{
-				std::string name = "material.";
+				const Uniform<int>* sampler = NULL;
 				switch ((*textures)[i].GetType())
 				{
 				case TextureType::TEXTURE2D:
@@ -283,121 +487,154 @@ void MaterialShader::loadMaterial(const Material* material) const
 					switch ((*textures)[i].GetDataType())
 					{
 					case TextureDataType::DIFFUSE:
-						if (diffuseN > 2) continue;
-						name += "texture_diffuse" + std::to_string(diffuseN++);
+						if (diffuseN > MaterialShaderUniforms::texturesPerType) continue;
+						sampler = &uniforms.textureDiffuse[diffuseN++ - 1];
 						break;
 					case TextureDataType::SPECULAR:
-						if (specularN > 2) continue;
-						name += "texture_specular" + std::to_string(specularN++);
+						if (specularN > MaterialShaderUniforms::texturesPerType) continue;
+						sampler = &uniforms.textureSpecular[specularN++ - 1];
 						break;
 					case TextureDataType::NORMAL:
-						if (normalN > 2) continue;
-						name += "texture_normal" + std::to_string(normalN++);
+						if (normalN > MaterialShaderUniforms::texturesPerType) continue;
+						sampler = &uniforms.textureNormal[normalN++ - 1];
 						break;
 					case TextureDataType::HEIGHT:
-						if (heightN > 2) continue;
-						name += "texture_height" + std::to_string(heightN++);
+						if (heightN > MaterialShaderUniforms::texturesPerType) continue;
+						sampler = &uniforms.textureHeight[heightN++ - 1];
 						break;
 					}
 				}; break;
 				case TextureType::CUBEMAP:
 					if (cubeMapN > 1) continue;
-					name = "skybox";
-					setBool("hasSkybox", true);
+					sampler = &uniforms.skybox;
+					set(uniforms.hasSkybox, true);
 					cubeMapN++;
 					break;
 				default: continue;
 				}
-				setInt(name, samplerIndex);
-				glActiveTexture(GL_TEXTURE0 + samplerIndex);
-				samplerIndex++;
+				if (sampler == NULL) continue;
+				set(*sampler, samplerIndex);
 				if ((*textures)[i].GetType() == TextureType::CUBEMAP)
-				{
-					glBindTexture(GL_TEXTURE_CUBE_MAP, (*textures)[i].GetId());
-				}
-				else
-				{
-					glBindTexture(GL_TEXTURE_2D, (*textures)[i].GetId());
-				}
+					bindTexture(cache, samplerIndex, GL_TEXTURE_CUBE_MAP, (*textures)[i].GetId());
+				else bindTexture(cache, samplerIndex, GL_TEXTURE_2D, (*textures)[i].GetId());
+				samplerIndex++;
 			}
 		}
-		setInt("material.diffTextCount", diffuseN - 1);
-		setInt("material.specTextCount", specularN - 1);
-		setInt("material.ambTextCount", heightN - 1);
-		setVec("material.diffuse", material->GetColor(MaterialType::DIFFUSE));
-		setVec("material.ambient", material->GetColor(MaterialType::AMBIENT));
-		setVec("material.specular", material->GetColor(MaterialType::SPECULAR));
-		setFloat("material.shininess", material->GetProperty(MaterialProp::SHININESS));
-		setFloat("material.alpha", material->GetProperty(MaterialProp::ALPHA));
-		setFloat("material.reflectivity", material->GetProperty(MaterialProp::REFLECTIVITY));
+		set(uniforms.diffTextCount, diffuseN - 1);
+		set(uniforms.specTextCount, specularN - 1);
+		set(uniforms.ambTextCount, heightN - 1);
+		set(uniforms.diffuse, material->GetColor(MaterialType::DIFFUSE));
+		set(uniforms.ambient, material->GetColor(MaterialType::AMBIENT));
+		set(uniforms.specular, material->GetColor(MaterialType::SPECULAR));
+		set(uniforms.shininess, material->GetProperty(MaterialProp::SHININESS));
+		set(uniforms.alpha, material->GetProperty(MaterialProp::ALPHA));
+		set(uniforms.reflectivity, material->GetProperty(MaterialProp::REFLECTIVITY));
 
 	}
 	else
 	{
-		setInt("material.diffTextCount", 0);
-		setInt("material.specTextCount", 0);
-		setInt("material.ambTextCount", 0);
-		setVec("material.diffuse", glm::vec4(1.0f, 0.0f, 0.9f, 1.0f));
-		setVec("material.ambient", glm::vec4(1.0f, 0.0f, 0.9f, 1.0f));
-		setVec("material.specular", glm::vec4(0.0f));
-		setFloat("material.shininess", 32.0f);
-		setFloat("material.alpha", 1.0f);
-		setFloat("material.reflectivity", 0.0f);
+		set(uniforms.diffTextCount, 0);
+		set(uniforms.specTextCount, 0);
+		set(uniforms.ambTextCount, 0);
+		set(uniforms.diffuse, glm::vec4(1.0f, 0.0f, 0.9f, 1.0f));
+		set(uniforms.ambient, glm::vec4(1.0f, 0.0f, 0.9f, 1.0f));
+		set(uniforms.specular, glm::vec4(0.0f));
+		set(uniforms.shininess, 32.0f);
+		set(uniforms.alpha, 1.0f);
+		set(uniforms.reflectivity, 0.0f);
 	}
+	//	     , 
+	//	        
+	for (int i = 0; i < MaterialShaderUniforms::texturesPerType; i++)
+	{
+		if (i >= diffuseN - 1) set(uniforms.textureDiffuse[i], 30);
+		if (i >= specularN - 1) set(uniforms.textureSpecular[i], 30);
+		if (i >= normalN - 1) set(uniforms.textureNormal[i], 30);
+		if (i >= heightN - 1) set(uniforms.textureHeight[i], 30);
+	}
+	if (cubeMapN == 1) set(uniforms.skybox, 31);
 }
 
-void MaterialShader::loadLightsInfo(const std::list<LightInfo>*) const
+void MaterialShader::loadLightsInfo() const
 {
+	//	      -,
+	//	    ,     
+	use();
 	int dLightsIndex = 0;
 	int pLightsIndex = 0;
 	int sLightsIndex = 0;
-	int i = maxMatAndSkyboxTexsCnt;
-	for (auto it = shaderInfo.lightsInfo.begin(); it != shaderInfo.lightsInfo.end(); it++, i++)
+	//	    ,  -  ,
+	//	  -  
+	int atlasUnit = maxMatAndSkyboxTexsCnt;
+	int cascadesUnit = atlasUnit + 1;
+	int i = cascadesUnit + 1;
+	for (auto it = shaderInfo.lightsInfo.begin(); it != shaderInfo.lightsInfo.end(); it++)
 	{
 		switch (it->type)
 		{
 		case SourceType::DIRECTIONAL:
 		{
-			if (it->lightSpaceMats.size() > 0)
-				setMatrix4F("dLightSpaceMatrix[" + std::to_string(dLightsIndex) + "]", it->lightSpaceMats.front());
-			else setMatrix4F("dLightSpaceMatrix[" + std::to_string(dLightsIndex) + "]", glm::mat4(1.0f));
-			setInt("dLightShadowMaps[" + std::to_string(dLightsIndex) + "]", i);
-			glActiveTexture(GL_TEXTURE0 + i);
-			glBindTexture(GL_TEXTURE_2D, it->shadowMapID);
+			if (dLightsIndex > 0) break;
+			set(uniforms.dLightCascades, cascadesUnit);
+			glActiveTexture(GL_TEXTURE0 + cascadesUnit);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, it->shadowMapID);
 			dLightsIndex++;
 		}; break;
+		case SourceType::SPOTLIGHT:
+		{
+			if (sLightsIndex > 0) break;
+			set(uniforms.shadowAtlas, atlasUnit);
+			glActiveTexture(GL_TEXTURE0 + atlasUnit);
+			glBindTexture(GL_TEXTURE_2D, it->shadowMapID);
+			sLightsIndex++;
+		}; break;
 		case SourceType::POINT:
 		{
-			setFloat("pLightFarPlane[" + std::to_string(pLightsIndex) + "]", it->farPlane);
-			setInt("pLightShadowMaps[" + std::to_string(pLightsIndex) + "]", i);
+			if (pLightsIndex >= MaterialShaderUniforms::pointShadowsCount) break;
+			set(uniforms.pLightFarPlane[pLightsIndex], it->farPlane);
+			set(uniforms.pLightShadowMaps[pLightsIndex], i);
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_CUBE_MAP, it->shadowMapID);
 			pLightsIndex++;
-		}; break;
-		case SourceType::SPOTLIGHT:
-		{
-			if (it->lightSpaceMats.size() > 0)
-				setMatrix4F("sLightSpaceMatrix[" + std::to_string(sLightsIndex) + "]", it->lightSpaceMats.front());
-			else setMatrix4F("sLightSpaceMatrix[" + std::to_string(sLightsIndex) + "]", glm::mat4(1.0f));
-			setInt("sLightShadowMaps[" + std::to_string(sLightsIndex) + "]", i);
-			glActiveTexture(GL_TEXTURE0 + i);
-			glBindTexture(GL_TEXTURE_2D, it->shadowMapID);
-			sLightsIndex++;
+			i++;
 		}; break;
 		default:
 			break;
 		}
 	}
+	glActiveTexture(GL_TEXTURE0);
+	if (instancedVariant != NULL)
+		((MaterialShader*)instancedVariant)->loadLightsInfo();
+}
+
+void MaterialShader::loadVertexFormat(bool packedVertices) const
+{
+	//	     
+	set(uniforms.packedVertices, packedVertices);
+}
+
+bool MaterialShader::hasFrameBlock() const
+{
+	return frameBlock;
+}
+
+const std::list<LightInfo>& MaterialShader::getLightsInfo() const
+{
+	return shaderInfo.lightsInfo;
 }
 
 void MaterialShader::setSpaceMatrix(const glm::mat4& spaceMatrix)
 {
 	shaderInfo.spaceMatrix = spaceMatrix;
+	if (instancedVariant != NULL)
+		((MaterialShader*)instancedVariant)->setSpaceMatrix(spaceMatrix);
 }
 
 void MaterialShader::setViewPos(const glm::vec3& position)
 {
 	shaderInfo.viewPos = position;
+	if (instancedVariant != NULL)
+		((MaterialShader*)instancedVariant)->setViewPos(position);
 }
 
 void MaterialShader::setModelMatrix(const glm::mat4& modelMatrix)
@@ -408,41 +645,39 @@ void MaterialShader::setModelMatrix(const glm::mat4& modelMatrix)
 void MaterialShader::addLightInfo(const LightInfo& light)
 {
 	shaderInfo.lightsInfo.push_back(light);
+	if (instancedVariant != NULL)
+		((MaterialShader*)instancedVariant)->addLightInfo(light);
 }
 
 void MaterialShader::loadMainInfo(const glm::vec3* viewPos, const glm::mat4* spaceMatrix, const glm::mat4* modelMatrix, const Material* material) const
 {
 	loadMatrices(viewPos, spaceMatrix, modelMatrix);
 	loadMaterial(material);
-	loadLightsInfo();
 }
 
 void MaterialShader::clearSamplers() const
 {
 	use();
-	setBool("hasSkybox", false);
+	set(uniforms.hasSkybox, false);
 	//	  
-	std::string name = "material.";
-	for (int i = 1; i <= 2; i++)
-	{
-		setInt("material.texture_diffuse" + std::to_string(i), 30);
-		setInt("material.texture_specular" + std::to_string(i), 30);
-		setInt("material.texture_normal" + std::to_string(i), 30);
-		setInt("material.texture_height" + std::to_string(i), 30);
-	}
-	setInt("skybox", 31);
-	//	  
-	for (int i = 0; i < 1; i++)
+	for (int i = 0; i < MaterialShaderUniforms::texturesPerType; i++)
 	{
-		setInt("dLightShadowMaps[" + std::to_string(i) + "]", 30);
+		set(uniforms.textureDiffuse[i], 30);
+		set(uniforms.textureSpecular[i], 30);
+		set(uniforms.textureNormal[i], 30);
+		set(uniforms.textureHeight[i], 30);
 	}
-	for (int i = 0; i < 2; i++)
-	{
-		setInt("pLightShadowMaps[" + std::to_string(i) + "]", 31); 
-	}
-	for (int i = 0; i < 8; i++)
+	set(uniforms.skybox, 31);
+}
+
+void MaterialShader::clearShadowSamplers() const
+{
+	use();
+	set(uniforms.shadowAtlas, 30);
+	set(uniforms.dLightCascades, 29);
+	for (int i = 0; i < MaterialShaderUniforms::pointShadowsCount; i++)
 	{
-		setInt("sLightShadowMaps[" + std::to_string(i) + "]", 30);
+		set(uniforms.pLightShadowMaps[i], 31);
 	}
 }
 
@@ -452,6 +687,10 @@ void MaterialShader::clearShaderInfo()
 	shaderInfo.spaceMatrix = glm::mat4(1.0f);
 	shaderInfo.viewPos = glm::vec3(0.0f);
 	shaderInfo.lightsInfo.clear();
+	//	      
+	clearShadowSamplers();
+	if (instancedVariant != NULL)
+		instancedVariant->clearShaderInfo();
 }
 
 ShadowMapShaderInfo::ShadowMapShaderInfo()
@@ -466,6 +705,24 @@ ShadowMapShaderInfo::ShadowMapShaderInfo()
 ShadowMapShader::ShadowMapShader(const char* vertexPath, const char* fragmentPath, const char* geometryPath) :
 	Shader(ShaderType::SHADOW_MAP, vertexPath, fragmentPath, geometryPath)
 {
+	loadLocations();
+}
+
+void ShadowMapShader::loadLocations()
+{
+	uniforms.model = getUniform<glm::mat4>("model");
+	uniforms.finalMatrix = getUniform<glm::mat4>("finalMatrix");
+	uniforms.lightSpaceMatrix = getUniform<glm::mat4>("lightSpaceMatrix");
+	for (int i = 0; i < ShadowMapShaderUniforms::cubeFacesCount; i++)
+	{
+		uniforms.lightSpaceMatrices[i] = getUniform<glm::mat4>("lightSpaceMatrices[" + std::to_string(i) + "]");
+	}
+	uniforms.linearize = getUniform<bool>("linearize");
+	uniforms.lightPos = getUniform<glm::vec3>("lightPos");
+	uniforms.farPlane = getUniform<float>("farPlane");
+	uniforms.useDiffMap = getUniform<bool>("material.useDiffMap");
+	uniforms.textureDiffuse = getUniform<int>("material.texture_diffuse");
+	uniforms.diffuse = getUniform<glm::vec4>("material.diffuse");
 }
 
 ShadowMapShader::~ShadowMapShader()
@@ -478,7 +735,7 @@ void ShadowMapShader::loadMatrices(const std::list<glm::mat4>* lightSpaceMatrice
 	//	 
 	glm::mat4 modelMat = shaderInfo.modelMatrix;
 	if (modelMatrix != NULL) modelMat = *modelMatrix;
-	setMatrix4F("model", modelMat);
+	set(uniforms.model, modelMat);
 	//	(-) (-) 
 	const std::list<glm::mat4>* lightSpaceMats;
 	if (lightSpaceMatrices != NULL) lightSpaceMats = lightSpaceMatrices;
@@ -486,18 +743,24 @@ void ShadowMapShader::loadMatrices(const std::list<glm::mat4>* lightSpaceMatrice
 	//	 
 	if (lightSpaceMats->size() == 1)
 	{
+		//	      
+		if (instanced)
+		{
+			set(uniforms.lightSpaceMatrix, lightSpaceMats->front());
+			return;
+		}
 		//	 
 		glm::mat4 finalMatrix = lightSpaceMats->front() * modelMat;
-		setMatrix4F("finalMatrix", finalMatrix);
+		set(uniforms.finalMatrix, finalMatrix);
 	}
 	//	 
 	else if (lightSpaceMats->size() >= 6)
 	{
 		int index = 0;
-		for (auto it = lightSpaceMats->begin(); it != lightSpaceMats->end(); it++)
+		for (auto it = lightSpaceMats->begin(); it != lightSpaceMats->end() &&
+			index < ShadowMapShaderUniforms::cubeFacesCount; it++)
 		{
-			glm::mat4 mat = *it;
-			setMatrix4F("lightSpaceMatrices[" + std::to_string(index++) + "]", mat);
+			set(uniforms.lightSpaceMatrices[index++], *it);
 		}
 	}
 }
@@ -505,19 +768,19 @@ void ShadowMapShader::loadMatrices(const std::list<glm::mat4>* lightSpaceMatrice
 void ShadowMapShader::loadLightPosAndFarPlane(const glm::vec3* lightPos, float farPlane) const
 {
 	//	  
-	setBool("linearize", shaderInfo.linearizeDepth);
+	set(uniforms.linearize, shaderInfo.linearizeDepth);
 	if (!shaderInfo.linearizeDepth) return;
 	//	  
-	if (lightPos != NULL) setVec("lightPos", *lightPos);
-	else setVec("lightPos", shaderInfo.lightPos);
+	if (lightPos != NULL) set(uniforms.lightPos, *lightPos);
+	else set(uniforms.lightPos, shaderInfo.lightPos);
 	//	    
-	if (farPlane != 0.0f) setFloat("farPlane", farPlane);
-	else setFloat("farPlane", shaderInfo.farPlane);
+	if (farPlane != 0.0f) set(uniforms.farPlane, farPlane);
+	else set(uniforms.farPlane, shaderInfo.farPlane);
 }
 
-void ShadowMapShader::loadMaterial(const Material* material) const
+void ShadowMapShader::loadMaterial(const Material* material, RenderStateCache* cache) const
 {
-	setBool("material.useDiffMap", false);
+	set(uniforms.useDiffMap, false);
 	if (material != NULL)
 	{
 		const std::vector<Texture>* textures = material->GetTextures();
@@ -529,18 +792,17 @@ void ShadowMapShader::loadMaterial(const Material* material) const
 				{
 					if ((*textures)[i].GetDataType() == TextureDataType::DIFFUSE)
 					{
-						setInt("material.texture_diffuse", 0);
-						glActiveTexture(GL_TEXTURE0);
-						glBindTexture(GL_TEXTURE_2D, (*textures)[i].GetId());
-						setBool("material.useDiffMap", true);
+						set(uniforms.textureDiffuse, 0);
+						bindTexture(cache, 0, GL_TEXTURE_2D, (*textures)[i].GetId());
+						set(uniforms.useDiffMap, true);
 						break;
 					}
 				}
 			}
 		}
-		setVec("material.diffuse", material->GetColor(MaterialType::DIFFUSE));
+		set(uniforms.diffuse, material->GetColor(MaterialType::DIFFUSE));
 	}
-	else setVec("material.diffuse", glm::vec4(1.0f, 0.0f, 0.9f, 1.0f));
+	else set(uniforms.diffuse, glm::vec4(1.0f, 0.0f, 0.9f, 1.0f));
 }
 
 void ShadowMapShader::loadMainInfo(const std::list<glm::mat4>* lightSpaceMatrices, const glm::mat4* modelMatrix,
@@ -555,11 +817,15 @@ void ShadowMapShader::setLightSpaceMatrix(const glm::mat4& lightSpaceMatrix)
 {
 	shaderInfo.lightSpaceMatrices.clear();
 	shaderInfo.lightSpaceMatrices.push_back(lightSpaceMatrix);
+	if (instancedVariant != NULL)
+		((ShadowMapShader*)instancedVariant)->setLightSpaceMatrix(lightSpaceMatrix);
 }
 
 void ShadowMapShader::setLightSpaceMatrices(std::list<glm::mat4>& lightSpaceMatrices)
 {
 	shaderInfo.lightSpaceMatrices = lightSpaceMatrices;
+	if (instancedVariant != NULL)
+		((ShadowMapShader*)instancedVariant)->setLightSpaceMatrices(lightSpaceMatrices);
 }
 
 void ShadowMapShader::setModelMatrix(const glm::mat4& modelMatrix)
@@ -570,22 +836,28 @@ void ShadowMapShader::setModelMatrix(const glm::mat4& modelMatrix)
 void ShadowMapShader::setLightPos(const glm::vec3& lightPos)
 {
 	shaderInfo.lightPos = lightPos;
+	if (instancedVariant != NULL)
+		((ShadowMapShader*)instancedVariant)->setLightPos(lightPos);
 }
 void ShadowMapShader::setFarPlane(float farPlane)
 {
 	shaderInfo.farPlane = farPlane;
+	if (instancedVariant != NULL)
+		((ShadowMapShader*)instancedVariant)->setFarPlane(farPlane);
 }
 
 void ShadowMapShader::enableLinearDepth(bool enable)
 {
 	shaderInfo.linearizeDepth = enable;
+	if (instancedVariant != NULL)
+		((ShadowMapShader*)instancedVariant)->enableLinearDepth(enable);
 }
 
 void ShadowMapShader::clearSamplers() const
 {
 	use();
-	setBool("material.useDiffMap", false);
-	setInt("material.texture_diffuse", 30);
+	set(uniforms.useDiffMap, false);
+	set(uniforms.textureDiffuse, 30);
 }
 
 void ShadowMapShader::clearShaderInfo()
@@ -595,12 +867,15 @@ void ShadowMapShader::clearShaderInfo()
 	shaderInfo.modelMatrix = glm::mat4(1.0f);
 	shaderInfo.farPlane = 1.0f;
 	shaderInfo.linearizeDepth = false;
+	if (instancedVariant != NULL)
+		instancedVariant->clearShaderInfo();
 }
 
 ScreenShader::ScreenShader(const char* vertexPath, const char* fragmentPath, const char* geometryPath) :
 	Shader(ShaderType::SCREEN, vertexPath, fragmentPath, geometryPath)
 {
 	playerSpeed = glm::dvec3(0.0f);
+	playerSpeedUniform = getUniform<glm::vec3>("playerSpeed");
 }
 
 ScreenShader::~ScreenShader()
@@ -611,7 +886,7 @@ void ScreenShader::loadPlayerSpeed(const glm::dvec3* playerSpeed) const
 {
 	glm::dvec3 plrSpeed = this->playerSpeed;
 	if (playerSpeed != NULL) plrSpeed = *playerSpeed;
-	setVec("playerSpeed", (glm::vec3)plrSpeed);
+	set(playerSpeedUniform, (glm::vec3)plrSpeed);
 }
 
 void ScreenShader::loadMainInfo(const glm::dvec3* playerSpeed) const
@@ -624,6 +899,220 @@ void ScreenShader::setPlayerSpeed(glm::dvec3 playerSpeed)
 	this->playerSpeed = playerSpeed;
 }
 
+ComputeShader::ComputeShader(const char* computePath) :
+	Shader(ShaderType::COMPUTE, computePath)
+{
+}
+
+ComputeShader::~ComputeShader()
+{
+}
+
+void ComputeShader::dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const
+{
+	use();
+	glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+RenderStateCache::RenderStateCache()
+{
+	Reset();
+}
+
+void RenderStateCache::Reset()
+{
+	//	 OpenGL   ,    
+	program = 0;
+	for (int i = 0; i < texUnitsCount; i++)
+	{
+		targets[i] = 0;
+		textures[i] = 0;
+	}
+	programChanges = 0;
+	textureBinds = 0;
+	skippedTextureBinds = 0;
+}
+
+bool RenderStateCache::UseProgram(unsigned int programID)
+{
+	if (program == programID) return false;
+	glUseProgram(programID);
+	program = programID;
+	programChanges++;
+	return true;
+}
+
+void RenderStateCache::BindTexture(int unit, GLenum target, GLuint texture)
+{
+	if (unit >= 0 && unit < texUnitsCount)
+	{
+		if (targets[unit] == target && textures[unit] == texture)
+		{
+			skippedTextureBinds++;
+			return;
+		}
+		targets[unit] = target;
+		textures[unit] = texture;
+	}
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(target, texture);
+	textureBinds++;
+}
+
+unsigned int RenderStateCache::GetProgramChangesCount() const
+{
+	return programChanges;
+}
+
+unsigned int RenderStateCache::GetTextureBindsCount() const
+{
+	return textureBinds;
+}
+
+unsigned int RenderStateCache::GetSkippedTextureBindsCount() const
+{
+	return skippedTextureBinds;
+}
+
+FrameUBO::FrameUBO()
+{
+	frameUBO = 0;
+	blockSize = 0;
+	matrixStride = 0;
+	viewOffset = -1;
+	projectionOffset = -1;
+	spaceMatrixOffset = -1;
+	viewPosOffset = -1;
+	cascadeSplitsOffset = -1;
+}
+
+FrameUBO::FrameUBO(const Shader& shader, int cascadesCnt, int sptLightsCnt)
+{
+	cascadeOffsets.resize(glm::max(0, cascadesCnt));
+	sLightSpaceOffsets.resize(glm::max(0, sptLightsCnt));
+	sLightRectOffsets.resize(glm::max(0, sptLightsCnt));
+	GenerateBuffer(shader);
+}
+
+GLint FrameUBO::GetMemberOffset(const Shader& shader, const std::string& name) const
+{
+	const char* uniformName = name.c_str();
+	GLuint index;
+	glGetUniformIndices(shader.ID(), 1, &uniformName, &index);
+	if (index == GL_INVALID_INDEX) return -1;
+	GLint offset;
+	glGetActiveUniformsiv(shader.ID(), 1, &index, GL_UNIFORM_OFFSET, &offset);
+	return offset;
+}
+
+void FrameUBO::GenerateBuffer(const Shader& shader)
+{
+	//	    
+	GLuint blockIndex = glGetUniformBlockIndex(shader.ID(), "FrameInfo");
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		std::cout << "ERROR::FRAME_UBO:: Shader has no FrameInfo block" << std::endl;
+		frameUBO = 0;
+		blockSize = 0;
+		return;
+	}
+	glGetActiveUniformBlockiv(shader.ID(), blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+	glGenBuffers(1, &frameUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+	glBufferData(GL_UNIFORM_BUFFER, blockSize, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	data.assign(blockSize, 0);
+
+	//	   
+	viewOffset = GetMemberOffset(shader, "view");
+	projectionOffset = GetMemberOffset(shader, "projection");
+	spaceMatrixOffset = GetMemberOffset(shader, "spaceMatrix");
+	viewPosOffset = GetMemberOffset(shader, "viewPos");
+	cascadeSplitsOffset = GetMemberOffset(shader, "cascadeSplits");
+	//	     
+	const char* matrixName = "spaceMatrix";
+	GLuint matrixIndex;
+	glGetUniformIndices(shader.ID(), 1, &matrixName, &matrixIndex);
+	glGetActiveUniformsiv(shader.ID(), 1, &matrixIndex, GL_UNIFORM_MATRIX_STRIDE, &matrixStride);
+	//	   ,      
+	for (int i = 0; i < cascadeOffsets.size(); i++)
+	{
+		cascadeOffsets[i] = GetMemberOffset(shader, "cascadeMatrices[" + std::to_string(i) + "]");
+	}
+	for (int i = 0; i < sLightSpaceOffsets.size(); i++)
+	{
+		std::string index = "[" + std::to_string(i) + "]";
+		sLightSpaceOffsets[i] = GetMemberOffset(shader, "sLightSpaceMatrix" + index);
+		sLightRectOffsets[i] = GetMemberOffset(shader, "sLightShadowRects" + index);
+	}
+
+	//	   
+	glBindBufferBase(GL_UNIFORM_BUFFER, 1, frameUBO);
+}
+
+void FrameUBO::WriteMatrix(GLint offset, const glm::mat4& m)
+{
+	if (offset < 0) return;
+	for (int i = 0; i < 4; i++)
+	{
+		memcpy(&data[offset + i * matrixStride], glm::value_ptr(m[i]), sizeof(glm::vec4));
+	}
+}
+
+void FrameUBO::WriteVector(GLint offset, const glm::vec4& v)
+{
+	if (offset < 0) return;
+	memcpy(&data[offset], glm::value_ptr(v), sizeof(glm::vec4));
+}
+
+void FrameUBO::LoadInfo(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+	const std::list<LightInfo>& lights)
+{
+	if (frameUBO == 0) return;
+	//	        
+	WriteMatrix(viewOffset, view);
+	WriteMatrix(projectionOffset, projection);
+	WriteMatrix(spaceMatrixOffset, projection * view);
+	if (viewPosOffset >= 0)
+		memcpy(&data[viewPosOffset], glm::value_ptr(viewPos), sizeof(glm::vec3));
+	//	     
+	WriteVector(cascadeSplitsOffset, glm::vec4(0.0f));
+	int sLightsIndex = 0;
+	for (auto it = lights.begin(); it != lights.end(); it++)
+	{
+		glm::mat4 lightSpaceMat = it->lightSpaceMats.size() > 0 ? it->lightSpaceMats.front() : glm::mat4(1.0f);
+		switch (it->type)
+		{
+		case SourceType::DIRECTIONAL:
+		{
+			int cascade = 0;
+			for (auto mat = it->lightSpaceMats.begin(); mat != it->lightSpaceMats.end() &&
+				cascade < cascadeOffsets.size(); mat++)
+			{
+				WriteMatrix(cascadeOffsets[cascade++], *mat);
+			}
+			WriteVector(cascadeSplitsOffset, it->cascadeSplits);
+		}; break;
+		case SourceType::SPOTLIGHT:
+		{
+			if (sLightsIndex >= sLightSpaceOffsets.size()) break;
+			WriteMatrix(sLightSpaceOffsets[sLightsIndex], lightSpaceMat);
+			WriteVector(sLightRectOffsets[sLightsIndex], it->shadowRect);
+			sLightsIndex++;
+		}; break;
+		default: break;
+		}
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, blockSize, &data[0]);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUBO::Bind() const
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, 1, frameUBO);
+}
+
 LightsUBO::LightsUBO()
 {
 	lightsUBO = 0;
@@ -662,7 +1151,7 @@ void LightsUBO::GenerateBuffer(const Shader& shader)
 	glBindBuffer(GL_UNIFORM_BUFFER, lightsUBO);
 	//	   -    +  
 	int blockSize;
-	glGetActiveUniformBlockiv(shader.ID(), 0,
+	glGetActiveUniformBlockiv(shader.ID(), glGetUniformBlockIndex(shader.ID(), "DirLightsInfo"),
 		GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
 	glBufferData(GL_UNIFORM_BUFFER, blockSize, NULL, GL_STATIC_DRAW);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <unordered_map>
+#include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 #include "LightSource.h"
 #include "Mesh.h"
@@ -17,9 +19,35 @@
 class Material;
 class Mesh;
 
+template<typename T>
+struct Uniform
+{
+	GLint location = -1;
+};
+
+class RenderStateCache
+{
+private:
+	static const int texUnitsCount = 32;
+	unsigned int program;
+	GLenum targets[texUnitsCount];
+	GLuint textures[texUnitsCount];
+	unsigned int programChanges;
+	unsigned int textureBinds;
+	unsigned int skippedTextureBinds;
+public:
+	RenderStateCache();
+	void Reset();
+	bool UseProgram(unsigned int programID);
+	void BindTexture(int unit, GLenum target, GLuint texture);
+	unsigned int GetProgramChangesCount() const;
+	unsigned int GetTextureBindsCount() const;
+	unsigned int GetSkippedTextureBindsCount() const;
+};
+
 enum class ShaderType
 {
-	MATERIAL, SHADOW_MAP, SCREEN
+	MATERIAL, SHADOW_MAP, SCREEN, COMPUTE
 };
 
 class Shader
@@ -27,9 +55,22 @@ class Shader
 protected:
 	unsigned int programID;
 	ShaderType type;
+	Shader* instancedVariant = NULL;
+	bool instanced = false;
+	std::unordered_map<std::string, GLint> uniformLocations;
 	Shader(ShaderType type, const char* vertexPath, const char* fragmentPath, const char* geometryPath = NULL);
+	Shader(ShaderType type, const char* computePath);
 	std::string readShaderFromFile(const char* path);
 	void checkCompileErrors(unsigned int shader, std::string type);
+	void loadUniformLocations();
+	void bindTexture(RenderStateCache* cache, int unit, GLenum target, GLuint texture) const;
+	template<typename T>
+	Uniform<T> getUniform(const std::string& name) const
+	{
+		Uniform<T> uniform;
+		uniform.location = getUniformLocation(name);
+		return uniform;
+	}
 public:
 	~Shader();
 	void use() const;
@@ -44,9 +85,21 @@ public:
 	void setVec(const std::string& name, glm::vec3 vector) const;
 	void setVec(const std::string& name, glm::vec4 vector) const;
 	void setMatrix4F(const std::string& name, const glm::mat4& m) const;
+	void set(const Uniform<bool>& uniform, bool value) const;
+	void set(const Uniform<int>& uniform, int value) const;
+	void set(const Uniform<float>& uniform, float value) const;
+	void set(const Uniform<glm::vec3>& uniform, const glm::vec3& value) const;
+	void set(const Uniform<glm::vec4>& uniform, const glm::vec4& value) const;
+	void set(const Uniform<glm::mat4>& uniform, const glm::mat4& value) const;
+	GLint getUniformLocation(const std::string& name) const;
 	ShaderType GetType() const;
 	unsigned int ID() const;
+	Shader* GetInstancedVariant() const;
+	bool IsInstanced() const;
+	void SetInstancedVariant(Shader* shader);
 	virtual void draw(unsigned int VAO, size_t indicesCount) const;
+	virtual void drawInstanced(unsigned int VAO, size_t indicesCount, unsigned int instancesCount, unsigned int baseInstance) const;
+	virtual void drawIndirect(unsigned int VAO, unsigned int commandBuffer) const;
 	virtual void clearSamplers() const;
 	virtual void clearShaderInfo();
 	void clear();
@@ -58,8 +111,12 @@ struct LightInfo
 	unsigned int shadowMapID;
 	SourceType type;
 	float farPlane;
-	LightInfo(const std::list<glm::mat4>& lightSpaceMats, unsigned int shadowMapID, SourceType type, float farPlane = 25);
-	LightInfo(const glm::mat4& lightSpaceMat, unsigned int shadowMapID, SourceType type, float farPlane = 25);
+	glm::vec4 shadowRect;
+	glm::vec4 cascadeSplits;
+	LightInfo(const std::list<glm::mat4>& lightSpaceMats, unsigned int shadowMapID, SourceType type, float farPlane = 25,
+		const glm::vec4& shadowRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+	LightInfo(const glm::mat4& lightSpaceMat, unsigned int shadowMapID, SourceType type, float farPlane = 25,
+		const glm::vec4& shadowRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
 	LightInfo(unsigned int shadowMapID, SourceType type, float farPlane = 25);
 };
 
@@ -72,19 +129,60 @@ struct MaterialShaderInfo
 	MaterialShaderInfo();
 };
 
+struct MaterialShaderUniforms
+{
+	static const int texturesPerType = 2;
+	static const int dirLightsCount = 1;
+	static const int spotLightsCount = 8;
+	static const int pointShadowsCount = 2;
+	Uniform<glm::vec3> viewPos;
+	Uniform<glm::mat4> model;
+	Uniform<glm::mat4> normalMatrix;
+	Uniform<glm::mat4> finalMatrix;
+	Uniform<glm::mat4> spaceMatrix;
+	Uniform<bool> packedVertices;
+	Uniform<bool> hasSkybox;
+	Uniform<int> skybox;
+	Uniform<int> textureDiffuse[texturesPerType];
+	Uniform<int> textureSpecular[texturesPerType];
+	Uniform<int> textureNormal[texturesPerType];
+	Uniform<int> textureHeight[texturesPerType];
+	Uniform<int> diffTextCount;
+	Uniform<int> specTextCount;
+	Uniform<int> ambTextCount;
+	Uniform<glm::vec4> diffuse;
+	Uniform<glm::vec4> ambient;
+	Uniform<glm::vec4> specular;
+	Uniform<float> shininess;
+	Uniform<float> alpha;
+	Uniform<float> reflectivity;
+	Uniform<int> shadowAtlas;
+	Uniform<int> dLightCascades;
+	Uniform<int> pLightShadowMaps[pointShadowsCount];
+	Uniform<float> pLightFarPlane[pointShadowsCount];
+};
+
 class MaterialShader : public Shader
 {
 private:
+	friend class RenderQueue;
 	MaterialShaderInfo shaderInfo;
+	MaterialShaderUniforms uniforms;
+	bool frameBlock;
+	void loadLocations();
 	void loadMatrices(const glm::vec3* viewPos = NULL, const glm::mat4* spaceMatrix = NULL, const glm::mat4* modelMatrix = NULL) const;
-	void loadMaterial(const Material* material) const;
-	void loadLightsInfo(const std::list<LightInfo>* = NULL) const;
+	void loadMaterial(const Material* material, RenderStateCache* cache = NULL) const;
+	void clearShadowSamplers() const;
 	int maxMatAndSkyboxTexsCnt;
 public:
 	MaterialShader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = NULL);
 	~MaterialShader();
 	void loadMainInfo(const glm::vec3* viewPos = NULL, const glm::mat4* spaceMatrix = NULL,
 		const glm::mat4* modelMatrix = NULL, const Material* material = NULL) const;
+	void loadLightsInfo() const;
+	void loadVertexFormat(bool packedVertices) const;
+	bool hasFrameBlock() const;
+	const std::list<LightInfo>& getLightsInfo() const;
 	void setSpaceMatrix(const glm::mat4& spaceMatrix);
 	void setViewPos(const glm::vec3& position);
 	void setModelMatrix(const glm::mat4& modelMatrix);
@@ -103,13 +201,31 @@ struct ShadowMapShaderInfo
 	ShadowMapShaderInfo();
 };
 
+struct ShadowMapShaderUniforms
+{
+	static const int cubeFacesCount = 6;
+	Uniform<glm::mat4> model;
+	Uniform<glm::mat4> finalMatrix;
+	Uniform<glm::mat4> lightSpaceMatrix;
+	Uniform<glm::mat4> lightSpaceMatrices[cubeFacesCount];
+	Uniform<bool> linearize;
+	Uniform<glm::vec3> lightPos;
+	Uniform<float> farPlane;
+	Uniform<bool> useDiffMap;
+	Uniform<int> textureDiffuse;
+	Uniform<glm::vec4> diffuse;
+};
+
 class ShadowMapShader : public Shader
 {
 private:
+	friend class RenderQueue;
 	ShadowMapShaderInfo shaderInfo;
+	ShadowMapShaderUniforms uniforms;
+	void loadLocations();
 	void loadMatrices(const std::list<glm::mat4>* lightSpaceMatrices = NULL, const glm::mat4* modelMatrix = NULL) const;
 	void loadLightPosAndFarPlane(const glm::vec3* lightPos = NULL, float farPlane = 0.0f) const;
-	void loadMaterial(const Material* material) const;
+	void loadMaterial(const Material* material, RenderStateCache* cache = NULL) const;
 public:
 	ShadowMapShader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = NULL);
 	~ShadowMapShader();
@@ -129,6 +245,7 @@ class ScreenShader : public Shader
 {
 private:
 	glm::dvec3 playerSpeed;
+	Uniform<glm::vec3> playerSpeedUniform;
 	void loadPlayerSpeed(const glm::dvec3* playerSpeed = NULL) const;
 public:
 	ScreenShader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = NULL);
@@ -137,6 +254,41 @@ public:
 	void setPlayerSpeed(glm::dvec3 playerSpeed);
 };
 
+class ComputeShader : public Shader
+{
+public:
+	ComputeShader(const char* computePath);
+	~ComputeShader();
+	void dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+};
+
+class FrameUBO
+{
+private:
+	GLuint frameUBO;
+	GLint blockSize;
+	GLint matrixStride;
+	GLint viewOffset;
+	GLint projectionOffset;
+	GLint spaceMatrixOffset;
+	GLint viewPosOffset;
+	GLint cascadeSplitsOffset;
+	std::vector<GLint> cascadeOffsets;
+	std::vector<GLint> sLightSpaceOffsets;
+	std::vector<GLint> sLightRectOffsets;
+	std::vector<char> data;
+	void GenerateBuffer(const Shader& shader);
+	GLint GetMemberOffset(const Shader& shader, const std::string& name) const;
+	void WriteMatrix(GLint offset, const glm::mat4& m);
+	void WriteVector(GLint offset, const glm::vec4& v);
+public:
+	FrameUBO();
+	FrameUBO(const Shader& shader, int cascadesCnt, int sptLightsCnt);
+	void LoadInfo(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+		const std::list<LightInfo>& lights);
+	void Bind() const;
+};
+
 class LightsUBO
 {
 private:
@@ -0,0 +1,113 @@
+#include "ShadowAtlas.h"
+
+ShadowTile::ShadowTile()
+{
+	x = 0;
+	y = 0;
+	size = 0;
+}
+
+ShadowTile::ShadowTile(int x, int y, int size)
+{
+	this->x = x;
+	this->y = y;
+	this->size = size;
+}
+
+ShadowAtlas::ShadowAtlas(int spotTileSize, int spotTilesCount, int pointMapSize, int pointMapsCount)
+{
+	spotTileSize = glm::max(1, spotTileSize);
+	spotTilesCount = glm::max(1, spotTilesCount);
+	GenerateTiles(spotTileSize, spotTilesCount);
+	atlas = Texture::CreateEmptyTexture(width, height, TextureDataType::DEPTH);
+	for (int i = 0; i < pointMapsCount; i++)
+	{
+		pointMaps.push_back(Texture::CreateEmptyTexture(pointMapSize, pointMapSize,
+			TextureDataType::DEPTH, TextureType::CUBEMAP));
+	}
+}
+
+ShadowAtlas::~ShadowAtlas()
+{
+	atlas.Delete();
+	for (int i = 0; i < pointMaps.size(); i++)
+	{
+		pointMaps[i].Delete();
+	}
+	pointMaps.clear();
+}
+
+void ShadowAtlas::GenerateTiles(int spotTileSize, int spotTilesCount)
+{
+	//	Directional light has its own cascades, spot lights fill a square-ish grid
+	int columns = (int)glm::ceil(glm::sqrt((float)spotTilesCount));
+	int rows = (spotTilesCount + columns - 1) / columns;
+	for (int i = 0; i < spotTilesCount; i++)
+	{
+		spotTiles.push_back(ShadowTile((i % columns) * spotTileSize, (i / columns) * spotTileSize, spotTileSize));
+	}
+	width = columns * spotTileSize;
+	height = rows * spotTileSize;
+}
+
+const Texture& ShadowAtlas::GetTexture() const
+{
+	return atlas;
+}
+
+const ShadowTile* ShadowAtlas::GetSpotTile(int index) const
+{
+	if (index < 0 || index >= spotTiles.size())
+		return NULL;
+	return &spotTiles[index];
+}
+
+const Texture* ShadowAtlas::GetPointMap(int index) const
+{
+	if (index < 0 || index >= pointMaps.size())
+		return NULL;
+	return &pointMaps[index];
+}
+
+int ShadowAtlas::GetSpotTilesCount() const
+{
+	return spotTiles.size();
+}
+
+int ShadowAtlas::GetPointMapsCount() const
+{
+	return pointMaps.size();
+}
+
+int ShadowAtlas::GetWidth() const
+{
+	return width;
+}
+
+int ShadowAtlas::GetHeight() const
+{
+	return height;
+}
+
+glm::vec4 ShadowAtlas::GetTileRect(const ShadowTile& tile) const
+{
+	return glm::vec4((float)tile.x / width, (float)tile.y / height,
+		(float)tile.size / width, (float)tile.size / height);
+}
+
+void ShadowAtlas::PrepareTileForRender(const ShadowTile& tile, bool clear)
+{
+	//	Only the tile is cleared, the rest of the atlas keeps this frame's maps
+	glViewport(tile.x, tile.y, tile.size, tile.size);
+	if (clear)
+	{
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(tile.x, tile.y, tile.size, tile.size);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		glDisable(GL_SCISSOR_TEST);
+	}
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
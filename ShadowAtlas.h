@@ -0,0 +1,39 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Texture.h"
+
+struct ShadowTile
+{
+	int x;
+	int y;
+	int size;
+	ShadowTile();
+	ShadowTile(int x, int y, int size);
+};
+
+class ShadowAtlas
+{
+private:
+	Texture atlas;
+	std::vector<ShadowTile> spotTiles;
+	std::vector<Texture> pointMaps;
+	int width;
+	int height;
+	void GenerateTiles(int spotTileSize, int spotTilesCount);
+public:
+	ShadowAtlas(int spotTileSize, int spotTilesCount, int pointMapSize, int pointMapsCount);
+	~ShadowAtlas();
+	const Texture& GetTexture() const;
+	const ShadowTile* GetSpotTile(int index) const;
+	const Texture* GetPointMap(int index) const;
+	int GetSpotTilesCount() const;
+	int GetPointMapsCount() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	glm::vec4 GetTileRect(const ShadowTile& tile) const;
+	static void PrepareTileForRender(const ShadowTile& tile, bool clear = true);
+};
@@ -0,0 +1,131 @@
+#include "ShadowCache.h"
+
+ShadowCacheStats::ShadowCacheStats()
+{
+	cachedCount = 0;
+	redrawnCount = 0;
+	uncachedCount = 0;
+}
+
+ShadowCache::ShadowCache(int tileSize, int tilesCount)
+{
+	tileSize = glm::max(1, tileSize);
+	tilesCount = glm::max(1, tilesCount);
+	//	Tiles are laid out in a square-ish grid
+	int columns = (int)glm::ceil(glm::sqrt((float)tilesCount));
+	int rows = (tilesCount + columns - 1) / columns;
+	width = columns * tileSize;
+	height = rows * tileSize;
+	for (int i = 0; i < tilesCount; i++)
+	{
+		Entry entry;
+		entry.light = NULL;
+		entry.tile = ShadowTile((i % columns) * tileSize, (i / columns) * tileSize, tileSize);
+		entry.lightSpaceMatrix = glm::mat4(0.0f);
+		entry.signature = 0;
+		entry.lastUsedFrame = 0;
+		entry.valid = false;
+		entries.push_back(entry);
+	}
+	cache = Texture::CreateEmptyTexture(width, height, TextureDataType::DEPTH);
+	frame = 1;
+}
+
+ShadowCache::~ShadowCache()
+{
+	cache.Delete();
+}
+
+const Texture& ShadowCache::GetTexture() const
+{
+	return cache;
+}
+
+const ShadowCacheStats& ShadowCache::GetStats() const
+{
+	return stats;
+}
+
+void ShadowCache::BeginFrame()
+{
+	frame++;
+	stats = ShadowCacheStats();
+}
+
+const ShadowTile* ShadowCache::Acquire(const LightSource* light, const glm::mat4& lightSpaceMatrix, uint64_t signature, bool& upToDate)
+{
+	upToDate = false;
+	Entry* entry = NULL;
+	Entry* oldest = NULL;
+	for (int i = 0; i < entries.size(); i++)
+	{
+		if (entries[i].light == light)
+		{
+			entry = &entries[i];
+			break;
+		}
+		if (entries[i].lastUsedFrame != frame &&
+			(oldest == NULL || entries[i].lastUsedFrame < oldest->lastUsedFrame))
+			oldest = &entries[i];
+	}
+	if (entry != NULL)
+	{
+		entry->lastUsedFrame = frame;
+		//	A moving light would be redrawn every frame anyway, it is rendered directly instead
+		if (entry->lightSpaceMatrix != lightSpaceMatrix)
+		{
+			entry->lightSpaceMatrix = lightSpaceMatrix;
+			entry->valid = false;
+			stats.uncachedCount++;
+			return NULL;
+		}
+		upToDate = entry->valid && entry->signature == signature;
+	}
+	else
+	{
+		//	Least recently used tile is given to the new light
+		if (oldest == NULL)
+		{
+			stats.uncachedCount++;
+			return NULL;
+		}
+		entry = oldest;
+		entry->light = light;
+		entry->lightSpaceMatrix = lightSpaceMatrix;
+		entry->lastUsedFrame = frame;
+	}
+	entry->signature = signature;
+	entry->valid = true;
+	if (upToDate) stats.cachedCount++;
+	else stats.redrawnCount++;
+	return &entry->tile;
+}
+
+void ShadowCache::CopyTile(const ShadowTile& from, const Texture& target, const ShadowTile& to) const
+{
+	int size = glm::min(from.size, to.size);
+	glCopyImageSubData(cache.GetId(), GL_TEXTURE_2D, 0, from.x, from.y, 0,
+		target.GetId(), GL_TEXTURE_2D, 0, to.x, to.y, 0, size, size, 1);
+}
+
+void ShadowCache::Invalidate()
+{
+	for (int i = 0; i < entries.size(); i++)
+	{
+		entries[i].light = NULL;
+		entries[i].valid = false;
+		entries[i].lastUsedFrame = 0;
+	}
+}
+
+uint64_t ShadowCache::Hash(uint64_t seed, const void* data, size_t size)
+{
+	//	FNV-1a
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		seed ^= bytes[i];
+		seed *= 1099511628211ull;
+	}
+	return seed;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "Texture.h"
+#include "ShadowAtlas.h"
+
+class LightSource;
+
+struct ShadowCacheStats
+{
+	unsigned int cachedCount;
+	unsigned int redrawnCount;
+	unsigned int uncachedCount;
+	ShadowCacheStats();
+};
+
+class ShadowCache
+{
+private:
+	struct Entry
+	{
+		const LightSource* light;
+		ShadowTile tile;
+		glm::mat4 lightSpaceMatrix;
+		uint64_t signature;
+		unsigned int lastUsedFrame;
+		bool valid;
+	};
+	Texture cache;
+	std::vector<Entry> entries;
+	ShadowCacheStats stats;
+	unsigned int frame;
+	int width;
+	int height;
+public:
+	ShadowCache(int tileSize, int tilesCount);
+	~ShadowCache();
+	const Texture& GetTexture() const;
+	const ShadowCacheStats& GetStats() const;
+	void BeginFrame();
+	const ShadowTile* Acquire(const LightSource* light, const glm::mat4& lightSpaceMatrix, uint64_t signature, bool& upToDate);
+	void CopyTile(const ShadowTile& from, const Texture& target, const ShadowTile& to) const;
+	void Invalidate();
+	static uint64_t Hash(uint64_t seed, const void* data, size_t size);
+};
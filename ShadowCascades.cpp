@@ -0,0 +1,116 @@
+#include "ShadowCascades.h"
+
+//	Depth range added towards the light so casters outside of the split still land in the map
+static const float casterDistance = 50.0f;
+
+ShadowCascades::ShadowCascades(int resolution, int cascadesCount, float shadowDistance, float splitLambda)
+{
+	this->resolution = glm::max(1, resolution);
+	this->cascadesCount = glm::clamp(cascadesCount, 1, maxCascadesCount);
+	this->shadowDistance = glm::max(1.0f, shadowDistance);
+	this->splitLambda = glm::clamp(splitLambda, 0.0f, 1.0f);
+	lightSpaceMatrices.resize(this->cascadesCount, glm::mat4(1.0f));
+	splitDistances.resize(this->cascadesCount, 0.0f);
+	cascades = Texture::CreateEmptyTextureArray(this->resolution, this->resolution, this->cascadesCount, TextureDataType::DEPTH);
+}
+
+ShadowCascades::~ShadowCascades()
+{
+	cascades.Delete();
+}
+
+void ShadowCascades::ComputeSplits(float zNear, float zFar)
+{
+	//	Practical split scheme: blend of logarithmic and uniform distribution
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		float p = (float)(i + 1) / cascadesCount;
+		float logSplit = zNear * glm::pow(zFar / zNear, p);
+		float uniformSplit = zNear + (zFar - zNear) * p;
+		splitDistances[i] = glm::mix(uniformSplit, logSplit, splitLambda);
+	}
+}
+
+glm::mat4 ShadowCascades::FitCascade(const Camera& camera, const glm::vec3& lightDir, float splitNear, float splitFar) const
+{
+	//	Corners of the camera frustum slice in world space
+	glm::mat4 sliceProjection = glm::perspective(glm::radians(camera.GetFov()), camera.GetAspectRatio(), splitNear, splitFar);
+	glm::mat4 invSlice = glm::inverse(sliceProjection * camera.GetViewMatrix());
+	glm::vec3 corners[8];
+	glm::vec3 center = glm::vec3(0.0f);
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner = invSlice * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+		corners[i] = glm::vec3(corner) / corner.w;
+		center += corners[i];
+	}
+	center /= 8.0f;
+	//	Bounding sphere keeps the cascade size constant while the camera rotates
+	float radius = 0.0f;
+	for (int i = 0; i < 8; i++)
+	{
+		radius = glm::max(radius, glm::length(corners[i] - center));
+	}
+	radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+	glm::vec3 up = glm::abs(lightDir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, up);
+	//	Snapping the center to whole texels removes shimmering when the camera moves
+	glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+	float texelSize = 2.0f * radius / resolution;
+	lightCenter.x = glm::floor(lightCenter.x / texelSize) * texelSize;
+	lightCenter.y = glm::floor(lightCenter.y / texelSize) * texelSize;
+	glm::mat4 lightProjection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+		lightCenter.y - radius, lightCenter.y + radius,
+		-lightCenter.z - radius - casterDistance, -lightCenter.z + radius);
+	return lightProjection * lightView;
+}
+
+void ShadowCascades::Update(const Camera& camera, const DirLight& light)
+{
+	float zNear = camera.GetNearPlane();
+	float zFar = glm::min(camera.GetFarPlane(), shadowDistance);
+	ComputeSplits(zNear, zFar);
+	float splitNear = zNear;
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		lightSpaceMatrices[i] = FitCascade(camera, light.GetDirection(), splitNear, splitDistances[i]);
+		splitNear = splitDistances[i];
+	}
+}
+
+const Texture& ShadowCascades::GetTexture() const
+{
+	return cascades;
+}
+
+int ShadowCascades::GetCascadesCount() const
+{
+	return cascadesCount;
+}
+
+float ShadowCascades::GetShadowDistance() const
+{
+	return shadowDistance;
+}
+
+const glm::mat4& ShadowCascades::GetLightSpaceMatrix(int index) const
+{
+	return lightSpaceMatrices[glm::clamp(index, 0, cascadesCount - 1)];
+}
+
+std::list<glm::mat4> ShadowCascades::GetLightSpaceMatrices() const
+{
+	return std::list<glm::mat4>(lightSpaceMatrices.begin(), lightSpaceMatrices.end());
+}
+
+glm::vec4 ShadowCascades::GetSplitDistances() const
+{
+	//	Unused cascades get a zero split and are never selected
+	glm::vec4 splits = glm::vec4(0.0f);
+	for (int i = 0; i < cascadesCount; i++)
+	{
+		splits[i] = splitDistances[i];
+	}
+	return splits;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <list>
+#include "Texture.h"
+#include "Camera.h"
+#include "LightSource.h"
+
+class ShadowCascades
+{
+private:
+	Texture cascades;
+	int resolution;
+	int cascadesCount;
+	float shadowDistance;
+	float splitLambda;
+	std::vector<glm::mat4> lightSpaceMatrices;
+	std::vector<float> splitDistances;
+	void ComputeSplits(float zNear, float zFar);
+	glm::mat4 FitCascade(const Camera& camera, const glm::vec3& lightDir, float splitNear, float splitFar) const;
+public:
+	static const int maxCascadesCount = 4;
+	ShadowCascades(int resolution, int cascadesCount, float shadowDistance, float splitLambda = 0.75f);
+	~ShadowCascades();
+	void Update(const Camera& camera, const DirLight& light);
+	const Texture& GetTexture() const;
+	int GetCascadesCount() const;
+	float GetShadowDistance() const;
+	const glm::mat4& GetLightSpaceMatrix(int index) const;
+	std::list<glm::mat4> GetLightSpaceMatrices() const;
+	glm::vec4 GetSplitDistances() const;
+};
@@ -0,0 +1,142 @@
+#include "SimulationLod.h"
+
+SimulationLodSettings::SimulationLodSettings()
+{
+	enabled = true;
+	fullDistance = 35.0f;
+	kinematicDistance = 80.0f;
+	hysteresis = 5.0f;
+	reducedInterval = 4;
+}
+
+SimulationLodStats::SimulationLodStats()
+{
+	for (int i = 0; i < 3; i++)
+	{
+		tierCounts[i] = 0;
+		tierTotals[i] = 0;
+	}
+	stepsCount = 0;
+	tierChangesCount = 0;
+}
+
+SimulationLod::SimulationLod()
+{
+	step = 0;
+}
+
+void SimulationLod::AddVehicle(unsigned int vehicle)
+{
+	//	Vehicles start at full rate, the first update moves them to their tier
+	if (vehicle >= tracked.size())
+	{
+		tiers.resize(vehicle + 1, SimulationTier::FULL);
+		tracked.resize(vehicle + 1, 0);
+	}
+	if (tracked[vehicle]) return;
+	tracked[vehicle] = 1;
+	tiers[vehicle] = SimulationTier::FULL;
+	vehicles.push_back(vehicle);
+}
+
+void SimulationLod::Clear()
+{
+	vehicles.clear();
+	tiers.clear();
+	tracked.clear();
+	step = 0;
+	stats = SimulationLodStats();
+}
+
+SimulationTier SimulationLod::ChooseTier(SimulationTier tier, float distance) const
+{
+	//	A car keeps its tier until it is the hysteresis margin past the boundary,
+	//	so cars near a boundary do not switch back and forth every step
+	float fullLimit = settings.fullDistance + (tier == SimulationTier::FULL ? settings.hysteresis : 0.0f);
+	float kinematicLimit = settings.kinematicDistance - (tier == SimulationTier::KINEMATIC ? settings.hysteresis : 0.0f);
+	if (distance < fullLimit)
+		return SimulationTier::FULL;
+	if (distance < kinematicLimit)
+		return SimulationTier::REDUCED;
+	return SimulationTier::KINEMATIC;
+}
+
+void SimulationLod::Update(VehicleSimulation& simulation, const glm::vec3& focus)
+{
+	//	Tiers by the distance to the focus on the ground plane. Kinematic cars are moved by their
+	//	driver along the lane, so the physics batch steps them with zero time
+	step++;
+	for (int i = 0; i < 3; i++)
+	{
+		stats.tierCounts[i] = 0;
+	}
+	for (int i = 0; i < vehicles.size(); i++)
+	{
+		unsigned int vehicle = vehicles[i];
+		glm::vec3 position = simulation.GetPosition(vehicle);
+		float distance = glm::length(glm::vec2(position.x - focus.x, position.z - focus.z));
+		SimulationTier tier = settings.enabled ? ChooseTier(tiers[vehicle], distance) : SimulationTier::FULL;
+		if (tier != tiers[vehicle])
+		{
+			simulation.SetStepScale(vehicle, tier == SimulationTier::KINEMATIC ? 0.0f : 1.0f);
+			tiers[vehicle] = tier;
+			stats.tierChangesCount++;
+		}
+		stats.tierCounts[(int)tier]++;
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		stats.tierTotals[i] += stats.tierCounts[i];
+	}
+	stats.stepsCount++;
+}
+
+SimulationTier SimulationLod::GetTier(unsigned int vehicle) const
+{
+	if (vehicle >= tracked.size() || !tracked[vehicle]) return SimulationTier::FULL;
+	return tiers[vehicle];
+}
+
+bool SimulationLod::IsDue(unsigned int vehicle) const
+{
+	//	Reduced cars act once per interval, shifted by the index so that they do not all act on the same step
+	if (GetTier(vehicle) != SimulationTier::REDUCED) return true;
+	return (step + vehicle) % settings.reducedInterval == 0;
+}
+
+float SimulationLod::GetStepTime(unsigned int vehicle, float dTime) const
+{
+	if (GetTier(vehicle) != SimulationTier::REDUCED) return dTime;
+	return dTime * settings.reducedInterval;
+}
+
+const SimulationLodSettings& SimulationLod::GetSettings() const
+{
+	return settings;
+}
+
+void SimulationLod::SetSettings(const SimulationLodSettings& settings)
+{
+	this->settings = settings;
+	this->settings.fullDistance = glm::max(settings.fullDistance, 0.0f);
+	this->settings.kinematicDistance = glm::max(settings.kinematicDistance, this->settings.fullDistance);
+	this->settings.hysteresis = glm::max(settings.hysteresis, 0.0f);
+	this->settings.reducedInterval = settings.reducedInterval > 0 ? settings.reducedInterval : 1;
+}
+
+const SimulationLodStats& SimulationLod::GetStats() const
+{
+	return stats;
+}
+
+void SimulationLod::PrintReport() const
+{
+	if (stats.stepsCount == 0) return;
+	const char* names[3] = { "full", "reduced", "kinematic" };
+	std::cout << "Simulation LOD:";
+	for (int i = 0; i < 3; i++)
+	{
+		std::cout << " " << (double)stats.tierTotals[i] / stats.stepsCount << " " << names[i] << (i < 2 ? "," : "");
+	}
+	std::cout << " bots per step, " << stats.tierChangesCount << " tier changes" << std::endl;
+}
\ No newline at end of file
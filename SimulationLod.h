@@ -0,0 +1,54 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <iostream>
+#include "VehicleSimulation.h"
+
+enum class SimulationTier
+{
+	FULL, REDUCED, KINEMATIC
+};
+
+struct SimulationLodSettings
+{
+	bool enabled;
+	float fullDistance;
+	float kinematicDistance;
+	float hysteresis;
+	unsigned int reducedInterval;
+	SimulationLodSettings();
+};
+
+struct SimulationLodStats
+{
+	unsigned int tierCounts[3];
+	unsigned long long tierTotals[3];
+	unsigned long long stepsCount;
+	unsigned long long tierChangesCount;
+	SimulationLodStats();
+};
+
+class SimulationLod
+{
+private:
+	SimulationLodSettings settings;
+	std::vector<unsigned int> vehicles;
+	std::vector<SimulationTier> tiers;
+	std::vector<unsigned char> tracked;
+	unsigned long long step;
+	SimulationLodStats stats;
+	SimulationTier ChooseTier(SimulationTier tier, float distance) const;
+public:
+	SimulationLod();
+	void AddVehicle(unsigned int vehicle);
+	void Clear();
+	void Update(VehicleSimulation& simulation, const glm::vec3& focus);
+	SimulationTier GetTier(unsigned int vehicle) const;
+	bool IsDue(unsigned int vehicle) const;
+	float GetStepTime(unsigned int vehicle, float dTime) const;
+	const SimulationLodSettings& GetSettings() const;
+	void SetSettings(const SimulationLodSettings& settings);
+	const SimulationLodStats& GetStats() const;
+	void PrintReport() const;
+};
\ No newline at end of file
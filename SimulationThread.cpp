@@ -0,0 +1,59 @@
+#include "SimulationThread.h"
+
+SimulationThread::SimulationThread()
+{
+	jobPending = false;
+	stopping = false;
+	worker = std::thread(&SimulationThread::WorkerLoop, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	worker.join();
+}
+
+void SimulationThread::WorkerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		condition.wait(lock, [this] { return stopping || jobPending; });
+		if (!jobPending) return;
+		//	The render thread only touches the job through Start and Wait
+		lock.unlock();
+		job();
+		lock.lock();
+		jobPending = false;
+		condition.notify_all();
+	}
+}
+
+void SimulationThread::Start(std::function<void()> job)
+{
+	//	One frame of simulation at a time, a new job waits for the previous one
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = std::move(job);
+		jobPending = true;
+	}
+	condition.notify_all();
+}
+
+void SimulationThread::Wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [this] { return !jobPending; });
+}
+
+bool SimulationThread::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return jobPending;
+}
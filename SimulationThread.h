@@ -0,0 +1,23 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class SimulationThread
+{
+private:
+	std::thread worker;
+	std::function<void()> job;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool jobPending;
+	bool stopping;
+	void WorkerLoop();
+public:
+	SimulationThread();
+	~SimulationThread();
+	void Start(std::function<void()> job);
+	void Wait();
+	bool IsBusy();
+};
@@ -158,8 +158,18 @@ void Key_callback(GLFWwindow* win, int key, int scancode, int action, int mods)
 
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	//	    
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "-benchmark-point-shadows")
+			gameGlob.GetMap()->StartPointShadowBenchmark(300);
+		if (std::string(argv[i]) == "-single-threaded")
+			gameGlob.GetMap()->EnableThreadedSimulation(false);
+		if (std::string(argv[i]) == "-deterministic")
+			gameGlob.GetJobSystem()->SetDeterministic(true);
+	}
 	glfwSetFramebufferSizeCallback(gameGlob.GetWindow(), OnResize);
 	glfwSetCursorPosCallback(gameGlob.GetWindow(), Mouse_callback);
 	glfwSetScrollCallback(gameGlob.GetWindow(), Scroll_callback);
@@ -172,10 +182,17 @@ int main()
 		gameGlob.SetDeltaTime(newTime - oldTime);
 		oldTime = newTime;
 		glfwPollEvents();
+		//	 ,     
+		gameGlob.GetMap()->Synchronize();
 		gameGlob.ProcessInput();
 		gameGlob.GetMap()->Update(gameGlob.GetDeltaTime());
 		gameGlob.GetMap()->Render();
 	}
+	gameGlob.GetMap()->Synchronize();
+	gameGlob.GetMap()->GetSimulationClock().PrintReport();
+	gameGlob.GetMap()->GetTraffic().PrintReport();
+	gameGlob.GetMap()->GetSimulationLod().PrintReport();
+	gameGlob.GetMap()->GetRoadStreamer().PrintReport();
 	gameGlob.GetMap()->Clear();
 
 	glfwTerminate();
@@ -0,0 +1,315 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::Item::Item()
+{
+	minX = 0;
+	minZ = 0;
+	maxX = -1;
+	maxZ = -1;
+	inserted = false;
+	unbounded = false;
+}
+
+SpatialGrid::SpatialGrid()
+{
+	cellSize = 8.0f;
+	queryStamp = 0;
+}
+
+SpatialGrid::SpatialGrid(float cellSize)
+{
+	this->cellSize = cellSize > 0.0f ? cellSize : 8.0f;
+	queryStamp = 0;
+}
+
+uint64_t SpatialGrid::GetCellKey(int x, int z)
+{
+	return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+}
+
+int SpatialGrid::GetCellCoord(float value) const
+{
+	//	Coordinates are clamped so that query boxes reaching to infinity do not overflow
+	double coord = std::floor((double)value / cellSize);
+	return (int)std::max(-1073741824.0, std::min(coord, 1073741824.0));
+}
+
+void SpatialGrid::Update(int item, const AABB& bounds)
+{
+	if (item < 0) return;
+	if (item >= items.size())
+	{
+		items.resize(item + 1);
+		stamps.resize(item + 1, 0);
+	}
+	Item& entry = items[item];
+	//	Items without bounds or covering too many cells are tested by every query
+	bool unbounded = !bounds.IsValid();
+	int minX = 0, minZ = 0, maxX = -1, maxZ = -1;
+	if (!unbounded)
+	{
+		minX = GetCellCoord(bounds.min.x);
+		minZ = GetCellCoord(bounds.min.z);
+		maxX = GetCellCoord(bounds.max.x);
+		maxZ = GetCellCoord(bounds.max.z);
+		unbounded = ((double)maxX - minX + 1.0) * ((double)maxZ - minZ + 1.0) > maxItemCells;
+	}
+	//	Moving inside the same cells only refreshes the bounds
+	if (entry.inserted && entry.unbounded == unbounded &&
+		(unbounded || (entry.minX == minX && entry.minZ == minZ && entry.maxX == maxX && entry.maxZ == maxZ)))
+	{
+		entry.bounds = bounds;
+		if (unbounded) return;
+		for (int x = minX; x <= maxX; x++)
+		{
+			for (int z = minZ; z <= maxZ; z++)
+			{
+				cells[GetCellKey(x, z)].bounds.Expand(bounds);
+			}
+		}
+		return;
+	}
+	if (entry.inserted)
+		Unlink(item);
+	entry.bounds = bounds;
+	entry.minX = minX;
+	entry.minZ = minZ;
+	entry.maxX = maxX;
+	entry.maxZ = maxZ;
+	entry.unbounded = unbounded;
+	Link(item);
+}
+
+void SpatialGrid::Update(int item, const glm::vec3& position)
+{
+	Update(item, AABB(position, position));
+}
+
+void SpatialGrid::Remove(int item)
+{
+	if (!Contains(item)) return;
+	Unlink(item);
+}
+
+void SpatialGrid::Clear()
+{
+	cells.clear();
+	items.clear();
+	unboundedItems.clear();
+	stamps.clear();
+	queryStamp = 0;
+}
+
+bool SpatialGrid::Contains(int item) const
+{
+	return item >= 0 && item < items.size() && items[item].inserted;
+}
+
+float SpatialGrid::GetCellSize() const
+{
+	return cellSize;
+}
+
+unsigned int SpatialGrid::GetCellsCount() const
+{
+	return cells.size();
+}
+
+void SpatialGrid::Link(int item)
+{
+	Item& entry = items[item];
+	entry.inserted = true;
+	if (entry.unbounded)
+	{
+		unboundedItems.push_back(item);
+		return;
+	}
+	for (int x = entry.minX; x <= entry.maxX; x++)
+	{
+		for (int z = entry.minZ; z <= entry.maxZ; z++)
+		{
+			Cell& cell = cells[GetCellKey(x, z)];
+			if (cell.items.empty())
+			{
+				cell.x = x;
+				cell.z = z;
+				cell.bounds = AABB();
+			}
+			cell.items.push_back(item);
+			cell.bounds.Expand(entry.bounds);
+		}
+	}
+}
+
+void SpatialGrid::Unlink(int item)
+{
+	Item& entry = items[item];
+	entry.inserted = false;
+	if (entry.unbounded)
+	{
+		auto it = std::find(unboundedItems.begin(), unboundedItems.end(), item);
+		if (it != unboundedItems.end())
+		{
+			*it = unboundedItems.back();
+			unboundedItems.pop_back();
+		}
+		return;
+	}
+	for (int x = entry.minX; x <= entry.maxX; x++)
+	{
+		for (int z = entry.minZ; z <= entry.maxZ; z++)
+		{
+			auto cell = cells.find(GetCellKey(x, z));
+			if (cell == cells.end()) continue;
+			std::vector<int>& cellItems = cell->second.items;
+			auto it = std::find(cellItems.begin(), cellItems.end(), item);
+			if (it != cellItems.end())
+			{
+				*it = cellItems.back();
+				cellItems.pop_back();
+			}
+			//	Empty cells are dropped, so the map holds only the occupied part of the world
+			if (cellItems.empty())
+				cells.erase(cell);
+			else RecalculateBounds(cell->second);
+		}
+	}
+}
+
+void SpatialGrid::RecalculateBounds(Cell& cell)
+{
+	cell.bounds = AABB();
+	for (int i = 0; i < cell.items.size(); i++)
+	{
+		cell.bounds.Expand(items[cell.items[i]].bounds);
+	}
+}
+
+void SpatialGrid::BeginQuery() const
+{
+	//	Items covering several cells are reported once per query
+	if (++queryStamp == 0)
+	{
+		std::fill(stamps.begin(), stamps.end(), 0);
+		queryStamp = 1;
+	}
+}
+
+bool SpatialGrid::Visit(int item) const
+{
+	if (stamps[item] == queryStamp) return false;
+	stamps[item] = queryStamp;
+	return true;
+}
+
+template<typename Func>
+void SpatialGrid::ForEachCell(int minX, int minZ, int maxX, int maxZ, Func func) const
+{
+	//	Areas larger than the occupied part of the world walk the occupied cells instead
+	double area = ((double)maxX - minX + 1.0) * ((double)maxZ - minZ + 1.0);
+	if (area > cells.size())
+	{
+		for (auto it = cells.begin(); it != cells.end(); it++)
+		{
+			const Cell& cell = it->second;
+			if (cell.x >= minX && cell.x <= maxX && cell.z >= minZ && cell.z <= maxZ)
+				func(cell);
+		}
+		return;
+	}
+	for (int x = minX; x <= maxX; x++)
+	{
+		for (int z = minZ; z <= maxZ; z++)
+		{
+			auto it = cells.find(GetCellKey(x, z));
+			if (it != cells.end())
+				func(it->second);
+		}
+	}
+}
+
+void SpatialGrid::QueryRange(const glm::vec3& center, float radius, std::vector<int>& result) const
+{
+	//	The range is a vertical cylinder, the height test is left to the caller
+	result.clear();
+	BeginQuery();
+	float radiusSq = radius * radius;
+	auto test = [this, &center, radiusSq, &result](int item)
+	{
+		if (!Visit(item)) return;
+		const AABB& bounds = items[item].bounds;
+		float dx = glm::max(glm::max(bounds.min.x - center.x, center.x - bounds.max.x), 0.0f);
+		float dz = glm::max(glm::max(bounds.min.z - center.z, center.z - bounds.max.z), 0.0f);
+		if (!bounds.IsValid() || dx * dx + dz * dz <= radiusSq)
+			result.push_back(item);
+	};
+	for (int i = 0; i < unboundedItems.size(); i++)
+	{
+		test(unboundedItems[i]);
+	}
+	ForEachCell(GetCellCoord(center.x - radius), GetCellCoord(center.z - radius),
+		GetCellCoord(center.x + radius), GetCellCoord(center.z + radius), [&test](const Cell& cell)
+	{
+		for (int i = 0; i < cell.items.size(); i++)
+		{
+			test(cell.items[i]);
+		}
+	});
+	//	Results do not depend on the order of cells in the hash map
+	std::sort(result.begin(), result.end());
+}
+
+void SpatialGrid::QueryBox(const AABB& box, std::vector<int>& result) const
+{
+	//	Only the X/Z footprint of the box is tested
+	result.clear();
+	BeginQuery();
+	auto test = [this, &box, &result](int item)
+	{
+		if (!Visit(item)) return;
+		const AABB& bounds = items[item].bounds;
+		if (!bounds.IsValid() || (bounds.min.x <= box.max.x && bounds.max.x >= box.min.x &&
+			bounds.min.z <= box.max.z && bounds.max.z >= box.min.z))
+			result.push_back(item);
+	};
+	for (int i = 0; i < unboundedItems.size(); i++)
+	{
+		test(unboundedItems[i]);
+	}
+	ForEachCell(GetCellCoord(box.min.x), GetCellCoord(box.min.z), GetCellCoord(box.max.x), GetCellCoord(box.max.z),
+		[&test](const Cell& cell)
+	{
+		for (int i = 0; i < cell.items.size(); i++)
+		{
+			test(cell.items[i]);
+		}
+	});
+	std::sort(result.begin(), result.end());
+}
+
+void SpatialGrid::QueryFrustum(const Frustum& frustum, std::vector<int>& result) const
+{
+	//	Cell bounds enclose their items, so a cell outside the frustum is skipped with all its items
+	result.clear();
+	BeginQuery();
+	for (int i = 0; i < unboundedItems.size(); i++)
+	{
+		int item = unboundedItems[i];
+		if (Visit(item) && frustum.Intersects(items[item].bounds))
+			result.push_back(item);
+	}
+	for (auto it = cells.begin(); it != cells.end(); it++)
+	{
+		const Cell& cell = it->second;
+		if (!frustum.Intersects(cell.bounds)) continue;
+		for (int i = 0; i < cell.items.size(); i++)
+		{
+			int item = cell.items[i];
+			if (Visit(item) && frustum.Intersects(items[item].bounds))
+				result.push_back(item);
+		}
+	}
+	std::sort(result.begin(), result.end());
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "Frustum.h"
+
+class SpatialGrid
+{
+private:
+	struct Cell
+	{
+		int x;
+		int z;
+		AABB bounds;
+		std::vector<int> items;
+	};
+	struct Item
+	{
+		AABB bounds;
+		int minX;
+		int minZ;
+		int maxX;
+		int maxZ;
+		bool inserted;
+		bool unbounded;
+		Item();
+	};
+	float cellSize;
+	std::unordered_map<uint64_t, Cell> cells;
+	std::vector<Item> items;
+	std::vector<int> unboundedItems;
+	mutable std::vector<unsigned int> stamps;
+	mutable unsigned int queryStamp;
+	static const int maxItemCells = 256;
+	static uint64_t GetCellKey(int x, int z);
+	int GetCellCoord(float value) const;
+	void Link(int item);
+	void Unlink(int item);
+	void RecalculateBounds(Cell& cell);
+	void BeginQuery() const;
+	bool Visit(int item) const;
+	template<typename Func>
+	void ForEachCell(int minX, int minZ, int maxX, int maxZ, Func func) const;
+public:
+	SpatialGrid();
+	SpatialGrid(float cellSize);
+	void Update(int item, const AABB& bounds);
+	void Update(int item, const glm::vec3& position);
+	void Remove(int item);
+	void Clear();
+	bool Contains(int item) const;
+	float GetCellSize() const;
+	unsigned int GetCellsCount() const;
+	void QueryRange(const glm::vec3& center, float radius, std::vector<int>& result) const;
+	void QueryBox(const AABB& box, std::vector<int>& result) const;
+	void QueryFrustum(const Frustum& frustum, std::vector<int>& result) const;
+};
\ No newline at end of file
@@ -1,4 +1,22 @@
 #include "Texture.h"
+#include <filesystem>
+#include <algorithm>
+
+ImageData::ImageData()
+{
+	pixels = NULL;
+	width = 0;
+	height = 0;
+	channels = 0;
+}
+
+void ImageData::Free()
+{
+	if (pixels != NULL)
+		SOIL_free_image_data(pixels);
+	pixels = NULL;
+	compressed.Clear();
+}
 
 Texture::Texture()
 {
@@ -9,6 +27,7 @@ Texture::Texture()
 	channelsCount = 3;
 	width = 0.0f;
 	height = 0.0f;
+	memorySize = 0;
 }
 
 Texture::Texture(unsigned int id, TextureDataType dataType, TextureType type, const std::string& path, int width, int height, int channelsCount)
@@ -20,6 +39,7 @@ Texture::Texture(unsigned int id, TextureDataType dataType, TextureType type, co
 	this->channelsCount = channelsCount;
 	this->width = width;
 	this->height = height;
+	this->memorySize = 0;
 }
 
 unsigned int Texture::GetId() const
@@ -57,6 +77,11 @@ int Texture::GetHeight() const
 	return height;
 }
 
+size_t Texture::GetMemorySize() const
+{
+	return memorySize;
+}
+
 void Texture::SetDataType(TextureDataType dataType)
 {
 	this->dataType = dataType;
@@ -90,6 +115,11 @@ void Texture::SetHeight(int height)
 	else this->height = height;
 }
 
+void Texture::SetMemorySize(size_t memorySize)
+{
+	this->memorySize = memorySize;
+}
+
 void Texture::Delete()
 {
 	glDeleteTextures(1, &id);
@@ -97,35 +127,64 @@ void Texture::Delete()
 
 Texture Texture::LoadTexture(const std::string& path, bool useSRGB)
 {
-	GLuint texture;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-	int textureWdth, textureHght;
-	int channels;
-	unsigned char* image = SOIL_load_image(path.c_str(), &textureWdth, &textureHght, &channels, SOIL_LOAD_AUTO);
-	if (!image)
+	ImageData image;
+	if (!DecodeImage(path, image))
+		return Texture(0, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path);
+	Texture texture = UploadImage(path, image, useSRGB);
+	image.Free();
+	return texture;
+}
+
+bool Texture::DecodeImage(const std::string& path, ImageData& image)
+{
+	//	Block-compressed copy from the texture converter is used while it is not older than the source
+	std::string compressedPath = KtxFile::GetCompressedPath(path);
+	std::error_code error;
+	if (GLEW_EXT_texture_compression_s3tc && std::filesystem::exists(compressedPath, error)
+		&& (!std::filesystem::exists(path, error)
+			|| std::filesystem::last_write_time(compressedPath, error) >= std::filesystem::last_write_time(path, error)))
+	{
+		if (KtxFile::Read(compressedPath, image.compressed))
+		{
+			image.width = image.compressed.width;
+			image.height = image.compressed.height;
+			return true;
+		}
+	}
+	image.pixels = SOIL_load_image(path.c_str(), &image.width, &image.height, &image.channels, SOIL_LOAD_AUTO);
+	if (!image.pixels)
 	{
 		std::cout << "ERROR:: Couldn't load texture:: Path:" + path;
-		glBindTexture(GL_TEXTURE_2D, 0);
-		glDeleteTextures(1, &texture);
-		return Texture(0, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path);
+		return false;
 	}
-	switch (channels)
+	return true;
+}
+
+Texture Texture::UploadImage(const std::string& path, const ImageData& image, bool useSRGB)
+{
+	if (!image.compressed.IsEmpty())
+		return UploadCompressedImage(path, image.compressed, useSRGB);
+	if (!image.pixels)
+		return Texture(0, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path);
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	switch (image.channels)
 	{
 	case 1:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_R, textureWdth, textureHght, 0, GL_R, GL_UNSIGNED_BYTE, image);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R, image.width, image.height, 0, GL_R, GL_UNSIGNED_BYTE, image.pixels);
 		break;
 	case 3:
 		if (useSRGB)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, textureWdth, textureHght, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels);
 		else
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, textureWdth, textureHght, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels);
 		break;
 	case 4:
 		if (useSRGB)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, textureWdth, textureHght, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
 		else
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWdth, textureHght, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
 		break;
 	default:
 		break;
@@ -136,8 +195,62 @@ Texture Texture::LoadTexture(const std::string& path, bool useSRGB)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glBindTexture(GL_TEXTURE_2D, 0);
-	SOIL_free_image_data(image);
-	return Texture(texture, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path, textureWdth, textureHght, channels);
+	Texture result(texture, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path, image.width, image.height, image.channels);
+	size_t baseSize = (size_t)image.width * image.height * image.channels;
+	result.SetMemorySize(baseSize + baseSize / 3);
+	return result;
+}
+
+Texture Texture::UploadCompressedImage(const std::string& path, const KtxImage& image, bool useSRGB)
+{
+	unsigned int internalFormat = image.internalFormat;
+	int channels = 3;
+	switch (image.internalFormat)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	{
+		if (useSRGB) internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+		channels = 3;
+	}; break;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	{
+		if (useSRGB) internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		channels = 4;
+	}; break;
+	case GL_COMPRESSED_RG_RGTC2:
+	{
+		channels = 2;
+	}; break;
+	default:
+	{
+		std::cout << "ERROR:: Unsupported compressed texture format:: Path:" + path << std::endl;
+		return Texture(0, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path);
+	}
+	}
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	int levelWidth = image.width;
+	int levelHeight = image.height;
+	for (int i = 0; i < image.levels.size(); i++)
+	{
+		glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, levelWidth, levelHeight, 0,
+			image.levels[i].size(), image.levels[i].data());
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels.size() - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	if (image.levels.size() > 1)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	else
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	Texture result(texture, TextureDataType::UNDEFINED, TextureType::TEXTURE2D, path, image.width, image.height, channels);
+	result.SetMemorySize(image.GetDataSize());
+	return result;
 }
 
 Texture Texture::CreateEmptyTexture(int width, int height, TextureDataType dataType, TextureType type)
@@ -220,33 +333,77 @@ Texture Texture::CreateEmptyCubeMapTexture(int width, int height, TextureDataTyp
 	return Texture(texture, dataType, TextureType::CUBEMAP, "", width, height);
 }
 
+Texture Texture::CreateEmptyTextureArray(int width, int height, int layers, TextureDataType dataType)
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+	switch (dataType)
+	{
+	case TextureDataType::DEPTH:
+	{
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, width, height, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+	}; break;
+	default:
+	{
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, width, height, layers, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}; break;
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	return Texture(texture, dataType, TextureType::TEXTURE2D_ARRAY, "", width, height);
+}
+
 unsigned int Texture::LoadCubeMap(const std::vector<std::string>& pathes)
 {
-	if (pathes.size() != 6)
+	std::vector<ImageData> images(pathes.size());
+	for (int i = 0; i < pathes.size(); i++)
+	{
+		DecodeImage(pathes[i], images[i]);
+	}
+	unsigned int texture = UploadCubeMap(pathes, images);
+	for (int i = 0; i < images.size(); i++)
+	{
+		images[i].Free();
+	}
+	return texture;
+}
+
+unsigned int Texture::UploadCubeMap(const std::vector<std::string>& pathes, const std::vector<ImageData>& images)
+{
+	//	Faces are uploaded as plain pixels, the texture converter leaves skyboxes uncompressed
+	if (pathes.size() != 6 || images.size() != 6)
 	{
 		std::cout << "ERROR:: Couldn't load cube map:: textures count is not equall to 6" << std::endl;
 		return 0;
 	}
-	GLuint texture;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
-	for (int i = 0; i < pathes.size(); i++)
+	for (int i = 0; i < images.size(); i++)
 	{
-		int textureWdth, textureHght;
-		int channels;
-		unsigned char* image = SOIL_load_image(pathes[i].c_str(), &textureWdth, &textureHght, &channels, SOIL_LOAD_AUTO);
-		if (!image)
+		if (!images[i].pixels)
 		{
 			std::cout << "ERROR:: Couldn't load texture:: Path:" + pathes[i];
-			glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-			glDeleteTextures(1, &texture);
 			return 0;
 		}
-		if (channels == 4)
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB_ALPHA, textureWdth, textureHght, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+	}
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+	for (int i = 0; i < images.size(); i++)
+	{
+		const ImageData& image = images[i];
+		if (image.channels == 4)
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB_ALPHA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
 		else
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB, textureWdth, textureHght, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		SOIL_free_image_data(image);
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels);
 	}
 
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
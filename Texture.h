@@ -6,6 +6,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include "KtxFile.h"
 
 enum class TextureDataType
 {
@@ -14,7 +15,18 @@ enum class TextureDataType
 
 enum class TextureType
 {
-	TEXTURE2D, CUBEMAP
+	TEXTURE2D, CUBEMAP, TEXTURE2D_ARRAY
+};
+
+struct ImageData
+{
+	unsigned char* pixels;
+	int width;
+	int height;
+	int channels;
+	KtxImage compressed;
+	ImageData();
+	void Free();
 };
 
 class Texture
@@ -27,6 +39,8 @@ private:
 	int channelsCount;
 	int width;
 	int height;
+	size_t memorySize;
+	static Texture UploadCompressedImage(const std::string& path, const KtxImage& image, bool useSRGB);
 public:
 	Texture();
 	Texture(unsigned int id, TextureDataType dataType, TextureType type, const std::string& path, int width = 0.0f, int height = 0.0f, int channelsCount = 3);
@@ -37,16 +51,22 @@ public:
 	int GetChannelsCount() const;
 	int GetWidth() const;
 	int GetHeight() const;
+	size_t GetMemorySize() const;
 	void SetDataType(TextureDataType dataType);
 	void SetType(TextureType type);
 	void SetPath(const std::string& path);
 	void SetSize(int width, int height);
 	void SetWidth(int width);
 	void SetHeight(int height);
+	void SetMemorySize(size_t memorySize);
 	void Delete();
 	static Texture LoadTexture(const std::string& path, bool useSRGB = false);
+	static bool DecodeImage(const std::string& path, ImageData& image);
+	static Texture UploadImage(const std::string& path, const ImageData& image, bool useSRGB = false);
 	static Texture CreateEmptyTexture(int width, int height, TextureDataType dataType = TextureDataType::COLOR, TextureType type = TextureType::TEXTURE2D);
 	static Texture CreateEmpty2DTexture(int width, int height, TextureDataType dataType = TextureDataType::COLOR);
 	static Texture CreateEmptyCubeMapTexture(int width, int height, TextureDataType dataType = TextureDataType::COLOR);
+	static Texture CreateEmptyTextureArray(int width, int height, int layers, TextureDataType dataType = TextureDataType::COLOR);
 	static unsigned int LoadCubeMap(const std::vector<std::string>& pathes);
+	static unsigned int UploadCubeMap(const std::vector<std::string>& pathes, const std::vector<ImageData>& images);
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "TextureCache.h"
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+
+std::map<std::string, TextureCache::Entry> TextureCache::entries;
+std::map<unsigned int, std::string> TextureCache::keysById;
+TextureCacheStats TextureCache::stats;
+
+TextureCacheStats::TextureCacheStats()
+{
+	hits = 0;
+	misses = 0;
+	residentCount = 0;
+	residentBytes = 0;
+}
+
+std::string TextureCache::GetKey(const std::string& path, bool useSRGB)
+{
+	//	The same file reached through different relative paths must map to one entry
+	std::error_code error;
+	std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+	std::string key = error ? path : canonical.make_preferred().string();
+#ifdef _WIN32
+	std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+#endif
+	return key + (useSRGB ? "|srgb" : "|linear");
+}
+
+Texture TextureCache::Acquire(const std::string& path, bool useSRGB, const ImageData* image)
+{
+	std::string key = GetKey(path, useSRGB);
+	auto it = entries.find(key);
+	if (it != entries.end())
+	{
+		it->second.refCount++;
+		stats.hits++;
+		return it->second.texture;
+	}
+	stats.misses++;
+	Texture texture;
+	if (image != NULL) texture = Texture::UploadImage(path, *image, useSRGB);
+	else texture = Texture::LoadTexture(path, useSRGB);
+	if (texture.GetId() == 0)
+		return texture;
+	Entry entry;
+	entry.texture = texture;
+	entry.refCount = 1;
+	entry.bytes = texture.GetMemorySize();
+	entries.insert(std::make_pair(key, entry));
+	keysById.insert(std::make_pair(texture.GetId(), key));
+	stats.residentCount++;
+	stats.residentBytes += entry.bytes;
+	return texture;
+}
+
+void TextureCache::Release(unsigned int id)
+{
+	//	Textures that were not created by the cache are left to their owners
+	auto key = keysById.find(id);
+	if (key == keysById.end())
+		return;
+	auto it = entries.find(key->second);
+	if (--it->second.refCount > 0)
+		return;
+	it->second.texture.Delete();
+	stats.residentCount--;
+	stats.residentBytes -= it->second.bytes;
+	entries.erase(it);
+	keysById.erase(key);
+}
+
+void TextureCache::Release(const Texture& texture)
+{
+	Release(texture.GetId());
+}
+
+const TextureCacheStats& TextureCache::GetStats()
+{
+	return stats;
+}
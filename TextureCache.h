@@ -0,0 +1,36 @@
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <map>
+#include <string>
+#include <cstdint>
+#include "Texture.h"
+
+struct TextureCacheStats
+{
+	unsigned int hits;
+	unsigned int misses;
+	unsigned int residentCount;
+	uint64_t residentBytes;
+	TextureCacheStats();
+};
+
+class TextureCache
+{
+private:
+	struct Entry
+	{
+		Texture texture;
+		unsigned int refCount;
+		uint64_t bytes;
+	};
+	static std::map<std::string, Entry> entries;
+	static std::map<unsigned int, std::string> keysById;
+	static TextureCacheStats stats;
+	static std::string GetKey(const std::string& path, bool useSRGB);
+public:
+	static Texture Acquire(const std::string& path, bool useSRGB = false, const ImageData* image = NULL);
+	static void Release(unsigned int id);
+	static void Release(const Texture& texture);
+	static const TextureCacheStats& GetStats();
+};
@@ -0,0 +1,60 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadsCount)
+{
+	stopping = false;
+	//	One core is left to the render thread
+	if (threadsCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadsCount = cores > 1 ? cores - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threadsCount; i++)
+	{
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+			//	Queued tasks are finished before the workers exit
+			if (tasks.empty()) return;
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+	condition.notify_one();
+}
+
+unsigned int ThreadPool::GetThreadsCount() const
+{
+	return workers.size();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool
+{
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping;
+	void WorkerLoop();
+public:
+	ThreadPool(unsigned int threadsCount = 0);
+	~ThreadPool();
+	void Submit(std::function<void()> task);
+	unsigned int GetThreadsCount() const;
+};
@@ -0,0 +1,477 @@
+#include "TrafficSystem.h"
+#include <algorithm>
+#include <cmath>
+
+DriverParams::DriverParams()
+{
+	desiredSpeed = 12.0f;
+	timeHeadway = 1.2f;
+	minGap = 2.0f;
+	maxAcceleration = 1.2f;
+	comfortableDeceleration = 2.0f;
+	safeDeceleration = 4.0f;
+	politeness = 0.3f;
+	changeThreshold = 0.2f;
+}
+
+TrafficLane::TrafficLane(float offset, float direction)
+{
+	this->offset = offset;
+	this->direction = direction < 0.0f ? -1.0f : 1.0f;
+	leftLane = -1;
+	rightLane = -1;
+}
+
+TrafficStats::TrafficStats()
+{
+	driversCount = 0;
+	stepsCount = 0;
+	laneChecksCount = 0;
+	laneChangesCount = 0;
+	stepTime = 0.0;
+	maxStepTime = 0.0;
+	lastStepTime = 0.0;
+}
+
+TrafficSystem::Driver::Driver()
+{
+	lane = -1;
+	requestedLane = -1;
+	length = 4.0f;
+	pedal = 0.0f;
+	driven = false;
+	tracked = false;
+	checkLanes = false;
+}
+
+TrafficSystem::TrafficSystem()
+{
+	simulation = NULL;
+	laneChecksPerStep = 16;
+	laneCheckCursor = 0;
+}
+
+int TrafficSystem::AddLane(float offset, float direction)
+{
+	//	Lanes run along X, the offset is the lane centre on Z
+	lanes.push_back(TrafficLane(offset, direction));
+	LinkLanes();
+	return lanes.size() - 1;
+}
+
+void TrafficSystem::LinkLanes()
+{
+	//	The left neighbour is the nearest lane of the same direction on the driver's left:
+	//	towards -Z when driving along +X and towards +Z when driving along -X
+	for (int i = 0; i < lanes.size(); i++)
+	{
+		TrafficLane& lane = lanes[i];
+		lane.leftLane = -1;
+		lane.rightLane = -1;
+		float leftDist = FLT_MAX, rightDist = FLT_MAX;
+		for (int j = 0; j < lanes.size(); j++)
+		{
+			if (i == j || lanes[j].direction != lane.direction) continue;
+			float toLeft = (lane.offset - lanes[j].offset) * lane.direction;
+			if (toLeft > 0.0f && toLeft < leftDist)
+			{
+				leftDist = toLeft;
+				lane.leftLane = j;
+			}
+			else if (toLeft < 0.0f && -toLeft < rightDist)
+			{
+				rightDist = -toLeft;
+				lane.rightLane = j;
+			}
+		}
+	}
+}
+
+void TrafficSystem::Track(unsigned int vehicle, float length)
+{
+	if (vehicle >= drivers.size())
+	{
+		unsigned int size = vehicle + 1;
+		drivers.resize(size);
+		travel.resize(size, 0.0f);
+		travelSpeeds.resize(size, 0.0f);
+		leaders.resize(size, -1);
+		followers.resize(size, -1);
+		for (int side = 0; side < 2; side++)
+		{
+			sideLeaders[side].resize(size, -1);
+			sideFollowers[side].resize(size, -1);
+		}
+	}
+	if (!drivers[vehicle].tracked)
+		trackedVehicles.push_back(vehicle);
+	drivers[vehicle].tracked = true;
+	drivers[vehicle].length = length;
+}
+
+void TrafficSystem::AddDriver(unsigned int vehicle, float length, const DriverParams& params)
+{
+	//	The lane is assigned on the next preparation, when the vehicle position is known
+	Track(vehicle, length);
+	Driver& driver = drivers[vehicle];
+	if (!driver.driven)
+		drivenVehicles.push_back(vehicle);
+	driver.driven = true;
+	driver.params = params;
+	stats.driversCount = drivenVehicles.size();
+}
+
+void TrafficSystem::AddObstacle(unsigned int vehicle, float length)
+{
+	//	Obstacles, e.g. the player, are followed and yielded to, but not driven
+	Track(vehicle, length);
+}
+
+void TrafficSystem::Clear()
+{
+	simulation = NULL;
+	lanes.clear();
+	drivers.clear();
+	drivenVehicles.clear();
+	trackedVehicles.clear();
+	travel.clear();
+	travelSpeeds.clear();
+	leaders.clear();
+	followers.clear();
+	for (int side = 0; side < 2; side++)
+	{
+		sideLeaders[side].clear();
+		sideFollowers[side].clear();
+	}
+	laneCheckCursor = 0;
+	stats = TrafficStats();
+}
+
+int TrafficSystem::FindLane(const glm::vec3& position, float direction) const
+{
+	//	Drivers take the nearest lane of their heading, obstacles occupy a lane only when they are on it
+	int found = -1;
+	float minDist = direction == 0.0f ? 1.5f : FLT_MAX;
+	for (int i = 0; i < lanes.size(); i++)
+	{
+		if (direction * lanes[i].direction < 0.0f) continue;
+		float dist = glm::abs(position.z - lanes[i].offset);
+		if (dist < minDist)
+		{
+			minDist = dist;
+			found = i;
+		}
+	}
+	return found;
+}
+
+void TrafficSystem::Prepare(VehicleSimulation& simulation)
+{
+	//	Serial part of the tick: lane membership, order along the lanes and neighbours.
+	//	After it, Drive only reads shared data and may run for all drivers in parallel
+	this->simulation = &simulation;
+	ApplyLaneChanges();
+	SortLanes();
+	LinkNeighbours();
+	//	Lane changes are considered by a fixed number of drivers per step, in turn,
+	//	so the cost of a step does not grow with the square of the traffic density
+	for (int i = 0; i < drivenVehicles.size(); i++)
+	{
+		drivers[drivenVehicles[i]].checkLanes = false;
+	}
+	unsigned int checks = std::min(laneChecksPerStep, (unsigned int)drivenVehicles.size());
+	for (unsigned int i = 0; i < checks; i++)
+	{
+		laneCheckCursor = (laneCheckCursor + 1) % drivenVehicles.size();
+		drivers[drivenVehicles[laneCheckCursor]].checkLanes = true;
+	}
+	stats.laneChecksCount += checks;
+}
+
+void TrafficSystem::ApplyLaneChanges()
+{
+	for (int i = 0; i < trackedVehicles.size(); i++)
+	{
+		unsigned int vehicle = trackedVehicles[i];
+		Driver& driver = drivers[vehicle];
+		int lane = driver.requestedLane;
+		if (!driver.driven || driver.lane < 0)
+			lane = FindLane(simulation->GetPosition(vehicle), driver.driven ? simulation->GetDirection(vehicle).x : 0.0f);
+		if (lane == driver.lane) continue;
+		if (driver.lane >= 0)
+		{
+			std::vector<unsigned int>& vehicles = lanes[driver.lane].vehicles;
+			vehicles.erase(std::find(vehicles.begin(), vehicles.end(), vehicle));
+			if (driver.driven && lane >= 0)
+				stats.laneChangesCount++;
+		}
+		if (lane >= 0)
+			lanes[lane].vehicles.push_back(vehicle);
+		driver.lane = lane;
+		driver.requestedLane = lane;
+	}
+}
+
+void TrafficSystem::SortLanes()
+{
+	//	Positions along the lane barely change between steps, so insertion sort
+	//	of the previous order is close to one pass
+	for (int l = 0; l < lanes.size(); l++)
+	{
+		std::vector<unsigned int>& vehicles = lanes[l].vehicles;
+		float direction = lanes[l].direction;
+		for (int i = 0; i < vehicles.size(); i++)
+		{
+			unsigned int vehicle = vehicles[i];
+			travel[vehicle] = simulation->GetPosition(vehicle).x * direction;
+			travelSpeeds[vehicle] = simulation->GetSpeed(vehicle).x * direction;
+		}
+		for (int i = 1; i < vehicles.size(); i++)
+		{
+			unsigned int vehicle = vehicles[i];
+			float key = travel[vehicle];
+			int j = i - 1;
+			while (j >= 0 && travel[vehicles[j]] > key)
+			{
+				vehicles[j + 1] = vehicles[j];
+				j--;
+			}
+			vehicles[j + 1] = vehicle;
+		}
+	}
+}
+
+void TrafficSystem::LinkNeighbours()
+{
+	//	Leader and follower are the next and previous cars of the sorted lane. Neighbours in the
+	//	side lanes are found by walking both sorted lanes together, which is O(1) per car on average
+	for (int l = 0; l < lanes.size(); l++)
+	{
+		const std::vector<unsigned int>& vehicles = lanes[l].vehicles;
+		int count = vehicles.size();
+		for (int i = 0; i < count; i++)
+		{
+			leaders[vehicles[i]] = i + 1 < count ? vehicles[i + 1] : -1;
+			followers[vehicles[i]] = i > 0 ? vehicles[i - 1] : -1;
+		}
+		for (int side = 0; side < 2; side++)
+		{
+			int sideLane = side == LEFT ? lanes[l].leftLane : lanes[l].rightLane;
+			if (sideLane < 0)
+			{
+				for (int i = 0; i < count; i++)
+				{
+					sideLeaders[side][vehicles[i]] = -1;
+					sideFollowers[side][vehicles[i]] = -1;
+				}
+				continue;
+			}
+			const std::vector<unsigned int>& sideVehicles = lanes[sideLane].vehicles;
+			int sideCount = sideVehicles.size();
+			int next = 0;
+			for (int i = 0; i < count; i++)
+			{
+				unsigned int vehicle = vehicles[i];
+				while (next < sideCount && travel[sideVehicles[next]] < travel[vehicle])
+					next++;
+				sideLeaders[side][vehicle] = next < sideCount ? sideVehicles[next] : -1;
+				sideFollowers[side][vehicle] = next > 0 ? sideVehicles[next - 1] : -1;
+			}
+		}
+	}
+}
+
+float TrafficSystem::GetGap(int follower, int leader) const
+{
+	return travel[leader] - travel[follower] - (drivers[leader].length + drivers[follower].length) / 2.0f;
+}
+
+float TrafficSystem::GetAcceleration(int vehicle, int leader) const
+{
+	//	Intelligent driver model: free road term and the braking term of the desired gap to the leader.
+	//	Obstacles are not driven, default parameters estimate how they would react
+	static const DriverParams observerParams;
+	const DriverParams& params = drivers[vehicle].driven ? drivers[vehicle].params : observerParams;
+	float speed = glm::max(travelSpeeds[vehicle], 0.0f);
+	float ratio = speed / params.desiredSpeed;
+	float freeRoad = 1.0f - ratio * ratio * ratio * ratio;
+	if (leader < 0)
+		return params.maxAcceleration * freeRoad;
+	float approach = speed - travelSpeeds[leader];
+	float desiredGap = params.minGap + glm::max(0.0f, speed * params.timeHeadway +
+		speed * approach / (2.0f * std::sqrt(params.maxAcceleration * params.comfortableDeceleration)));
+	float gap = glm::max(GetGap(vehicle, leader), 0.1f);
+	float interaction = desiredGap / gap;
+	return glm::max(params.maxAcceleration * (freeRoad - interaction * interaction), -9.81f);
+}
+
+int TrafficSystem::ChooseLane(unsigned int vehicle, float acceleration) const
+{
+	//	Lane change with gap acceptance: the new follower must not have to brake harder than the safe limit,
+	//	and the own gain plus the politeness-weighted gain of the followers must exceed the threshold
+	const Driver& driver = drivers[vehicle];
+	const DriverParams& params = driver.params;
+	if (glm::abs(simulation->GetPosition(vehicle).z - lanes[driver.lane].offset) > 0.3f)
+		return driver.lane;
+	int leader = leaders[vehicle];
+	int follower = followers[vehicle];
+	float oldFollowerGain = 0.0f;
+	if (follower >= 0)
+		oldFollowerGain = GetAcceleration(follower, leader) - GetAcceleration(follower, vehicle);
+	int best = driver.lane;
+	float bestIncentive = params.changeThreshold;
+	for (int side = 0; side < 2; side++)
+	{
+		int target = side == LEFT ? lanes[driver.lane].leftLane : lanes[driver.lane].rightLane;
+		if (target < 0) continue;
+		int newLeader = sideLeaders[side][vehicle];
+		int newFollower = sideFollowers[side][vehicle];
+		if (newLeader >= 0 && GetGap(vehicle, newLeader) < params.minGap) continue;
+		float newFollowerGain = 0.0f;
+		if (newFollower >= 0)
+		{
+			if (GetGap(newFollower, vehicle) < params.minGap) continue;
+			float newFollowerAcceleration = GetAcceleration(newFollower, vehicle);
+			if (newFollowerAcceleration < -params.safeDeceleration) continue;
+			newFollowerGain = newFollowerAcceleration - GetAcceleration(newFollower, newLeader);
+		}
+		float incentive = GetAcceleration(vehicle, newLeader) - acceleration +
+			params.politeness * (newFollowerGain + oldFollowerGain);
+		if (incentive > bestIncentive)
+		{
+			bestIncentive = incentive;
+			best = target;
+		}
+	}
+	return best;
+}
+
+void TrafficSystem::Steer(unsigned int vehicle, CarControls& controls) const
+{
+	//	The car aims at a point on the lane centre ahead of it. Steering is a key that eases the wheels
+	//	towards full lock, so it is held only while the wheels turn less than the aim requires
+	const float steeringGain = 12.0f;
+	const float deadband = 0.05f;
+	const TrafficLane& lane = lanes[drivers[vehicle].lane];
+	glm::vec3 position = simulation->GetPosition(vehicle);
+	glm::vec3 direction = simulation->GetDirection(vehicle);
+	glm::vec2 forward = glm::vec2(direction.x, direction.z);
+	float length = glm::length(forward);
+	if (length == 0.0f) return;
+	forward /= length;
+	float lookAhead = glm::max(6.0f, travelSpeeds[vehicle]);
+	glm::vec2 target = glm::normalize(glm::vec2(lane.direction * lookAhead, lane.offset - position.z));
+	float cross = forward.x * target.y - forward.y * target.x;
+	float maxTurn = simulation->GetMaxTurnAngle(vehicle);
+	float desiredTurn = glm::clamp(-cross * steeringGain, -maxTurn, maxTurn);
+	float turn = simulation->GetTurnAngle(vehicle);
+	controls.left = desiredTurn > turn + deadband;
+	controls.right = desiredTurn < turn - deadband;
+}
+
+void TrafficSystem::Drive(unsigned int vehicle, float dTime)
+{
+	//	Writes only the state and controls of its own vehicle
+	if (simulation == NULL || vehicle >= drivers.size()) return;
+	Driver& driver = drivers[vehicle];
+	if (!driver.driven || driver.lane < 0) return;
+	float acceleration = GetAcceleration(vehicle, leaders[vehicle]);
+	if (driver.checkLanes && driver.requestedLane == driver.lane)
+		driver.requestedLane = ChooseLane(vehicle, acceleration);
+	//	Throttle and brake are on or off, so the requested acceleration is spread over steps:
+	//	the pedal accumulates the request and a step is driven or braked once enough has built up
+	CarControls controls;
+	float driveAcceleration = simulation->GetDriveForce(vehicle) / simulation->GetMass(vehicle) * dTime;
+	float brakeAcceleration = driveAcceleration * 2.7f;
+	driver.pedal = glm::clamp(driver.pedal + acceleration * dTime, -brakeAcceleration, driveAcceleration);
+	if (driver.pedal > driveAcceleration / 2.0f)
+	{
+		controls.forward = true;
+		driver.pedal -= driveAcceleration;
+	}
+	else if (driver.pedal < -brakeAcceleration / 2.0f)
+	{
+		controls.brake = true;
+		driver.pedal += brakeAcceleration;
+	}
+	Steer(vehicle, controls);
+	simulation->SetControls(vehicle, controls);
+}
+
+void TrafficSystem::Coast(unsigned int vehicle, float dTime)
+{
+	//	Cheap path for distant cars: no steering or physics, the car slides along the lane centre
+	//	with the speed of the car-following model and keeps its place in the lane order
+	if (simulation == NULL || vehicle >= drivers.size()) return;
+	Driver& driver = drivers[vehicle];
+	if (!driver.driven || driver.lane < 0) return;
+	const TrafficLane& lane = lanes[driver.lane];
+	float acceleration = GetAcceleration(vehicle, leaders[vehicle]);
+	float speed = glm::max(travelSpeeds[vehicle] + acceleration * dTime, 0.0f);
+	glm::vec3 position = simulation->GetPosition(vehicle);
+	position.x += lane.direction * speed * dTime;
+	position.z += (lane.offset - position.z) * glm::min(dTime * 2.0f, 1.0f);
+	simulation->SetPosition(vehicle, position);
+	simulation->SetDirection(vehicle, glm::vec3(lane.direction, 0.0f, 0.0f));
+	simulation->SetSpeed(vehicle, glm::vec3(lane.direction * speed, 0.0f, 0.0f));
+	simulation->SetControls(vehicle, CarControls());
+	driver.pedal = 0.0f;
+}
+
+void TrafficSystem::AddStepTime(double time)
+{
+	stats.stepsCount++;
+	stats.stepTime += time;
+	stats.lastStepTime = time;
+	stats.maxStepTime = glm::max(stats.maxStepTime, time);
+}
+
+unsigned int TrafficSystem::GetLaneChecksPerStep() const
+{
+	return laneChecksPerStep;
+}
+
+void TrafficSystem::SetLaneChecksPerStep(unsigned int count)
+{
+	laneChecksPerStep = count;
+}
+
+int TrafficSystem::GetLane(unsigned int vehicle) const
+{
+	if (vehicle >= drivers.size()) return -1;
+	return drivers[vehicle].lane;
+}
+
+float TrafficSystem::GetLaneWidth() const
+{
+	//	Lanes are not given a width, the closest pair of lane centres bounds it
+	float width = FLT_MAX;
+	for (int i = 0; i < lanes.size(); i++)
+	{
+		for (int j = i + 1; j < lanes.size(); j++)
+		{
+			width = glm::min(width, glm::abs(lanes[i].offset - lanes[j].offset));
+		}
+	}
+	return width;
+}
+
+float TrafficSystem::GetSpacing(unsigned int vehicle) const
+{
+	//	Distance between centres the driver keeps to a standing car of the same length
+	if (vehicle >= drivers.size()) return 0.0f;
+	const Driver& driver = drivers[vehicle];
+	return driver.length + driver.params.minGap;
+}
+
+const TrafficStats& TrafficSystem::GetStats() const
+{
+	return stats;
+}
+
+void TrafficSystem::PrintReport() const
+{
+	if (stats.stepsCount == 0) return;
+	std::cout << "Traffic: " << stats.driversCount << " drivers, " << stats.stepTime / stats.stepsCount * 1000.0
+		<< " ms per step, " << stats.maxStepTime * 1000.0 << " ms at most, " << stats.laneChangesCount << " lane changes" << std::endl;
+}
\ No newline at end of file
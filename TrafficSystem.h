@@ -0,0 +1,104 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <iostream>
+#include <cfloat>
+#include "VehicleSimulation.h"
+
+struct DriverParams
+{
+	float desiredSpeed;
+	float timeHeadway;
+	float minGap;
+	float maxAcceleration;
+	float comfortableDeceleration;
+	float safeDeceleration;
+	float politeness;
+	float changeThreshold;
+	DriverParams();
+};
+
+struct TrafficLane
+{
+	float offset;
+	float direction;
+	int leftLane;
+	int rightLane;
+	std::vector<unsigned int> vehicles;
+	TrafficLane(float offset, float direction);
+};
+
+struct TrafficStats
+{
+	unsigned int driversCount;
+	unsigned long long stepsCount;
+	unsigned long long laneChecksCount;
+	unsigned long long laneChangesCount;
+	double stepTime;
+	double maxStepTime;
+	double lastStepTime;
+	TrafficStats();
+};
+
+class TrafficSystem
+{
+private:
+	struct Driver
+	{
+		DriverParams params;
+		int lane;
+		int requestedLane;
+		float length;
+		float pedal;
+		bool driven;
+		bool tracked;
+		bool checkLanes;
+		Driver();
+	};
+	enum Side
+	{
+		LEFT = 0, RIGHT = 1
+	};
+	VehicleSimulation* simulation;
+	std::vector<TrafficLane> lanes;
+	std::vector<Driver> drivers;
+	std::vector<unsigned int> drivenVehicles;
+	std::vector<unsigned int> trackedVehicles;
+	std::vector<float> travel;
+	std::vector<float> travelSpeeds;
+	std::vector<int> leaders;
+	std::vector<int> followers;
+	std::vector<int> sideLeaders[2];
+	std::vector<int> sideFollowers[2];
+	unsigned int laneChecksPerStep;
+	unsigned int laneCheckCursor;
+	TrafficStats stats;
+	void LinkLanes();
+	int FindLane(const glm::vec3& position, float direction) const;
+	void Track(unsigned int vehicle, float length);
+	void ApplyLaneChanges();
+	void SortLanes();
+	void LinkNeighbours();
+	float GetGap(int follower, int leader) const;
+	float GetAcceleration(int vehicle, int leader) const;
+	int ChooseLane(unsigned int vehicle, float acceleration) const;
+	void Steer(unsigned int vehicle, CarControls& controls) const;
+public:
+	TrafficSystem();
+	int AddLane(float offset, float direction);
+	void AddDriver(unsigned int vehicle, float length, const DriverParams& params);
+	void AddObstacle(unsigned int vehicle, float length);
+	void Clear();
+	void Prepare(VehicleSimulation& simulation);
+	void Drive(unsigned int vehicle, float dTime);
+	void Coast(unsigned int vehicle, float dTime);
+	void AddStepTime(double time);
+	unsigned int GetLaneChecksPerStep() const;
+	void SetLaneChecksPerStep(unsigned int count);
+	int GetLane(unsigned int vehicle) const;
+	float GetLaneWidth() const;
+	float GetSpacing(unsigned int vehicle) const;
+	const TrafficStats& GetStats() const;
+	void PrintReport() const;
+};
\ No newline at end of file
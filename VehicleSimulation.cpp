@@ -0,0 +1,353 @@
+#include "VehicleSimulation.h"
+#include <cmath>
+
+VehicleParams::VehicleParams()
+{
+	mass = 2000.0f;
+	wheelsAxisDist = 50.0f;
+	wheelsRadius = 0.42f;
+	diffRatio = 3.42f;
+	transEfficiency = 0.7f;
+	maxTorque = 300.0f;
+	gearRatio = GEAR_RATIO_1;
+	maxTurnAngle = 45.0f;
+}
+
+VehicleSimulation::VehicleSimulation()
+{
+	activeCount = 0;
+}
+
+void VehicleSimulation::Reserve(unsigned int capacity)
+{
+	positionX.reserve(capacity);
+	positionY.reserve(capacity);
+	positionZ.reserve(capacity);
+	directionX.reserve(capacity);
+	directionY.reserve(capacity);
+	directionZ.reserve(capacity);
+	speedX.reserve(capacity);
+	speedY.reserve(capacity);
+	speedZ.reserve(capacity);
+	mass.reserve(capacity);
+	wheelsAxisDist.reserve(capacity);
+	driveFactor.reserve(capacity);
+	gearRatio.reserve(capacity);
+	maxTorque.reserve(capacity);
+	maxTurnAngle.reserve(capacity);
+	turnAngle.reserve(capacity);
+	angularVel.reserve(capacity);
+	stepScales.reserve(capacity);
+	controls.reserve(capacity);
+}
+
+unsigned int VehicleSimulation::Add(const glm::vec3& position, const glm::vec3& direction, const glm::vec3& speed, const VehicleParams& params)
+{
+	//	Slots of removed vehicles are reused, so indices held by cars stay valid
+	unsigned int index;
+	if (!freeSlots.empty())
+	{
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else
+	{
+		index = positionX.size();
+		positionX.push_back(0.0f);
+		positionY.push_back(0.0f);
+		positionZ.push_back(0.0f);
+		directionX.push_back(0.0f);
+		directionY.push_back(0.0f);
+		directionZ.push_back(0.0f);
+		speedX.push_back(0.0f);
+		speedY.push_back(0.0f);
+		speedZ.push_back(0.0f);
+		mass.push_back(0.0f);
+		wheelsAxisDist.push_back(0.0f);
+		driveFactor.push_back(0.0f);
+		gearRatio.push_back(0.0f);
+		maxTorque.push_back(0.0f);
+		maxTurnAngle.push_back(0.0f);
+		turnAngle.push_back(0.0f);
+		angularVel.push_back(0.0f);
+		stepScales.push_back(1.0f);
+		controls.push_back(0);
+	}
+	SetPosition(index, position);
+	SetDirection(index, direction);
+	SetSpeed(index, speed);
+	mass[index] = params.mass;
+	wheelsAxisDist[index] = params.wheelsAxisDist;
+	driveFactor[index] = params.maxTorque * params.diffRatio * params.transEfficiency / params.wheelsRadius;
+	gearRatio[index] = params.gearRatio;
+	maxTorque[index] = params.maxTorque;
+	maxTurnAngle[index] = params.maxTurnAngle;
+	turnAngle[index] = 0.0f;
+	angularVel[index] = 0.0f;
+	stepScales[index] = 1.0f;
+	controls[index] = 0;
+	activeCount++;
+	return index;
+}
+
+void VehicleSimulation::Remove(unsigned int index)
+{
+	//	A free slot stays in the arrays at rest, the update pass over it changes nothing
+	speedX[index] = 0.0f;
+	speedY[index] = 0.0f;
+	speedZ[index] = 0.0f;
+	turnAngle[index] = 0.0f;
+	angularVel[index] = 0.0f;
+	controls[index] = 0;
+	freeSlots.push_back(index);
+	activeCount--;
+}
+
+void VehicleSimulation::Update(float dTime)
+{
+	Update(dTime, 0, positionX.size());
+}
+
+void VehicleSimulation::Update(float dTime, unsigned int begin, unsigned int end)
+{
+	//	Controls, resistance forces and integration of all vehicles in one pass over float arrays.
+	//	Branches are written as selects, so the loop has no per-vehicle control flow to break vectorization
+	float* __restrict px = positionX.data();
+	float* __restrict py = positionY.data();
+	float* __restrict pz = positionZ.data();
+	float* __restrict dx = directionX.data();
+	float* __restrict dy = directionY.data();
+	float* __restrict dz = directionZ.data();
+	float* __restrict vx = speedX.data();
+	float* __restrict vy = speedY.data();
+	float* __restrict vz = speedZ.data();
+	float* __restrict gears = gearRatio.data();
+	float* __restrict turns = turnAngle.data();
+	float* __restrict angularVels = angularVel.data();
+	const float* __restrict masses = mass.data();
+	const float* __restrict axisDists = wheelsAxisDist.data();
+	const float* __restrict driveFactors = driveFactor.data();
+	const float* __restrict maxTurns = maxTurnAngle.data();
+	const unsigned char* __restrict flags = controls.data();
+	const float* __restrict scales = stepScales.data();
+	const float degToRad = (float)M_PI / 180.0f;
+	const float radToDeg = 180.0f / (float)M_PI;
+	const float dragCoef = 0.42f;
+	const float rubCoef = dragCoef * 30.0f;
+	const float frictionCoef = 9.81f * 0.25f;
+	//	Centripetal force keeps the rotation of the former glm::rotate call, whose angle of 90 is in radians
+	const float centripetalCos = std::cos(90.0f);
+	const float centripetalSin = std::sin(90.0f);
+	const int n = end;
+	for (int i = begin; i < n; i++)
+	{
+		const float forward = (flags[i] & FORWARD) ? 1.0f : 0.0f;
+		const float backward = (flags[i] & BACKWARD) ? 1.0f : 0.0f;
+		const bool left = (flags[i] & LEFT) != 0;
+		const bool right = (flags[i] & RIGHT) != 0;
+		const float brake = (flags[i] & BRAKE) ? 1.0f : 0.0f;
+		const float m = masses[i];
+		const float maxTurn = maxTurns[i];
+		//	Vehicles moved by other means, e.g. distant traffic, are stepped with zero time
+		const float dt = dTime * scales[i];
+		const float turnRate = dt * 3.0f;
+
+		//	Drive force of the selected gear
+		float gear = forward > 0.0f ? GEAR_RATIO_1 : gears[i];
+		gear = backward > 0.0f ? GEAR_RATIO_R : gear;
+		const float drive = (forward * GEAR_RATIO_1 - backward * GEAR_RATIO_R) * driveFactors[i];
+		float fx = dx[i] * drive;
+		float fy = dy[i] * drive;
+		float fz = dz[i] * drive;
+
+		//	Speed along the car direction
+		const float vDotD = (vx[i] * dx[i] + vy[i] * dy[i] + vz[i] * dz[i]) / (dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+		const float lx = dx[i] * vDotD;
+		const float ly = dy[i] * vDotD;
+		const float lz = dz[i] * vDotD;
+		const float longSpeed = std::sqrt(lx * lx + ly * ly + lz * lz);
+		const float speed = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+
+		//	Steering eases towards a target angle that shrinks with speed
+		const float steer = glm::clamp(40.0f / (longSpeed / 2.0f + 0.001f), -maxTurn, maxTurn);
+		float turn = turns[i];
+		turn = left ? glm::clamp(turn + (steer - turn) * turnRate, -maxTurn, maxTurn) : turn;
+		turn = right ? glm::clamp(turn + (-steer - turn) * turnRate, -maxTurn, maxTurn) : turn;
+		turn = (!left && !right) ? glm::clamp(turn - turn * turnRate, -maxTurn, maxTurn) : turn;
+		const float turnSin = std::sin(std::abs(turn) * degToRad);
+		const float angVel = speed / axisDists[i] * std::sin(turn * degToRad) * radToDeg;
+
+		//	Braking against the longitudinal speed
+		const float longInv = longSpeed != 0.0f ? 1.0f / longSpeed : 0.0f;
+		const float brakeForce = brake * gear * driveFactors[i] * 2.7f * longInv;
+		fx -= lx * brakeForce;
+		fy -= ly * brakeForce;
+		fz -= lz * brakeForce;
+
+		//	Drag and rolling resistance
+		fx -= vx[i] * speed * dragCoef + lx * rubCoef;
+		fy -= vy[i] * speed * dragCoef + ly * rubCoef;
+		fz -= vz[i] * speed * dragCoef + lz * rubCoef;
+
+		//	Side friction grows as the car slides across its direction
+		const float speedInv = speed != 0.0f ? 1.0f / speed : 0.0f;
+		const float sx = vx[i] * speedInv;
+		const float sy = vy[i] * speedInv;
+		const float sz = vz[i] * speedInv;
+		const float friction = m * frictionCoef * (1.1f - std::abs(sx * dx[i] + sy * dy[i] + sz * dz[i]));
+		fx -= sx * friction;
+		fy -= sy * friction;
+		fz -= sz * friction;
+
+		//	Centripetal force of the turning radius, zero when the wheels are straight
+		const float turnSign = turn < 0.0f ? -1.0f : 1.0f;
+		const float rotSin = -turnSign * centripetalSin;
+		const float centripetal = longSpeed * m * turnSin / axisDists[i];
+		fx += (lx * centripetalCos + lz * rotSin) * centripetal;
+		fy += ly * centripetal;
+		fz += (lz * centripetalCos - lx * rotSin) * centripetal;
+
+		//	Integration and rotation of direction and speed around the vertical axis
+		const float accScale = dt / m;
+		float nvx = vx[i] + fx * accScale;
+		float nvy = vy[i] + fy * accScale;
+		float nvz = vz[i] + fz * accScale;
+		px[i] += nvx * dt;
+		py[i] += nvy * dt;
+		pz[i] += nvz * dt;
+		const float angle = angVel * dt;
+		const float c = std::cos(angle);
+		const float s = std::sin(angle);
+		const float ndx = dx[i] * c + dz[i] * s;
+		const float ndz = dz[i] * c - dx[i] * s;
+		const float dirInv = 1.0f / std::sqrt(ndx * ndx + dy[i] * dy[i] + ndz * ndz);
+		dx[i] = ndx * dirInv;
+		dy[i] = dy[i] * dirInv;
+		dz[i] = ndz * dirInv;
+		vx[i] = nvx * c + nvz * s;
+		vy[i] = nvy;
+		vz[i] = nvz * c - nvx * s;
+		gears[i] = gear;
+		turns[i] = turn;
+		angularVels[i] = angVel;
+	}
+}
+
+unsigned int VehicleSimulation::GetCount() const
+{
+	return activeCount;
+}
+
+unsigned int VehicleSimulation::GetSlotsCount() const
+{
+	return positionX.size();
+}
+
+glm::vec3 VehicleSimulation::GetPosition(unsigned int index) const
+{
+	return glm::vec3(positionX[index], positionY[index], positionZ[index]);
+}
+
+glm::vec3 VehicleSimulation::GetDirection(unsigned int index) const
+{
+	return glm::vec3(directionX[index], directionY[index], directionZ[index]);
+}
+
+glm::vec3 VehicleSimulation::GetSpeed(unsigned int index) const
+{
+	return glm::vec3(speedX[index], speedY[index], speedZ[index]);
+}
+
+float VehicleSimulation::GetTurnAngle(unsigned int index) const
+{
+	return turnAngle[index];
+}
+
+float VehicleSimulation::GetMaxTurnAngle(unsigned int index) const
+{
+	return maxTurnAngle[index];
+}
+
+float VehicleSimulation::GetAngularVelocity(unsigned int index) const
+{
+	return angularVel[index];
+}
+
+float VehicleSimulation::GetMass(unsigned int index) const
+{
+	return mass[index];
+}
+
+float VehicleSimulation::GetWheelsAxisDist(unsigned int index) const
+{
+	return wheelsAxisDist[index];
+}
+
+float VehicleSimulation::GetMaxTorque(unsigned int index) const
+{
+	return maxTorque[index];
+}
+
+float VehicleSimulation::GetDriveForce(unsigned int index) const
+{
+	return driveFactor[index] * gearRatio[index];
+}
+
+float VehicleSimulation::GetStepScale(unsigned int index) const
+{
+	return stepScales[index];
+}
+
+CarControls VehicleSimulation::GetControls(unsigned int index) const
+{
+	CarControls result;
+	result.forward = (controls[index] & FORWARD) != 0;
+	result.backward = (controls[index] & BACKWARD) != 0;
+	result.left = (controls[index] & LEFT) != 0;
+	result.right = (controls[index] & RIGHT) != 0;
+	result.brake = (controls[index] & BRAKE) != 0;
+	return result;
+}
+
+void VehicleSimulation::SetPosition(unsigned int index, const glm::vec3& position)
+{
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	positionZ[index] = position.z;
+}
+
+void VehicleSimulation::SetDirection(unsigned int index, const glm::vec3& direction)
+{
+	glm::vec3 dir = glm::length(direction) != 0.0f ? glm::normalize(direction) : glm::vec3(1.0f, 0.0f, 0.0f);
+	directionX[index] = dir.x;
+	directionY[index] = dir.y;
+	directionZ[index] = dir.z;
+}
+
+void VehicleSimulation::SetSpeed(unsigned int index, const glm::vec3& speed)
+{
+	speedX[index] = speed.x;
+	speedY[index] = speed.y;
+	speedZ[index] = speed.z;
+}
+
+void VehicleSimulation::SetGearRatio(unsigned int index, float ratio)
+{
+	gearRatio[index] = glm::abs(ratio);
+}
+
+void VehicleSimulation::SetControls(unsigned int index, const CarControls& controls)
+{
+	unsigned char flags = 0;
+	if (controls.forward) flags |= FORWARD;
+	if (controls.backward) flags |= BACKWARD;
+	if (controls.left) flags |= LEFT;
+	if (controls.right) flags |= RIGHT;
+	if (controls.brake) flags |= BRAKE;
+	this->controls[index] = flags;
+}
+
+void VehicleSimulation::SetStepScale(unsigned int index, float scale)
+{
+	stepScales[index] = glm::max(scale, 0.0f);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#define _USE_MATH_DEFINES
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+
+#define GEAR_RATIO_1 2.66f
+#define GEAR_RATIO_2 1.78f
+#define GEAR_RATIO_3 1.30f
+#define GEAR_RATIO_4 1.0f
+#define GEAR_RATIO_5 0.74f
+#define GEAR_RATIO_6 0.50f
+#define GEAR_RATIO_R 2.90f
+
+struct CarControls
+{
+	bool forward = false;
+	bool backward = false;
+	bool left = false;
+	bool right = false;
+	bool brake = false;
+};
+
+struct VehicleParams
+{
+	float mass;
+	float wheelsAxisDist;
+	float wheelsRadius;
+	float diffRatio;
+	float transEfficiency;
+	float maxTorque;
+	float gearRatio;
+	float maxTurnAngle;
+	VehicleParams();
+};
+
+class VehicleSimulation
+{
+private:
+	enum ControlFlags : unsigned char
+	{
+		FORWARD = 1, BACKWARD = 2, LEFT = 4, RIGHT = 8, BRAKE = 16
+	};
+	unsigned int activeCount;
+	std::vector<unsigned int> freeSlots;
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+	std::vector<float> directionX;
+	std::vector<float> directionY;
+	std::vector<float> directionZ;
+	std::vector<float> speedX;
+	std::vector<float> speedY;
+	std::vector<float> speedZ;
+	std::vector<float> mass;
+	std::vector<float> wheelsAxisDist;
+	std::vector<float> driveFactor;
+	std::vector<float> gearRatio;
+	std::vector<float> maxTorque;
+	std::vector<float> maxTurnAngle;
+	std::vector<float> turnAngle;
+	std::vector<float> angularVel;
+	std::vector<float> stepScales;
+	std::vector<unsigned char> controls;
+public:
+	VehicleSimulation();
+	void Reserve(unsigned int capacity);
+	unsigned int Add(const glm::vec3& position, const glm::vec3& direction, const glm::vec3& speed, const VehicleParams& params);
+	void Remove(unsigned int index);
+	void Update(float dTime);
+	void Update(float dTime, unsigned int begin, unsigned int end);
+	unsigned int GetCount() const;
+	unsigned int GetSlotsCount() const;
+	glm::vec3 GetPosition(unsigned int index) const;
+	glm::vec3 GetDirection(unsigned int index) const;
+	glm::vec3 GetSpeed(unsigned int index) const;
+	float GetTurnAngle(unsigned int index) const;
+	float GetMaxTurnAngle(unsigned int index) const;
+	float GetAngularVelocity(unsigned int index) const;
+	float GetMass(unsigned int index) const;
+	float GetWheelsAxisDist(unsigned int index) const;
+	float GetMaxTorque(unsigned int index) const;
+	float GetDriveForce(unsigned int index) const;
+	float GetStepScale(unsigned int index) const;
+	CarControls GetControls(unsigned int index) const;
+	void SetPosition(unsigned int index, const glm::vec3& position);
+	void SetDirection(unsigned int index, const glm::vec3& direction);
+	void SetSpeed(unsigned int index, const glm::vec3& speed);
+	void SetGearRatio(unsigned int index, float ratio);
+	void SetControls(unsigned int index, const CarControls& controls);
+	void SetStepScale(unsigned int index, float scale);
+};
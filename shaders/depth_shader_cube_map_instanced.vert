@@ -0,0 +1,14 @@
+#version 450 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec2 aTextureCoords;
+layout(location = 5) in mat4 aModel;
+
+uniform mat4 model;
+out vec2 TextureCoords;
+
+void main()
+{
+	gl_Position = aModel * model * vec4(aPos, 1.0f);
+	TextureCoords = aTextureCoords;
+}
\ No newline at end of file
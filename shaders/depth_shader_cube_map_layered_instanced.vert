@@ -0,0 +1,27 @@
+#version 450 core
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec2 aTextureCoords;
+layout(location = 5) in mat4 aModel;
+//	Depth passes don't use the normal matrix, its slot holds the cube face of the instance
+layout(location = 9) in vec4 aFace;
+
+out VS_OUT
+{
+	vec4 FragPos;
+	vec2 TextureCoords;
+}vs_out;
+
+uniform mat4 lightSpaceMatrices[6];
+uniform mat4 model;
+
+void main()
+{
+	int face = int(aFace.x);
+	vs_out.FragPos = aModel * model * vec4(aPos, 1.0f);
+	vs_out.TextureCoords = aTextureCoords;
+	gl_Position = lightSpaceMatrices[face] * vs_out.FragPos;
+	gl_Layer = face;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 450 core
+layout(location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTextureCoords;
+layout(location = 5) in mat4 aModel;
+
+out VS_OUT
+{
+	vec4 FragPos;
+	vec2 TextureCoords;
+}vs_out;
+
+uniform mat4 lightSpaceMatrix;
+uniform mat4 model;
+
+void main()
+{
+	vs_out.FragPos = aModel * model * vec4(aPos, 1.0f);
+	vs_out.TextureCoords = aTextureCoords;
+	gl_Position = lightSpaceMatrix * vs_out.FragPos;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#version 430 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 textureCoords;
+
+struct Particle
+{
+	vec4 positionAge;
+	vec4 velocity;
+};
+
+layout(std430, binding = 0) readonly buffer Particles
+{
+	Particle particles[];
+};
+
+layout(std430, binding = 2) readonly buffer AliveIndices
+{
+	uint aliveIndices[];
+};
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TextureCoords;
+uniform mat4 model;
+uniform mat4 normalMatrix;
+uniform mat4 spaceMatrix;
+
+void main()
+{
+	//	Every instance is one live particle, the model matrix only carries its scale and orientation
+	vec3 particlePos = particles[aliveIndices[gl_InstanceID]].positionAge.xyz;
+	FragPos = vec3(model * vec4(aPos, 1.0f)) + particlePos;
+	gl_Position = spaceMatrix * vec4(FragPos, 1.0f);
+	Normal = mat3(normalMatrix) * normal;
+	TextureCoords = textureCoords;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 const int NR_DIR_LIGHTS = 1;
 const int NR_POINT_LIGHTS = 4;
 const int NR_SPOT_LIGHTS = 8;
+const int NR_CASCADES = 4;
 
 const uint DL_TYPE = 0x00000001u;
 const uint PL_TYPE = 0x00000002u;
@@ -15,7 +16,6 @@ in VS_OUT
 {
 	vec3 Normal;
 	vec3 FragPos;
-	vec4 FragPosDLightSpaces[NR_DIR_LIGHTS];
 	vec4 FragPosSLightSpaces[NR_SPOT_LIGHTS];
 	vec2 TextureCoords;
 }fs_in;
@@ -87,19 +87,32 @@ layout (shared, binding = 0) uniform DirLightsInfo
 	SpotLight spotLights[NR_SPOT_LIGHTS];
 };
 
-uniform vec3 viewPos;
+layout (shared, binding = 1) uniform FrameInfo
+{
+	mat4 view;
+	mat4 projection;
+	mat4 spaceMatrix;	//	Proj * View
+	vec3 viewPos;
+	mat4 cascadeMatrices[NR_CASCADES];	//	Proj * View
+	vec4 cascadeSplits;	//	Far view distance of each cascade
+	mat4 sLightSpaceMatrix[NR_SPOT_LIGHTS];	//	Proj * View
+	vec4 sLightShadowRects[NR_SPOT_LIGHTS];
+};
+
 uniform Material material;
 uniform samplerCube skybox;
 uniform bool hasSkybox;
-uniform sampler2D dLightShadowMaps[NR_DIR_LIGHTS];
+uniform sampler2D shadowAtlas;
+uniform sampler2DArray dLightCascades;
 uniform samplerCube pLightShadowMaps[2];
-uniform sampler2D sLightShadowMaps[NR_SPOT_LIGHTS];
 uniform float pLightFarPlane[2];
 
 vec4 CalcDirLight(int lightIndex, vec3 normal, vec3 viewDir);
 vec4 CalcPointLight(int lightIndex, vec3 normal, vec3 viewDir);
 vec4 CalcSpotLight(int lightIndex, vec3 normal, vec3 viewDir);
 float CalcShadow(vec4 fragPos, vec3 normal, vec3 lightDir, uint SourceType, int lightIndex);
+float CalcAtlasShadow(vec4 fragPos, vec4 tileRect, float bias);
+float CalcCascadeShadow(vec3 fragPos, float bias);
 
 vec3 sampleOffsetDirections[CubeShadowMapSamples] = vec3[]
 (
@@ -199,7 +212,7 @@ vec4 CalcDirLight(int lightIndex, vec3 normal, vec3 viewDir)
 	//	specular
 	vec4 specular = vec4(pow(max(dot(normal, halfWayDir), 0.0), activeMat.shininess) * dirLights[i].specular, 1.0f) * activeMat.specular;
 	//	shadow
-	float shadow = CalcShadow(fs_in.FragPosDLightSpaces[lightIndex], normal, lightDir, DL_TYPE, lightIndex);
+	float shadow = CalcShadow(vec4(fs_in.FragPos, 1.0f), normal, lightDir, DL_TYPE, lightIndex);
 
 	return ambient + (diffuse + specular) * (1.0f - shadow);
 }
@@ -257,19 +270,7 @@ float CalcShadow(vec4 fragPos, vec3 normal, vec3 lightDir, uint SourceType, int
 	{
 		case DL_TYPE:
 		{
-			vec3 projCoords = fragPos.xyz / fragPos.w;
-			projCoords = projCoords * 0.5f + 0.5f;
-			if (projCoords.z > 1.0f) return 0.0;
-			float currentDepth = projCoords.z;
-
-			vec2 texelSize = 1.0f / textureSize(dLightShadowMaps[lightIndex], 0);
-			for (int x = -1; x <= 1; ++x)
-				for (int y = -1; y <= 1; ++y)
-				{
-					float pcfDepth = texture(dLightShadowMaps[lightIndex], projCoords.xy + vec2(x, y) * texelSize).r;
-					shadow +=  currentDepth - bias > pcfDepth ? 1.0f : 0.0f;
-				}
-			return shadow / 9.0f;
+			return CalcCascadeShadow(fragPos.xyz, bias);
 		}; break;
 		case PL_TYPE:
 		{
@@ -289,20 +290,66 @@ float CalcShadow(vec4 fragPos, vec3 normal, vec3 lightDir, uint SourceType, int
 		}; break;
 		case SL_TYPE:
 		{
-			vec3 projCoords = fragPos.xyz / fragPos.w;
-			projCoords = projCoords * 0.5f + 0.5f;
-			if (projCoords.z > 1.0f) return 0.0;
-			float currentDepth = projCoords.z;
-
-			vec2 texelSize = 1.0f / textureSize(sLightShadowMaps[lightIndex], 0);
-			for (int x = -1; x <= 1; ++x)
-			for (int y = -1; y <= 1; ++y)
-			{
-				float pcfDepth = texture(sLightShadowMaps[lightIndex], projCoords.xy + vec2(x, y) * texelSize).r;
-				shadow +=  currentDepth - bias > pcfDepth ? 1.0f : 0.0f;
-			}
-			return shadow / 9.0f;
+			return CalcAtlasShadow(fragPos, sLightShadowRects[lightIndex], bias);
 		}; break;		
 	};
 	return 0.0;
+}
+
+float CalcAtlasShadow(vec4 fragPos, vec4 tileRect, float bias)
+{
+	vec3 projCoords = fragPos.xyz / fragPos.w;
+	projCoords = projCoords * 0.5f + 0.5f;
+	if (projCoords.z > 1.0f) return 0.0;
+	//	Outside of the light frustum there is no shadow (as with the old clamp-to-border maps)
+	if (any(lessThan(projCoords.xy, vec2(0.0f))) || any(greaterThan(projCoords.xy, vec2(1.0f)))) return 0.0;
+	float currentDepth = projCoords.z;
+	float shadow = 0.0f;
+
+	//	PCF taps are kept inside the tile so neighbouring maps don't bleed in
+	vec2 texelSize = 1.0f / textureSize(shadowAtlas, 0);
+	vec2 tileMin = tileRect.xy + texelSize * 0.5f;
+	vec2 tileMax = tileRect.xy + tileRect.zw - texelSize * 0.5f;
+	vec2 atlasCoords = tileRect.xy + projCoords.xy * tileRect.zw;
+	for (int x = -1; x <= 1; ++x)
+		for (int y = -1; y <= 1; ++y)
+		{
+			float pcfDepth = texture(shadowAtlas, clamp(atlasCoords + vec2(x, y) * texelSize, tileMin, tileMax)).r;
+			shadow +=  currentDepth - bias > pcfDepth ? 1.0f : 0.0f;
+		}
+	return shadow / 9.0f;
+}
+
+float CalcCascadeShadow(vec3 fragPos, float bias)
+{
+	//	Cascade is picked by the view distance of the fragment
+	float viewDepth = -(view * vec4(fragPos, 1.0f)).z;
+	int cascade = -1;
+	for (int i = 0; i < NR_CASCADES; i++)
+	{
+		if (viewDepth < cascadeSplits[i])
+		{
+			cascade = i;
+			break;
+		}
+	}
+	//	No shadows past the last cascade
+	if (cascade < 0) return 0.0;
+	vec4 lightSpacePos = cascadeMatrices[cascade] * vec4(fragPos, 1.0f);
+	vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
+	projCoords = projCoords * 0.5f + 0.5f;
+	if (projCoords.z > 1.0f) return 0.0;
+	float currentDepth = projCoords.z;
+	float shadow = 0.0f;
+
+	//	Farther cascades cover more ground per texel and need a larger bias
+	bias *= 1.0f + float(cascade);
+	vec2 texelSize = 1.0f / vec2(textureSize(dLightCascades, 0).xy);
+	for (int x = -1; x <= 1; ++x)
+		for (int y = -1; y <= 1; ++y)
+		{
+			float pcfDepth = texture(dLightCascades, vec3(projCoords.xy + vec2(x, y) * texelSize, float(cascade))).r;
+			shadow += currentDepth - bias > pcfDepth ? 1.0f : 0.0f;
+		}
+	return shadow / 9.0f;
 }
\ No newline at end of file
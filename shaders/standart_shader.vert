@@ -3,46 +3,56 @@
 #define NR_DIR_LIGHTS 1
 #define NR_POINT_LIGHTS 4
 #define NR_SPOT_LIGHTS 8
+#define NR_CASCADES 4
 
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTextureCoords;
 layout(location = 3) in vec3 aTangent;
-layout(location = 4) in vec3 aBitangent;
+layout(location = 4) in vec3 aBitangent;	//	Absent in packed vertices
 
 out VS_OUT
 {
 	vec3 Normal;
 	vec3 FragPos;
-	vec4 FragPosDLightSpaces[NR_DIR_LIGHTS];
 	vec4 FragPosSLightSpaces[NR_SPOT_LIGHTS];
 	vec2 TextureCoords;
 }vs_out;
 
+layout (shared, binding = 1) uniform FrameInfo
+{
+	mat4 view;
+	mat4 projection;
+	mat4 spaceMatrix;	//	Proj * View
+	vec3 viewPos;
+	mat4 cascadeMatrices[NR_CASCADES];	//	Proj * View
+	vec4 cascadeSplits;	//	Far view distance of each cascade
+	mat4 sLightSpaceMatrix[NR_SPOT_LIGHTS];	//	Proj * View
+	vec4 sLightShadowRects[NR_SPOT_LIGHTS];
+};
+
 uniform mat4 model;
 uniform mat4 normalMatrix;	//	Inversed and Transpossed Model Matrix
-uniform mat4 dLightSpaceMatrix[NR_DIR_LIGHTS];	//	Proj * View
-uniform mat4 sLightSpaceMatrix[NR_SPOT_LIGHTS];	//	Proj * View
-uniform mat4 finalMatrix; //	Proj * View * model
+uniform bool packedVertices;	//	Octahedral normal and tangent, bitangent sign in the tangent
+
+vec3 DecodeOctahedral(vec2 e)
+{
+	vec3 v = vec3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	if (v.z < 0.0f)
+		v.xy = (1.0f - abs(v.yx)) * vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+	return normalize(v);
+}
 
 void main()
 {
-	gl_Position = finalMatrix * vec4(aPos , 1.0f);
 	vs_out.FragPos = vec3(model * vec4(aPos, 1.0f));
-	for (int i = 0; i < NR_DIR_LIGHTS; i++)
-	{
-		vs_out.FragPosDLightSpaces[i] = dLightSpaceMatrix[i] * vec4(vs_out.FragPos, 1.0f);
-	}
+	gl_Position = spaceMatrix * vec4(vs_out.FragPos, 1.0f);
 	for (int i = 0; i < NR_SPOT_LIGHTS; i++)
 	{
 		vs_out.FragPosSLightSpaces[i] = sLightSpaceMatrix[i] * vec4(vs_out.FragPos, 1.0f);
 	}
-	vs_out.Normal = mat3(normalMatrix) * aNormal;
+	//	Tangents are packed for normal mapping, the lighting uses only the normal so far
+	vec3 normal = packedVertices ? DecodeOctahedral(aNormal.xy) : aNormal;
+	vs_out.Normal = mat3(normalMatrix) * normal;
 	vs_out.TextureCoords = aTextureCoords;
-
-	vec3 T = normalize(vec3(normalMatrix * vec4(aTangent, 0.0f)));
-	vec3 B = normalize(vec3(normalMatrix * vec4(aBitangent, 0.0f)));
-	vec3 N = normalize(vec3(normalMatrix * vec4(aNormal, 0.0f)));
-
-	mat3 TBN = mat3(T, B, N);
 }
\ No newline at end of file
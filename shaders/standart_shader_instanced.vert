@@ -0,0 +1,61 @@
+#version 450 core
+
+#define NR_DIR_LIGHTS 1
+#define NR_POINT_LIGHTS 4
+#define NR_SPOT_LIGHTS 8
+#define NR_CASCADES 4
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTextureCoords;
+layout(location = 3) in vec3 aTangent;
+layout(location = 4) in vec3 aBitangent;	//	Absent in packed vertices
+layout(location = 5) in mat4 aModel;
+layout(location = 9) in mat4 aNormalMatrix;
+
+out VS_OUT
+{
+	vec3 Normal;
+	vec3 FragPos;
+	vec4 FragPosSLightSpaces[NR_SPOT_LIGHTS];
+	vec2 TextureCoords;
+}vs_out;
+
+layout (shared, binding = 1) uniform FrameInfo
+{
+	mat4 view;
+	mat4 projection;
+	mat4 spaceMatrix;	//	Proj * View
+	vec3 viewPos;
+	mat4 cascadeMatrices[NR_CASCADES];	//	Proj * View
+	vec4 cascadeSplits;	//	Far view distance of each cascade
+	mat4 sLightSpaceMatrix[NR_SPOT_LIGHTS];	//	Proj * View
+	vec4 sLightShadowRects[NR_SPOT_LIGHTS];
+};
+
+uniform mat4 model;	//	Mesh local matrix, instance matrix is applied on top of it
+uniform mat4 normalMatrix;	//	Inversed and Transpossed Mesh Local Matrix
+uniform bool packedVertices;	//	Octahedral normal and tangent, bitangent sign in the tangent
+
+vec3 DecodeOctahedral(vec2 e)
+{
+	vec3 v = vec3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	if (v.z < 0.0f)
+		v.xy = (1.0f - abs(v.yx)) * vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+	return normalize(v);
+}
+
+void main()
+{
+	mat4 instanceModel = aModel * model;
+	mat4 instanceNormal = aNormalMatrix * normalMatrix;
+	vs_out.FragPos = vec3(instanceModel * vec4(aPos, 1.0f));
+	gl_Position = spaceMatrix * vec4(vs_out.FragPos, 1.0f);
+	for (int i = 0; i < NR_SPOT_LIGHTS; i++)
+	{
+		vs_out.FragPosSLightSpaces[i] = sLightSpaceMatrix[i] * vec4(vs_out.FragPos, 1.0f);
+	}
+	vec3 normal = packedVertices ? DecodeOctahedral(aNormal.xy) : aNormal;
+	vs_out.Normal = mat3(instanceNormal) * normal;
+	vs_out.TextureCoords = aTextureCoords;
+}
\ No newline at end of file
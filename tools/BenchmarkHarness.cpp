@@ -0,0 +1,46 @@
+#include "BenchmarkHarness.h"
+#include <sstream>
+
+StepTimes::StepTimes()
+{
+	total = 0.0;
+	max = 0.0;
+	count = 0;
+}
+
+double StepTimes::GetAverage() const
+{
+	return count > 0 ? total / count : 0.0;
+}
+
+float BenchmarkHarness::Random(float min, float max)
+{
+	//	rand keeps the runs of every benchmark reproducible with srand of the run size
+	return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+std::string BenchmarkHarness::Cell(double value, int precision)
+{
+	std::ostringstream stream;
+	stream << std::fixed << std::setprecision(precision) << value;
+	return stream.str();
+}
+
+void BenchmarkHarness::PrintHeader(const std::vector<TableColumn>& columns)
+{
+	for (int i = 0; i < columns.size(); i++)
+	{
+		std::cout << std::setw(columns[i].width) << columns[i].name;
+	}
+	std::cout << std::endl;
+}
+
+void BenchmarkHarness::PrintRow(const std::vector<TableColumn>& columns, const std::vector<std::string>& cells)
+{
+	//	Cells are formatted by the caller, the table only keeps them under their headers
+	for (int i = 0; i < columns.size() && i < cells.size(); i++)
+	{
+		std::cout << std::setw(columns[i].width) << cells[i];
+	}
+	std::cout << std::endl;
+}
\ No newline at end of file
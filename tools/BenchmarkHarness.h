@@ -0,0 +1,51 @@
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+struct StepTimes
+{
+	double total;
+	double max;
+	int count;
+	StepTimes();
+	double GetAverage() const;
+};
+
+struct TableColumn
+{
+	std::string name;
+	int width;
+};
+
+class BenchmarkHarness
+{
+public:
+	static float Random(float min, float max);
+	static std::string Cell(double value, int precision);
+	static void PrintHeader(const std::vector<TableColumn>& columns);
+	static void PrintRow(const std::vector<TableColumn>& columns, const std::vector<std::string>& cells);
+	template<typename Setup, typename Body, typename Check>
+	static StepTimes RunSteps(int warmupSteps, int measuredSteps, Setup setup, Body body, Check check)
+	{
+		StepTimes times;
+		times.count = measuredSteps;
+		for (int step = 0; step < warmupSteps + measuredSteps; step++)
+		{
+			setup(step);
+			auto start = std::chrono::steady_clock::now();
+			body(step);
+			auto end = std::chrono::steady_clock::now();
+			bool measured = step >= warmupSteps;
+			check(step, measured);
+			if (!measured) continue;
+			double time = std::chrono::duration<double, std::milli>(end - start).count();
+			times.total += time;
+			if (time > times.max) times.max = time;
+		}
+		return times;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "../../VehicleSimulation.h"
+#include "../../CollisionSystem.h"
+#include "../BenchmarkHarness.h"
+
+//	Synthetic traffic for the car collision pass: cars in six lanes, three per direction,
+//	with uneven throttle and lane changes so that the sweep sees bunching and contacts.
+//	Reports the time of CollisionSystem::Update per step, how many pairs reach the narrow phase
+//	compared to all pairs, and the number of heap allocations made while measuring.
+
+namespace
+{
+	std::atomic<unsigned long long> allocationsCount(0);
+
+	const float dTime = 1.0f / 120.0f;
+	const int warmupSteps = 120;
+	const int measuredSteps = 600;
+	const float laneWidth = 3.5f;
+	const float carsSpacing = 12.0f;
+
+	CarControls ScriptedControls(unsigned int index, int step)
+	{
+		CarControls controls;
+		int phase = (step / 90 + index * 7) % 10;
+		controls.forward = phase < 7 || index % 3 == 0;
+		controls.brake = phase == 9 && index % 4 == 1;
+		controls.left = phase == 7 && index % 5 == 2;
+		controls.right = phase == 8 && index % 5 == 2;
+		return controls;
+	}
+
+	const std::vector<TableColumn> columns = {
+		{ "cars", 8 }, { "step, ms", 12 }, { "narrow pairs", 14 }, { "all pairs", 14 }, { "contacts", 12 }, { "allocations", 14 }
+	};
+
+	void Run(unsigned int count)
+	{
+		srand(count);
+		VehicleParams params;
+		VehicleSimulation simulation;
+		CollisionSystem collisions;
+		simulation.Reserve(count);
+		collisions.Reserve(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			int lane = i % 6;
+			float side = lane < 3 ? 1.0f : -1.0f;
+			glm::vec3 position = glm::vec3((i / 6) * carsSpacing * side + BenchmarkHarness::Random(-3.0f, 3.0f), 0.0f,
+				side * (laneWidth * 0.5f + laneWidth * (lane % 3)));
+			glm::vec3 direction = glm::vec3(side, 0.0f, 0.0f);
+			glm::vec3 speed = direction * BenchmarkHarness::Random(10.0f, 25.0f);
+			simulation.Add(position, direction, speed, params);
+			collisions.AddBody(i, glm::vec3(2.1f, 0.7f, 0.85f), glm::vec3(0.0f, 0.7f, 0.0f));
+		}
+		unsigned long long pairsTested = 0;
+		unsigned long long contacts = 0;
+		unsigned long long allocations = 0;
+		unsigned long long allocationsBefore = 0;
+		StepTimes times = BenchmarkHarness::RunSteps(warmupSteps, measuredSteps, [&](int step)
+		{
+			for (unsigned int i = 0; i < count; i++)
+				simulation.SetControls(i, ScriptedControls(i, step));
+			simulation.Update(dTime);
+			allocationsBefore = allocationsCount;
+		}, [&](int step)
+		{
+			collisions.Update(simulation);
+		}, [&](int step, bool measured)
+		{
+			if (!measured) return;
+			allocations += allocationsCount - allocationsBefore;
+			pairsTested += collisions.GetStats().pairsTested;
+			contacts += collisions.GetStats().contactsCount;
+		});
+		double allPairs = (double)count * (count - 1) / 2.0;
+		BenchmarkHarness::PrintRow(columns, { std::to_string(count), BenchmarkHarness::Cell(times.GetAverage(), 4),
+			BenchmarkHarness::Cell((double)pairsTested / measuredSteps, 1), BenchmarkHarness::Cell(allPairs, 1),
+			BenchmarkHarness::Cell((double)contacts / measuredSteps, 1), std::to_string(allocations) });
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	allocationsCount++;
+	void* memory = std::malloc(size > 0 ? size : 1);
+	if (memory == NULL) throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+int main()
+{
+	const unsigned int counts[4] = { 100, 500, 1000, 5000 };
+	BenchmarkHarness::PrintHeader(columns);
+	for (int i = 0; i < 4; i++)
+	{
+		Run(counts[i]);
+	}
+	return 0;
+}
\ No newline at end of file
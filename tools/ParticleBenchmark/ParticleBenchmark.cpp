@@ -0,0 +1,141 @@
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <string>
+#include "../../ParticlePool.h"
+#include "../BenchmarkHarness.h"
+
+//	Simulation-only comparison of the old object-per-particle system with ParticlePool.
+//	Both spawn at a rate that keeps the pool at its capacity with the game's 5 second lifetime,
+//	run until the population settles and then time the update of every frame.
+
+namespace
+{
+	const double dTime = 1.0 / 60.0;
+	const float lifetime = 5.0f;
+	const int warmupFrames = 360;
+	const int measuredFrames = 240;
+
+	//	Same layout as the former ParticleSystem::Particle: an Object with its light map, forces and vtable
+	class LegacyObject
+	{
+	protected:
+		glm::vec3 position;
+		glm::dvec3 speed;
+		glm::vec3 direction;
+		glm::vec3 up;
+		glm::vec3 scale;
+		std::map<std::string, void*> lights;
+		std::vector<glm::dvec3> forces;
+		void* model;
+	public:
+		LegacyObject(glm::vec3 position) : position(position), speed(0.0), direction(1.0f, 0.0f, 0.0f),
+			up(0.0f, 1.0f, 0.0f), scale(1.0f), model(NULL) {}
+		virtual ~LegacyObject() {}
+		virtual void Update(double dTime) {}
+	};
+
+	class LegacyParticle : public LegacyObject
+	{
+	private:
+		glm::dvec3 acceleration;
+		float opacity;
+		float lifetime;
+		double elapsedTime;
+		bool alive;
+	public:
+		LegacyParticle(glm::vec3 position, glm::vec3 acceleration, float lifetime) : LegacyObject(position),
+			acceleration(acceleration), opacity(1.0f), lifetime(lifetime), elapsedTime(0.0), alive(true) {}
+		virtual void Update(double dTime) override
+		{
+			elapsedTime += dTime;
+			if (elapsedTime >= lifetime)
+			{
+				alive = false;
+				return;
+			}
+			speed += acceleration * dTime;
+			position += glm::vec3(speed * dTime);
+		}
+		bool IsAlive() { return alive; }
+	};
+
+	glm::vec3 RandomOffset()
+	{
+		return glm::vec3(BenchmarkHarness::Random(-6.0f, 6.0f), 0.0f, BenchmarkHarness::Random(-6.0f, 6.0f));
+	}
+
+	//	Former ParticleSystem::Update: new per spawn, erase from the middle and from the front of the vector.
+	//	Dead particles are deleted here, the original leaked them.
+	double RunLegacy(unsigned int maxCount, unsigned int spawnPerFrame)
+	{
+		std::vector<LegacyParticle*> particles;
+		glm::vec3 acceleration(0.0f, -2.0f, 0.0f);
+		StepTimes times = BenchmarkHarness::RunSteps(warmupFrames, measuredFrames, [](int frame) {}, [&](int frame)
+		{
+			for (unsigned int i = 0; i < spawnPerFrame; i++)
+			{
+				particles.push_back(new LegacyParticle(RandomOffset(), acceleration, lifetime));
+			}
+			for (auto it = particles.begin(); it != particles.end();)
+			{
+				if (!(*it)->IsAlive())
+				{
+					delete* it;
+					it = particles.erase(it);
+				}
+				else it++;
+			}
+			if (particles.size() > maxCount)
+			{
+				for (size_t i = 0; i < particles.size() - maxCount; i++)
+					delete particles[i];
+				particles.erase(particles.begin(), particles.begin() + (particles.size() - maxCount));
+			}
+			for (auto it = particles.begin(); it != particles.end(); it++)
+			{
+				(*it)->Update(dTime);
+			}
+		}, [](int frame, bool measured) {});
+		for (int i = 0; i < particles.size(); i++)
+			delete particles[i];
+		return times.GetAverage();
+	}
+
+	double RunPool(unsigned int maxCount, unsigned int spawnPerFrame)
+	{
+		ParticlePool pool(maxCount, lifetime);
+		glm::vec3 acceleration(0.0f, -2.0f, 0.0f);
+		StepTimes times = BenchmarkHarness::RunSteps(warmupFrames, measuredFrames, [](int frame) {}, [&](int frame)
+		{
+			for (unsigned int i = 0; i < spawnPerFrame; i++)
+			{
+				if (!pool.Spawn(RandomOffset(), glm::vec3(0.0f)))
+					break;
+			}
+			pool.Update(dTime, acceleration);
+		}, [](int frame, bool measured) {});
+		return times.GetAverage();
+	}
+}
+
+int main()
+{
+	const unsigned int counts[3] = { 600, 10000, 100000 };
+	const std::vector<TableColumn> columns = {
+		{ "particles", 10 }, { "legacy, ms", 14 }, { "pool, ms", 14 }, { "speedup", 10 }
+	};
+	BenchmarkHarness::PrintHeader(columns);
+	for (int i = 0; i < 3; i++)
+	{
+		unsigned int spawnPerFrame = (unsigned int)(counts[i] / (lifetime / dTime)) + 1;
+		srand(1);
+		double legacy = RunLegacy(counts[i], spawnPerFrame);
+		srand(1);
+		double pool = RunPool(counts[i], spawnPerFrame);
+		BenchmarkHarness::PrintRow(columns, { std::to_string(counts[i]), BenchmarkHarness::Cell(legacy, 3),
+			BenchmarkHarness::Cell(pool, 3), BenchmarkHarness::Cell(legacy / pool, 1) + "x" });
+	}
+	return 0;
+}
@@ -0,0 +1,280 @@
+#include "BlockCompression.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+//	Colour blocks take their endpoints from the principal axis of the block's colours,
+//	channel blocks (BC3 alpha, BC5 red and green) from the channel's range.
+//	Both always use the interpolated mode, so no texel ends up punched through.
+
+static uint16_t PackColor565(const float* color)
+{
+	int r = std::clamp((int)std::round(color[0] * 31.0f / 255.0f), 0, 31);
+	int g = std::clamp((int)std::round(color[1] * 63.0f / 255.0f), 0, 63);
+	int b = std::clamp((int)std::round(color[2] * 31.0f / 255.0f), 0, 31);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackColor565(uint16_t packed, int* color)
+{
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+void BlockCompression::EncodeColorBlock(const unsigned char* block, unsigned char* out)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+			mean[c] += block[i * 4 + c] / 16.0f;
+	}
+	//	Covariance: xx, xy, xz, yy, yz, zz
+	float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float d[3] = { block[i * 4] - mean[0], block[i * 4 + 1] - mean[1], block[i * 4 + 2] - mean[2] };
+		cov[0] += d[0] * d[0];
+		cov[1] += d[0] * d[1];
+		cov[2] += d[0] * d[2];
+		cov[3] += d[1] * d[1];
+		cov[4] += d[1] * d[2];
+		cov[5] += d[2] * d[2];
+	}
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int i = 0; i < 8; i++)
+	{
+		float next[3] = {
+			cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+			cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+			cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+		};
+		float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+		if (length < 1e-6f)
+			break;
+		for (int c = 0; c < 3; c++)
+			axis[c] = next[c] / length;
+	}
+	float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	for (int c = 0; c < 3; c++)
+		axis[c] /= axisLength;
+	float minProj = 0.0f, maxProj = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float proj = 0.0f;
+		for (int c = 0; c < 3; c++)
+			proj += (block[i * 4 + c] - mean[c]) * axis[c];
+		minProj = std::min(minProj, proj);
+		maxProj = std::max(maxProj, proj);
+	}
+	//	Endpoints are pulled in slightly, the extremes are rarely worth a full palette step
+	float inset = (maxProj - minProj) / 16.0f;
+	float end0[3], end1[3];
+	for (int c = 0; c < 3; c++)
+	{
+		end0[c] = mean[c] + axis[c] * (maxProj - inset);
+		end1[c] = mean[c] + axis[c] * (minProj + inset);
+	}
+	uint16_t color0 = PackColor565(end0);
+	uint16_t color1 = PackColor565(end1);
+	if (color0 < color1)
+		std::swap(color0, color1);
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		int palette[4][3];
+		UnpackColor565(color0, palette[0]);
+		UnpackColor565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0;
+			int bestError = INT32_MAX;
+			for (int j = 0; j < 4; j++)
+			{
+				int error = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					int d = block[i * 4 + c] - palette[j][c];
+					error += d * d;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					best = j;
+				}
+			}
+			indices |= (uint32_t)best << (2 * i);
+		}
+	}
+	out[0] = color0 & 0xFF;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xFF;
+	out[3] = color1 >> 8;
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+void BlockCompression::EncodeChannelBlock(const unsigned char* block, int channel, unsigned char* out)
+{
+	int minValue = 255, maxValue = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		minValue = std::min(minValue, (int)block[i * 4 + channel]);
+		maxValue = std::max(maxValue, (int)block[i * 4 + channel]);
+	}
+	uint64_t indices = 0;
+	if (maxValue > minValue)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			//	Step 0 is the first endpoint, step 7 the second, steps in between are indices 2..7
+			int step = (int)std::round((maxValue - block[i * 4 + channel]) * 7.0f / (maxValue - minValue));
+			int index = step == 0 ? 0 : (step == 7 ? 1 : step + 1);
+			indices |= (uint64_t)index << (3 * i);
+		}
+	}
+	out[0] = maxValue;
+	out[1] = minValue;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+unsigned int BlockCompression::GetBlockSize(BlockFormat format)
+{
+	return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+unsigned int BlockCompression::GetInternalFormat(BlockFormat format)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+	}
+	return 0;
+}
+
+unsigned int BlockCompression::GetBaseInternalFormat(BlockFormat format)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1: return GL_RGB;
+	case BlockFormat::BC3: return GL_RGBA;
+	case BlockFormat::BC5: return GL_RG;
+	}
+	return 0;
+}
+
+const char* BlockCompression::GetFormatName(BlockFormat format)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1: return "BC1";
+	case BlockFormat::BC3: return "BC3";
+	case BlockFormat::BC5: return "BC5";
+	}
+	return "";
+}
+
+std::vector<unsigned char> BlockCompression::Compress(const std::vector<unsigned char>& rgba, int width, int height, BlockFormat format)
+{
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	unsigned int blockSize = GetBlockSize(format);
+	std::vector<unsigned char> result(blocksX * blocksY * blockSize);
+	unsigned char block[64];
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			//	Blocks on the border of non multiple of 4 images repeat the last row and column
+			for (int y = 0; y < 4; y++)
+			{
+				for (int x = 0; x < 4; x++)
+				{
+					int px = std::min(bx * 4 + x, width - 1);
+					int py = std::min(by * 4 + y, height - 1);
+					for (int c = 0; c < 4; c++)
+						block[(y * 4 + x) * 4 + c] = rgba[(py * width + px) * 4 + c];
+				}
+			}
+			unsigned char* out = &result[(by * blocksX + bx) * blockSize];
+			switch (format)
+			{
+			case BlockFormat::BC1:
+			{
+				EncodeColorBlock(block, out);
+			}; break;
+			case BlockFormat::BC3:
+			{
+				EncodeChannelBlock(block, 3, out);
+				EncodeColorBlock(block, out + 8);
+			}; break;
+			case BlockFormat::BC5:
+			{
+				EncodeChannelBlock(block, 0, out);
+				EncodeChannelBlock(block, 1, out + 8);
+			}; break;
+			}
+		}
+	}
+	return result;
+}
+
+std::vector<unsigned char> BlockCompression::Downsample(const std::vector<unsigned char>& rgba, int width, int height, bool normalMap)
+{
+	int newWidth = std::max(width / 2, 1);
+	int newHeight = std::max(height / 2, 1);
+	std::vector<unsigned char> result(newWidth * newHeight * 4);
+	for (int y = 0; y < newHeight; y++)
+	{
+		for (int x = 0; x < newWidth; x++)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int i = 0; i < 4; i++)
+			{
+				int px = std::min(x * 2 + i % 2, width - 1);
+				int py = std::min(y * 2 + i / 2, height - 1);
+				const unsigned char* texel = &rgba[(py * width + px) * 4];
+				for (int c = 0; c < 4; c++)
+				{
+					if (normalMap && c < 3) sum[c] += texel[c] / 127.5f - 1.0f;
+					else sum[c] += texel[c];
+				}
+			}
+			unsigned char* out = &result[(y * newWidth + x) * 4];
+			if (normalMap)
+			{
+				//	Averaged normals get shorter, so they are renormalized before packing back
+				float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+				if (length < 1e-6f)
+				{
+					sum[0] = 0.0f;
+					sum[1] = 0.0f;
+					sum[2] = 1.0f;
+					length = 1.0f;
+				}
+				for (int c = 0; c < 3; c++)
+					out[c] = (unsigned char)std::clamp((int)std::round((sum[c] / length + 1.0f) * 127.5f), 0, 255);
+			}
+			else
+			{
+				for (int c = 0; c < 3; c++)
+					out[c] = (unsigned char)std::round(sum[c] / 4.0f);
+			}
+			out[3] = (unsigned char)std::round(sum[3] / 4.0f);
+		}
+	}
+	return result;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+
+enum class BlockFormat
+{
+	BC1, BC3, BC5
+};
+
+class BlockCompression
+{
+private:
+	static void EncodeColorBlock(const unsigned char* block, unsigned char* out);
+	static void EncodeChannelBlock(const unsigned char* block, int channel, unsigned char* out);
+public:
+	static unsigned int GetBlockSize(BlockFormat format);
+	static unsigned int GetInternalFormat(BlockFormat format);
+	static unsigned int GetBaseInternalFormat(BlockFormat format);
+	static const char* GetFormatName(BlockFormat format);
+	static std::vector<unsigned char> Compress(const std::vector<unsigned char>& rgba, int width, int height, BlockFormat format);
+	static std::vector<unsigned char> Downsample(const std::vector<unsigned char>& rgba, int width, int height, bool normalMap);
+};
@@ -0,0 +1,202 @@
+#include <SOIL2/SOIL2.h>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <set>
+#include "BlockCompression.h"
+#include "../../KtxFile.h"
+
+//	Offline converter of model and map textures into block-compressed KTX files with a full mip chain.
+//	Run from the game directory: TextureConverter [-force] [directories...], default directories are models and textures.
+//	Texture::LoadTexture picks up the .ktx next to the source image while it is not older than the image.
+
+namespace fs = std::filesystem;
+
+struct ConversionStats
+{
+	unsigned int converted = 0;
+	unsigned int skipped = 0;
+	unsigned int failed = 0;
+	uint64_t rawBytes = 0;
+	uint64_t compressedBytes = 0;
+};
+
+static std::string ToLower(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return text;
+}
+
+static std::string NormalizePath(const fs::path& path)
+{
+	std::error_code error;
+	fs::path canonical = fs::weakly_canonical(path, error);
+	if (error) canonical = path;
+	return ToLower(canonical.make_preferred().string());
+}
+
+static bool HasExtension(const fs::path& path, const std::vector<std::string>& extensions)
+{
+	std::string extension = ToLower(path.extension().string());
+	return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+}
+
+static void CollectNormalMaps(const fs::path& root, std::set<std::string>& normalMaps)
+{
+	//	The game reads bump maps (aiTextureType_HEIGHT) as normal maps, see Model::ProcessMesh
+	static const std::vector<std::string> modelExtensions = { ".obj", ".fbx", ".3ds", ".dae" };
+	std::error_code error;
+	for (fs::recursive_directory_iterator it(root, error), end; it != end; it.increment(error))
+	{
+		if (!it->is_regular_file() || !HasExtension(it->path(), modelExtensions))
+			continue;
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(it->path().string(), 0);
+		if (!scene)
+		{
+			std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
+			continue;
+		}
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+		{
+			const aiTextureType types[2] = { aiTextureType_HEIGHT, aiTextureType_NORMALS };
+			for (int t = 0; t < 2; t++)
+			{
+				for (unsigned int j = 0; j < scene->mMaterials[i]->GetTextureCount(types[t]); j++)
+				{
+					aiString path;
+					scene->mMaterials[i]->GetTexture(types[t], j, &path);
+					normalMaps.insert(NormalizePath(it->path().parent_path() / path.C_Str()));
+				}
+			}
+		}
+	}
+}
+
+static bool IsUpToDate(const fs::path& source, const fs::path& compressed)
+{
+	std::error_code error;
+	if (!fs::exists(compressed, error))
+		return false;
+	return fs::last_write_time(compressed, error) >= fs::last_write_time(source, error);
+}
+
+static void ConvertTexture(const fs::path& path, bool normalMap, ConversionStats& stats)
+{
+	int width, height, channels;
+	unsigned char* pixels = SOIL_load_image(path.string().c_str(), &width, &height, &channels, SOIL_LOAD_RGBA);
+	if (!pixels)
+	{
+		std::cout << "ERROR:: Couldn't load texture:: Path:" << path.string() << std::endl;
+		stats.failed++;
+		return;
+	}
+	std::vector<unsigned char> rgba(pixels, pixels + width * height * 4);
+	SOIL_free_image_data(pixels);
+
+	BlockFormat format = BlockFormat::BC1;
+	if (normalMap)
+		format = BlockFormat::BC5;
+	else if (channels == 2 || channels == 4)
+	{
+		for (int i = 0; i < width * height; i++)
+		{
+			if (rgba[i * 4 + 3] < 255)
+			{
+				format = BlockFormat::BC3;
+				break;
+			}
+		}
+	}
+
+	KtxImage image;
+	image.internalFormat = BlockCompression::GetInternalFormat(format);
+	image.baseInternalFormat = BlockCompression::GetBaseInternalFormat(format);
+	image.width = width;
+	image.height = height;
+	int levelWidth = width, levelHeight = height;
+	while (true)
+	{
+		image.levels.push_back(BlockCompression::Compress(rgba, levelWidth, levelHeight, format));
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		rgba = BlockCompression::Downsample(rgba, levelWidth, levelHeight, normalMap);
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	if (!KtxFile::Write(KtxFile::GetCompressedPath(path.string()), image))
+	{
+		stats.failed++;
+		return;
+	}
+	//	Same estimate the texture cache uses for uncompressed uploads: base level plus a third for mips
+	uint64_t rawBytes = (uint64_t)width * height * channels;
+	rawBytes += rawBytes / 3;
+	uint64_t compressedBytes = image.GetDataSize();
+	stats.converted++;
+	stats.rawBytes += rawBytes;
+	stats.compressedBytes += compressedBytes;
+	std::cout << path.string() << "  " << width << "x" << height << " " << BlockCompression::GetFormatName(format) << "  "
+		<< rawBytes / 1024 << " KB -> " << compressedBytes / 1024 << " KB ("
+		<< std::fixed << std::setprecision(1) << 100.0 * compressedBytes / rawBytes << "%)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	bool force = false;
+	std::vector<fs::path> roots;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-force") force = true;
+		else roots.push_back(arg);
+	}
+	if (roots.empty())
+	{
+		roots.push_back("models");
+		roots.push_back("textures");
+	}
+
+	std::set<std::string> normalMaps;
+	for (int i = 0; i < roots.size(); i++)
+	{
+		CollectNormalMaps(roots[i], normalMaps);
+	}
+
+	static const std::vector<std::string> imageExtensions = { ".png", ".jpg", ".jpeg", ".tga", ".bmp" };
+	ConversionStats stats;
+	for (int i = 0; i < roots.size(); i++)
+	{
+		std::error_code error;
+		for (fs::recursive_directory_iterator it(roots[i], error), end; it != end; it.increment(error))
+		{
+			//	Skybox faces go through Texture::LoadCubeMap, which only reads source images
+			if (it->is_directory() && ToLower(it->path().filename().string()) == "skybox")
+			{
+				it.disable_recursion_pending();
+				continue;
+			}
+			if (!it->is_regular_file() || !HasExtension(it->path(), imageExtensions))
+				continue;
+			if (!force && IsUpToDate(it->path(), KtxFile::GetCompressedPath(it->path().string())))
+			{
+				stats.skipped++;
+				continue;
+			}
+			ConvertTexture(it->path(), normalMaps.count(NormalizePath(it->path())) > 0, stats);
+		}
+	}
+
+	std::cout << "Converted: " << stats.converted << ", up to date: " << stats.skipped << ", failed: " << stats.failed << std::endl;
+	if (stats.rawBytes > 0)
+	{
+		std::cout << "Texture memory: " << stats.rawBytes / (1024 * 1024) << " MB -> " << stats.compressedBytes / (1024 * 1024) << " MB ("
+			<< std::fixed << std::setprecision(1) << 100.0 * stats.compressedBytes / stats.rawBytes << "%)" << std::endl;
+	}
+	return stats.failed > 0 ? 1 : 0;
+}
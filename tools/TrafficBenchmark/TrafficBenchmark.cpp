@@ -0,0 +1,118 @@
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdlib>
+#include "../../VehicleSimulation.h"
+#include "../../CollisionSystem.h"
+#include "../../TrafficSystem.h"
+#include "../../SimulationLod.h"
+#include "../BenchmarkHarness.h"
+
+//	Traffic of the game road scaled up: two lanes per direction as Map::Initialize lays them out,
+//	drivers with different desired speeds, so that they catch up, brake and overtake.
+//	Reports the AI time per step (lane preparation and all driver decisions), lane changes,
+//	car contacts left to the collision pass and how well the cars keep their lanes and speeds.
+//	Each count runs twice: every car at full rate, then with the simulation LOD of the game
+//	around the first car, with the share of cars simulated at full rate.
+
+namespace
+{
+	const float dTime = 1.0f / 120.0f;
+	const int warmupSteps = 600;
+	const int measuredSteps = 1200;
+	const float carLength = 4.2f;
+
+	const std::vector<TableColumn> columns = {
+		{ "cars", 6 }, { "lod", 6 }, { "step, ms", 10 }, { "max, ms", 10 }, { "us per car", 12 },
+		{ "changes", 10 }, { "contacts", 12 }, { "lateral, m", 12 }, { "speed", 10 }, { "full", 10 }
+	};
+
+	void Run(unsigned int count, bool lodEnabled)
+	{
+		srand(count);
+		const float laneOffsets[4] = { -2.625f, -0.875f, 0.875f, 2.625f };
+		VehicleParams vehicleParams;
+		vehicleParams.maxTorque = 216.0f;
+		vehicleParams.wheelsAxisDist = 60.0f;
+		vehicleParams.maxTurnAngle = 50.0f;
+		VehicleSimulation simulation;
+		CollisionSystem collisions;
+		TrafficSystem traffic;
+		SimulationLod lod;
+		SimulationLodSettings lodSettings;
+		lodSettings.enabled = lodEnabled;
+		lod.SetSettings(lodSettings);
+		simulation.Reserve(count);
+		collisions.Reserve(count);
+		for (int i = 0; i < 4; i++)
+			traffic.AddLane(laneOffsets[i], laneOffsets[i] < 0.0f ? -1.0f : 1.0f);
+		std::vector<float> desiredSpeeds(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			float offset = laneOffsets[i % 4];
+			float side = offset < 0.0f ? -1.0f : 1.0f;
+			glm::vec3 position = glm::vec3((i / 4) * 25.0f * side + BenchmarkHarness::Random(-4.0f, 4.0f), 0.0f, offset + BenchmarkHarness::Random(-0.3f, 0.3f));
+			glm::vec3 direction = glm::vec3(side, 0.0f, 0.0f);
+			unsigned int vehicle = simulation.Add(position, direction, direction * BenchmarkHarness::Random(6.0f, 12.0f), vehicleParams);
+			collisions.AddBody(vehicle, glm::vec3(carLength / 2.0f, 0.7f, 0.8f), glm::vec3(0.0f, 0.7f, 0.0f));
+			DriverParams driverParams;
+			driverParams.desiredSpeed = BenchmarkHarness::Random(9.0f, 16.0f);
+			desiredSpeeds[vehicle] = driverParams.desiredSpeed;
+			traffic.AddDriver(vehicle, carLength, driverParams);
+			lod.AddVehicle(vehicle);
+		}
+		unsigned long long contacts = 0;
+		unsigned long long laneChanges = 0;
+		double lateralError = 0.0, speedRatio = 0.0;
+		double fullRate = 0.0;
+		StepTimes times = BenchmarkHarness::RunSteps(warmupSteps, measuredSteps, [&](int step)
+		{
+			if (step == warmupSteps)
+				laneChanges = traffic.GetStats().laneChangesCount;
+		}, [&](int step)
+		{
+			lod.Update(simulation, simulation.GetPosition(0));
+			traffic.Prepare(simulation);
+			for (unsigned int i = 0; i < count; i++)
+			{
+				if (lod.GetTier(i) == SimulationTier::KINEMATIC)
+					traffic.Coast(i, dTime);
+				else if (lod.IsDue(i))
+					traffic.Drive(i, lod.GetStepTime(i, dTime));
+			}
+		}, [&](int step, bool measured)
+		{
+			simulation.Update(dTime);
+			collisions.Update(simulation);
+			if (!measured) return;
+			contacts += collisions.GetStats().contactsCount;
+			fullRate += lod.GetStats().tierCounts[(int)SimulationTier::FULL];
+			for (unsigned int i = 0; i < count; i++)
+			{
+				int lane = traffic.GetLane(i);
+				if (lane >= 0)
+					lateralError += glm::abs(simulation.GetPosition(i).z - laneOffsets[lane]);
+				speedRatio += glm::length(simulation.GetSpeed(i)) / desiredSpeeds[i];
+			}
+		});
+		laneChanges = traffic.GetStats().laneChangesCount - laneChanges;
+		double samples = (double)count * measuredSteps;
+		BenchmarkHarness::PrintRow(columns, { std::to_string(count), lodEnabled ? "on" : "off", BenchmarkHarness::Cell(times.GetAverage(), 4),
+			BenchmarkHarness::Cell(times.max, 4), BenchmarkHarness::Cell(times.GetAverage() / count * 1000.0, 2),
+			std::to_string(laneChanges), BenchmarkHarness::Cell(contacts / (double)measuredSteps, 2),
+			BenchmarkHarness::Cell(lateralError / samples, 2), BenchmarkHarness::Cell(speedRatio / samples, 2),
+			BenchmarkHarness::Cell(fullRate / samples, 2) });
+	}
+}
+
+int main()
+{
+	const unsigned int counts[4] = { 16, 100, 500, 2000 };
+	BenchmarkHarness::PrintHeader(columns);
+	for (int i = 0; i < 4; i++)
+	{
+		Run(counts[i], false);
+		Run(counts[i], true);
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#define _USE_MATH_DEFINES
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+#include <glm/gtx/projection.hpp>
+#include <vector>
+#include <map>
+#include <string>
+#include <cmath>
+#include "../../VehicleSimulation.h"
+#include "../BenchmarkHarness.h"
+
+//	Physics-only comparison of the former object-per-car update with VehicleSimulation.
+//	Both drive the same cars with the same scripted controls at the game's fixed step,
+//	time the update and report how far the float batch drifts from the double-precision original.
+
+namespace
+{
+	const double dTime = 1.0 / 120.0;
+	const int warmupSteps = 120;
+	const int measuredSteps = 600;
+
+	class LegacyForce
+	{
+	private:
+		glm::vec3 force;
+	public:
+		LegacyForce(const glm::vec3& force) : force(force) {}
+		glm::vec3 GetForce() { return force; }
+	};
+
+	//	Same state and update as the former Object and Car: forces in a vector, double speed, glm::rotate per step
+	class LegacyCar
+	{
+	private:
+		glm::vec3 position;
+		glm::vec3 direction;
+		glm::vec3 up;
+		glm::vec3 worldUp;
+		glm::dvec3 speed;
+		glm::vec3 force;
+		std::vector<LegacyForce> forces;
+		std::map<std::string, void*> lights;
+		float mass;
+		float wheelsAxisDist;
+		float wheelsRadius;
+		float gearRatio;
+		float diffRatio;
+		float transEfficiency;
+		float maxTorque;
+		float angularVel;
+		double maxTurnAngle;
+		double currentTurnAngle;
+		CarControls controls;
+
+		void AddForce(const glm::vec3& force) { forces.push_back(LegacyForce(force)); }
+		void SumForces() { for (auto& i : forces) force += i.GetForce(); }
+		void ClearForces() { force = glm::vec3(0.0f); forces.clear(); }
+		glm::dvec3 GetSpeedProjToDirection() { return glm::proj(speed, (glm::dvec3)direction); }
+		float GetDriveForce() { return maxTorque * gearRatio * diffRatio * transEfficiency / wheelsRadius; }
+		void UpdateVectors()
+		{
+			glm::vec3 right = glm::normalize(glm::cross(direction, worldUp));
+			up = glm::normalize(glm::cross(right, direction));
+		}
+		void Turn(double angle, double deltaTime)
+		{
+			if (angle > maxTurnAngle) angle = maxTurnAngle;
+			else if (angle < -maxTurnAngle) angle = -maxTurnAngle;
+			double dAngle = angle - currentTurnAngle;
+			currentTurnAngle += dAngle * deltaTime * 3.0;
+			if (currentTurnAngle > maxTurnAngle) currentTurnAngle = maxTurnAngle;
+			else if (currentTurnAngle < -maxTurnAngle) currentTurnAngle = -maxTurnAngle;
+			float speedAbs = glm::length(speed);
+			angularVel = speedAbs / wheelsAxisDist * sin(currentTurnAngle * M_PI / 180.0) * 180.0 / M_PI;
+		}
+		void ApplyControls(double deltaTime)
+		{
+			if (controls.forward)
+			{
+				gearRatio = GEAR_RATIO_1;
+				AddForce(direction * GetDriveForce());
+			}
+			if (controls.backward)
+			{
+				gearRatio = GEAR_RATIO_R;
+				AddForce(-direction * GetDriveForce());
+			}
+			if (controls.left)
+				Turn(40.0 / (glm::length(GetSpeedProjToDirection()) / 2.0 + 0.001), deltaTime);
+			if (controls.right)
+				Turn(-40.0 / (glm::length(GetSpeedProjToDirection()) / 2.0 + 0.001), deltaTime);
+			if (controls.brake)
+			{
+				glm::vec3 longSpeedDir = (glm::vec3)GetSpeedProjToDirection();
+				if (glm::length(longSpeedDir) != 0.0f)
+					longSpeedDir = glm::normalize(longSpeedDir);
+				AddForce(-longSpeedDir * GetDriveForce() * 2.7f);
+			}
+			if (!controls.left && !controls.right)
+				Turn(0.0, deltaTime);
+		}
+		void AddResistanceForces()
+		{
+			glm::dvec3 longSpeed = GetSpeedProjToDirection();
+			glm::vec3 speedDir = (glm::vec3)speed;
+			if (glm::length(speedDir) != 0.0f)
+				speedDir = glm::normalize(speedDir);
+			float cDrag = 0.42f;
+			glm::vec3 forceVec = (glm::vec3)(-speed * glm::length(speed)) * cDrag;
+			AddForce(forceVec);
+			float cRub = cDrag * 30.0f;
+			forceVec = (glm::vec3)(-longSpeed) * cRub;
+			AddForce(forceVec);
+			forceVec = -speedDir * mass * 9.81f * 0.25f * (1.1f - glm::abs(glm::dot(speedDir, direction)));
+			AddForce(forceVec);
+			if (currentTurnAngle != 0.0)
+			{
+				double radius = wheelsAxisDist / glm::sin(glm::radians(glm::abs(currentTurnAngle)));
+				forceVec = glm::rotate(longSpeed, -90.0 * currentTurnAngle / std::abs(currentTurnAngle), glm::dvec3(0.0, 1.0, 0.0)) *
+					glm::length(longSpeed) * double(mass) / radius;
+				AddForce(forceVec);
+			}
+		}
+	public:
+		LegacyCar(const glm::vec3& position, const glm::vec3& direction, const VehicleParams& params) :
+			position(position), direction(direction), up(0.0f, 1.0f, 0.0f), worldUp(0.0f, 1.0f, 0.0f), speed(0.0), force(0.0f),
+			mass(params.mass), wheelsAxisDist(params.wheelsAxisDist), wheelsRadius(params.wheelsRadius), gearRatio(params.gearRatio),
+			diffRatio(params.diffRatio), transEfficiency(params.transEfficiency), maxTorque(params.maxTorque), angularVel(0.0f),
+			maxTurnAngle(params.maxTurnAngle), currentTurnAngle(0.0) {}
+		virtual ~LegacyCar() {}
+		void SetControls(const CarControls& controls) { this->controls = controls; }
+		glm::vec3 GetPosition() const { return position; }
+		virtual void Move(double deltaTime)
+		{
+			ApplyControls(deltaTime);
+			AddResistanceForces();
+			SumForces();
+			glm::dvec3 acc;
+			acc = (glm::dvec3)(force / mass);
+			speed += acc * deltaTime;
+			position += speed * deltaTime;
+			direction = glm::normalize(glm::rotate(direction, (float)(angularVel * deltaTime), glm::vec3(0.0f, 1.0f, 0.0f)));
+			speed = glm::rotate(speed, angularVel * deltaTime, glm::dvec3(0.0, 1.0, 0.0));
+			ClearForces();
+			UpdateVectors();
+		}
+	};
+
+	glm::vec3 StartPosition(unsigned int index)
+	{
+		return glm::vec3((index % 100) * 20.0f, 0.0f, (index / 100) * 5.0f);
+	}
+
+	glm::vec3 StartDirection(unsigned int index)
+	{
+		return index % 2 == 0 ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(-1.0f, 0.0f, 0.0f);
+	}
+
+	//	Throttle most of the time, alternating steering and occasional braking, different per car
+	CarControls ScriptedControls(unsigned int index, int step)
+	{
+		CarControls controls;
+		int phase = (step / 60 + index) % 6;
+		controls.forward = phase != 5;
+		controls.backward = index % 17 == 0 && phase == 5;
+		controls.left = phase == 1;
+		controls.right = phase == 3 || (index % 5 == 0 && phase == 1);
+		controls.brake = index % 7 == 0 && phase == 4;
+		return controls;
+	}
+
+	double RunLegacy(unsigned int count, std::vector<glm::vec3>& positions)
+	{
+		VehicleParams params;
+		std::vector<LegacyCar*> cars;
+		for (unsigned int i = 0; i < count; i++)
+			cars.push_back(new LegacyCar(StartPosition(i), StartDirection(i), params));
+		StepTimes times = BenchmarkHarness::RunSteps(warmupSteps, measuredSteps, [&](int step)
+		{
+			for (unsigned int i = 0; i < count; i++)
+				cars[i]->SetControls(ScriptedControls(i, step));
+		}, [&](int step)
+		{
+			for (unsigned int i = 0; i < count; i++)
+				cars[i]->Move(dTime);
+		}, [](int step, bool measured) {});
+		positions.resize(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			positions[i] = cars[i]->GetPosition();
+			delete cars[i];
+		}
+		return times.GetAverage();
+	}
+
+	double RunBatch(unsigned int count, std::vector<glm::vec3>& positions)
+	{
+		VehicleParams params;
+		VehicleSimulation simulation;
+		simulation.Reserve(count);
+		for (unsigned int i = 0; i < count; i++)
+			simulation.Add(StartPosition(i), StartDirection(i), glm::vec3(0.0f), params);
+		StepTimes times = BenchmarkHarness::RunSteps(warmupSteps, measuredSteps, [&](int step)
+		{
+			for (unsigned int i = 0; i < count; i++)
+				simulation.SetControls(i, ScriptedControls(i, step));
+		}, [&](int step)
+		{
+			simulation.Update((float)dTime);
+		}, [](int step, bool measured) {});
+		positions.resize(count);
+		for (unsigned int i = 0; i < count; i++)
+			positions[i] = simulation.GetPosition(i);
+		return times.GetAverage();
+	}
+}
+
+int main()
+{
+	const unsigned int counts[2] = { 1000, 10000 };
+	const std::vector<TableColumn> columns = {
+		{ "vehicles", 10 }, { "legacy, ms", 14 }, { "batch, ms", 14 }, { "speedup", 10 }, { "batch, veh/s", 20 }, { "max drift, m", 16 }
+	};
+	BenchmarkHarness::PrintHeader(columns);
+	for (int i = 0; i < 2; i++)
+	{
+		std::vector<glm::vec3> legacyPositions, batchPositions;
+		double legacy = RunLegacy(counts[i], legacyPositions);
+		double batch = RunBatch(counts[i], batchPositions);
+		float drift = 0.0f;
+		for (unsigned int j = 0; j < counts[i]; j++)
+			drift = glm::max(drift, glm::length(legacyPositions[j] - batchPositions[j]));
+		BenchmarkHarness::PrintRow(columns, { std::to_string(counts[i]), BenchmarkHarness::Cell(legacy, 3), BenchmarkHarness::Cell(batch, 3),
+			BenchmarkHarness::Cell(legacy / batch, 1) + "x", BenchmarkHarness::Cell(counts[i] / (batch / 1000.0), 0),
+			BenchmarkHarness::Cell(drift, 4) });
+	}
+	return 0;
+}